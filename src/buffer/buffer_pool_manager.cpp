@@ -27,51 +27,196 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<int>(i));
   }
+
+  // A read-only database file is served straight out of its mapping, the frames above are never used.
+  if (disk_manager_->IsReadOnly()) {
+    num_mapped_pages_ = disk_manager_->GetMappedPageCount();
+    mapped_pages_ = new std::atomic<Page *>[num_mapped_pages_];
+    for (page_id_t i = 0; i < num_mapped_pages_; ++i) {
+      mapped_pages_[i] = nullptr;
+    }
+  }
 }
 
 BufferPoolManager::~BufferPoolManager() {
   delete[] pages_;
   delete replacer_;
+  for (page_id_t i = 0; i < num_mapped_pages_; ++i) {
+    delete mapped_pages_[i].load();
+  }
+  delete[] mapped_pages_;
 }
 
 Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  if (mapped_pages_ != nullptr) {
+    return FetchMappedPage(page_id);
+  }
+  std::scoped_lock lock{latch_};
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
+  auto it = page_table_.find(page_id);
+  if (it != page_table_.end()) {
+    Page *page = &pages_[it->second];
+    page->pin_count_++;
+    replacer_->Pin(it->second);
+    return page;
+  }
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
   //        Note that pages are always found from the free list first.
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
+  frame_id_t frame_id;
+  if (!FindVictimFrame(&frame_id)) {
+    return nullptr;
+  }
+  page_table_.emplace(page_id, frame_id);
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  return nullptr;
+  Page *page = &pages_[frame_id];
+  page->page_id_ = page_id;
+  page->pin_count_ = 1;
+  page->is_dirty_ = false;
+  disk_manager_->ReadPage(page_id, page->GetData());
+  replacer_->Pin(frame_id);
+  return page;
 }
 
-bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) { return false; }
+bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  if (mapped_pages_ != nullptr) {
+    // Mapped pages are never evicted, so there is no pin count to maintain. They can never be dirtied either.
+    return !is_dirty;
+  }
+  std::scoped_lock lock{latch_};
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+  Page *page = &pages_[it->second];
+  if (page->pin_count_ <= 0) {
+    return false;
+  }
+  page->is_dirty_ = page->is_dirty_ || is_dirty;
+  if (--page->pin_count_ == 0) {
+    replacer_->Unpin(it->second);
+  }
+  return true;
+}
 
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  // Make sure you call DiskManager::WritePage!
-  return false;
+  if (mapped_pages_ != nullptr || page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  std::scoped_lock lock{latch_};
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+  Page *page = &pages_[it->second];
+  disk_manager_->WritePage(page_id, page->GetData());
+  page->is_dirty_ = false;
+  return true;
 }
 
 Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  // 0.   Make sure you call DiskManager::AllocatePage!
+  if (mapped_pages_ != nullptr) {
+    // A read-only database cannot grow.
+    *page_id = INVALID_PAGE_ID;
+    return nullptr;
+  }
+  std::scoped_lock lock{latch_};
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  frame_id_t frame_id;
+  if (!FindVictimFrame(&frame_id)) {
+    return nullptr;
+  }
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  return nullptr;
+  *page_id = disk_manager_->AllocatePage();
+  page_table_.emplace(*page_id, frame_id);
+  Page *page = &pages_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = *page_id;
+  page->pin_count_ = 1;
+  // The page does not exist on disk yet, so it must be written back even if nobody modifies it.
+  page->is_dirty_ = true;
+  replacer_->Pin(frame_id);
+  return page;
 }
 
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
-  // 0.   Make sure you call DiskManager::DeallocatePage!
+  if (mapped_pages_ != nullptr) {
+    return false;
+  }
+  std::scoped_lock lock{latch_};
+  disk_manager_->DeallocatePage(page_id);
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return true;
+  }
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+  if (page->pin_count_ > 0) {
+    return false;
+  }
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  return false;
+  page_table_.erase(it);
+  replacer_->Pin(frame_id);
+  page->ResetMemory();
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  free_list_.push_back(frame_id);
+  return true;
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
-  // You can do it!
+  if (mapped_pages_ != nullptr) {
+    return;
+  }
+  std::scoped_lock lock{latch_};
+  for (const auto &[page_id, frame_id] : page_table_) {
+    Page *page = &pages_[frame_id];
+    disk_manager_->WritePage(page_id, page->GetData());
+    page->is_dirty_ = false;
+  }
+}
+
+bool BufferPoolManager::FindVictimFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  Page *victim = &pages_[*frame_id];
+  if (victim->is_dirty_) {
+    disk_manager_->WritePage(victim->page_id_, victim->GetData());
+    victim->is_dirty_ = false;
+  }
+  page_table_.erase(victim->page_id_);
+  return true;
+}
+
+Page *BufferPoolManager::FetchMappedPage(page_id_t page_id) {
+  if (page_id < 0 || page_id >= num_mapped_pages_) {
+    return nullptr;
+  }
+  Page *page = mapped_pages_[page_id].load(std::memory_order_acquire);
+  if (page != nullptr) {
+    return page;
+  }
+  // First fetch of this page: wrap the mapped memory. Whoever loses the race frees its wrapper.
+  auto *new_page = new Page(disk_manager_->GetMappedPage(page_id));
+  new_page->page_id_ = page_id;
+  if (mapped_pages_[page_id].compare_exchange_strong(page, new_page, std::memory_order_acq_rel)) {
+    return new_page;
+  }
+  delete new_page;
+  return page;
 }
 
 }  // namespace bustub
@@ -32,10 +32,12 @@ Schema::Schema(const std::vector<Column> &columns) : tuple_is_inlined_(true) {
     curr_offset += column.GetFixedLength();
 
     // add column
+    layouts_.push_back({column.GetOffset(), column.GetFixedLength(), column.GetType(), column.IsInlined()});
     this->columns_.push_back(column);
   }
-  // set tuple length
-  length_ = curr_offset;
+  // set tuple length, the null bitmap follows the fixed-length columns
+  null_bitmap_offset_ = curr_offset;
+  length_ = curr_offset + (static_cast<uint32_t>(columns.size()) + 7) / 8;
 }
 
 std::string Schema::ToString() const {
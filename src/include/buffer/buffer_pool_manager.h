@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
@@ -25,6 +26,10 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * If the disk manager opened the database file read-only, pages are not copied into frames at all: FetchPage returns
+ * pages that point straight into the file mapping, they are never evicted, and UnpinPage does no bookkeeping. Every
+ * attempt to create, delete, flush or dirty a page is rejected in that mode.
  */
 class BufferPoolManager {
  public:
@@ -97,6 +102,9 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return the disk manager that the buffer pool reads pages from and writes them to */
+  DiskManager *GetDiskManager() { return disk_manager_; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -152,12 +160,27 @@ class BufferPoolManager {
    */
   void FlushAllPagesImpl();
 
+  /**
+   * Finds a frame to hold a new page, from the free list first and then from the replacer.
+   * A dirty victim is written back and removed from the page table. Must be called with latch_ held.
+   * @param[out] frame_id the frame that can be reused
+   * @return false if all the frames are pinned
+   */
+  bool FindVictimFrame(frame_id_t *frame_id);
+
+  /**
+   * Fetches a page of a read-only database file without copying it or taking the latch.
+   * @param page_id id of page to be fetched
+   * @return the page pointing into the file mapping, nullptr if the page is beyond the end of the file
+   */
+  Page *FetchMappedPage(page_id_t page_id);
+
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
   Page *pages_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
   /** Page table for keeping track of buffer pool pages. */
@@ -166,7 +189,11 @@ class BufferPoolManager {
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /** This latch protects page_table_, free_list_ and the metadata of the frames in pages_. */
   std::mutex latch_;
+  /** Read-only mode only: page id -> page wrapping the file mapping, created on first fetch. */
+  std::atomic<Page *> *mapped_pages_{nullptr};
+  /** Read-only mode only: number of pages in the file mapping. */
+  page_id_t num_mapped_pages_{0};
 };
 }  // namespace bustub
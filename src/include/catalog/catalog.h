@@ -8,8 +8,11 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
+#include "storage/index/varlen_b_plus_tree_index.h"
+#include "storage/page/header_page.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -64,30 +67,57 @@ class Catalog {
    * @param bpm the buffer pool manager backing tables created by this catalog
    * @param lock_manager the lock manager in use by the system
    * @param log_manager the log manager in use by the system
+   * @throws Exception if the database is new and there is no room in the buffer pool for its header page
    */
   Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager)
-      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
+      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {
+    // Indexes keep their root page ids in the header page, so a new database must not give it to a table. An existing
+    // database already has its header page.
+    if (bpm_->GetDiskManager()->GetNumPages() != 0) {
+      return;
+    }
+    page_id_t page_id;
+    auto page = bpm_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't create the header page of the database.");
+    }
+    BUSTUB_ASSERT(page_id == HEADER_PAGE_ID, "The first page of a database is its header page.");
+    static_cast<HeaderPage *>(page)->Init();
+    bpm_->UnpinPage(page_id, true);
+  }
 
   /**
    * Create a new table and return its metadata.
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param layout the page layout of the new table, PAX suits tables that are mostly scanned a few columns at a time
+   * @param dictionary_encoding whether to dictionary-encode VARCHAR values, suits columns with few distinct values
    * @return a pointer to the metadata of the new table
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             TableLayout layout = TableLayout::ROW, bool dictionary_encoding = false) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
-    return nullptr;
+    auto table_oid = next_table_oid_++;
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, schema, layout,
+                                             dictionary_encoding);
+    auto metadata = std::make_unique<TableMetadata>(schema, table_name, std::move(table), table_oid);
+    auto metadata_ptr = metadata.get();
+    tables_.emplace(table_oid, std::move(metadata));
+    names_.emplace(table_name, table_oid);
+    return metadata_ptr;
   }
 
-  /** @return table metadata by name */
-  TableMetadata *GetTable(const std::string &table_name) { return nullptr; }
+  /** @return table metadata by name, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(const std::string &table_name) { return GetTable(names_.at(table_name)); }
 
-  /** @return table metadata by oid */
-  TableMetadata *GetTable(table_oid_t table_oid) { return nullptr; }
+  /** @return table metadata by oid, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(table_oid_t table_oid) { return tables_.at(table_oid).get(); }
 
   /**
    * Create a new index, populate existing data of the table and return its metadata.
+   * The existing keys are sorted and bulk loaded into the index rather than inserted one by one, see
+   * BPlusTreeIndex::BulkLoad.
    * @param txn the transaction in which the table is being created
    * @param index_name the name of the new index
    * @param table_name the name of the table
@@ -95,25 +125,86 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param is_unique whether every key maps to a single row; otherwise rows may share a key
+   * @param include_attrs columns stored in the index entries besides the key, for index-only scans, see
+   * Index::ScanEntries; only unique indexes on generic keys can include columns
    * @return a pointer to the metadata of the new table
+   * @throws Exception if is_unique and two rows of the table share a key, in which case no index is created
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    return nullptr;
+                         size_t keysize, bool is_unique = false, const std::vector<uint32_t> &include_attrs = {}) {
+    BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique within a table!");
+    auto table = GetTable(table_name);
+    auto index_oid = next_index_oid_++;
+    auto metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs, is_unique, include_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(metadata, bpm_);
+    index->BulkLoad(table->table_.get(), schema, txn);
+    return AddIndex(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
   }
 
-  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) { return nullptr; }
+  /**
+   * Create a new index whose keys may be of any length up to VarlenBPlusTree::MAX_KEY_SIZE bytes once encoded, e.g.
+   * on long VARCHAR columns, populate existing data of the table and return its metadata.
+   * @param txn the transaction in which the index is being created
+   * @param index_name the name of the new index
+   * @param table_name the name of the table
+   * @param schema the schema of the table
+   * @param key_schema the schema of the key
+   * @param key_attrs key attributes
+   * @param is_unique whether every key maps to a single row; otherwise rows may share a key
+   * @return a pointer to the metadata of the new index
+   * @throws Exception if is_unique and two rows of the table share a key, in which case no index is created
+   */
+  IndexInfo *CreateVarlenIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                               const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                               bool is_unique = false) {
+    BUSTUB_ASSERT(index_names_[table_name].count(index_name) == 0, "Index names should be unique within a table!");
+    auto table = GetTable(table_name);
+    auto index_oid = next_index_oid_++;
+    auto metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs, is_unique);
+    auto index = std::make_unique<VarlenBPlusTreeIndex>(metadata, bpm_);
+    index->BulkLoad(table->table_.get(), schema, txn);
+    return AddIndex(key_schema, index_name, std::move(index), index_oid, table_name, VarlenBPlusTree::MAX_KEY_SIZE);
+  }
 
-  IndexInfo *GetIndex(index_oid_t index_oid) { return nullptr; }
+  /** @return index metadata by name and table name, throws std::out_of_range if there is no such index */
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    return GetIndex(index_names_.at(table_name).at(index_name));
+  }
 
-  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) { return std::vector<IndexInfo *>(); }
+  /** @return index metadata by oid, throws std::out_of_range if there is no such index */
+  IndexInfo *GetIndex(index_oid_t index_oid) { return indexes_.at(index_oid).get(); }
+
+  /** @return the metadata of every index of a table */
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::vector<IndexInfo *> indexes;
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes != index_names_.end()) {
+      for (const auto &[index_name, index_oid] : table_indexes->second) {
+        (void)index_name;
+        indexes.push_back(GetIndex(index_oid));
+      }
+    }
+    return indexes;
+  }
 
  private:
-  [[maybe_unused]] BufferPoolManager *bpm_;
-  [[maybe_unused]] LockManager *lock_manager_;
-  [[maybe_unused]] LogManager *log_manager_;
+  /** Register the metadata of a new, populated index. */
+  IndexInfo *AddIndex(const Schema &key_schema, const std::string &index_name, std::unique_ptr<Index> &&index,
+                      index_oid_t index_oid, const std::string &table_name, size_t keysize) {
+    auto index_info =
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info_ptr = index_info.get();
+    indexes_.emplace(index_oid, std::move(index_info));
+    index_names_[table_name].emplace(index_name, index_oid);
+    return index_info_ptr;
+  }
+
+  BufferPoolManager *bpm_;
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
 
   /** tables_ : table identifiers -> table metadata. Note that tables_ owns all table metadata. */
   std::unordered_map<table_oid_t, std::unique_ptr<TableMetadata>> tables_;
@@ -21,6 +21,16 @@
 
 namespace bustub {
 
+/** Where and how a column is stored in a tuple, the part of a Column that reading a tuple needs. */
+struct ColumnLayout {
+  /** Offset of the value in the tuple, or of the offset of the data for uninlined columns. */
+  uint32_t offset_;
+  /** Number of bytes the column takes in the fixed-length part of the tuple. */
+  uint32_t width_;
+  TypeId type_;
+  bool inlined_;
+};
+
 class Schema {
  public:
   /**
@@ -49,9 +59,12 @@ class Schema {
   const Column &GetColumn(const uint32_t col_idx) const { return columns_[col_idx]; }
 
   /**
-   * @param col_name name of the wanted column
-   * @return the column with the given name
+   * Returns where a column is stored in a tuple. The layouts of all columns are kept in one flat array, so reading
+   * them is cheaper than going through the columns.
+   * @param col_idx index of the column
+   * @return the layout of the column
    */
+  const ColumnLayout &GetColumnLayout(const uint32_t col_idx) const { return layouts_[col_idx]; }
 
   /**
    * Looks up and returns the index of the first column in the schema with the specified name.
@@ -77,9 +90,15 @@ class Schema {
   /** @return the number of non-inlined columns */
   uint32_t GetUnlinedColumnCount() const { return static_cast<uint32_t>(uninlined_columns_.size()); }
 
-  /** @return the number of bytes used by one tuple */
+  /** @return the number of bytes used by one tuple, the fixed-length columns and the null bitmap */
   inline uint32_t GetLength() const { return length_; }
 
+  /** @return the offset of the null bitmap in a tuple, right behind the fixed-length columns */
+  inline uint32_t GetNullBitmapOffset() const { return null_bitmap_offset_; }
+
+  /** @return the number of bytes of the null bitmap, one bit per column */
+  inline uint32_t GetNullBitmapSize() const { return length_ - null_bitmap_offset_; }
+
   /** @return true if all columns are inlined, false otherwise */
   inline bool IsInlined() const { return tuple_is_inlined_; }
 
@@ -87,9 +106,12 @@ class Schema {
   std::string ToString() const;
 
  private:
-  /** Fixed-length column size, i.e. the number of bytes used by one tuple. */
+  /** Fixed-length column size including the null bitmap, i.e. the number of bytes used by one tuple. */
   uint32_t length_;
 
+  /** Offset of the null bitmap, i.e. the size of the fixed-length columns. */
+  uint32_t null_bitmap_offset_;
+
   /** All the columns in the schema, inlined and uninlined. */
   std::vector<Column> columns_;
 
@@ -98,6 +120,9 @@ class Schema {
 
   /** Indices of all uninlined columns. */
   std::vector<uint32_t> uninlined_columns_;
+
+  /** The layouts of all the columns. */
+  std::vector<ColumnLayout> layouts_;
 };
 
 }  // namespace bustub
@@ -21,6 +21,7 @@
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
 namespace bustub {
 class ExecutionEngine {
  public:
@@ -31,6 +32,9 @@ class ExecutionEngine {
 
   bool Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
                ExecutorContext *exec_ctx) {
+    // memory of the previous query is no longer referenced
+    exec_ctx->GetArena()->Reset();
+
     // construct executor
     auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
 
@@ -43,7 +47,8 @@ class ExecutionEngine {
       RID rid;
       while (executor->Next(&tuple, &rid)) {
         if (result_set != nullptr) {
-          result_set->push_back(tuple);
+          // tuples allocated from the arena must not outlive the query
+          result_set->push_back(tuple.IsAllocated() ? tuple : TupleView(tuple).Materialize());
         }
       }
     } catch (Exception &e) {
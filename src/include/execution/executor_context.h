@@ -19,6 +19,7 @@
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
+#include "type/arena_pool.h"
 
 namespace bustub {
 /**
@@ -60,12 +61,19 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /**
+   * @return the arena for memory that lives as long as the current query, e.g. the tuples and values produced by the
+   * executors and their hash tables. The arena is reset by the ExecutionEngine before every query.
+   */
+  ArenaPool *GetArena() { return &arena_; }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  ArenaPool arena_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <utility>
@@ -31,15 +32,22 @@ namespace bustub {
  * A simplified hash table that has all the necessary functionality for aggregations.
  */
 class SimpleAggregationHashTable {
+  using HashTableAllocator = PoolAllocator<std::pair<const AggregateKey, AggregateValue>>;
+  using HashTable = std::unordered_map<AggregateKey, AggregateValue, std::hash<AggregateKey>,
+                                       std::equal_to<AggregateKey>, HashTableAllocator>;
+
  public:
   /**
    * Create a new simplified aggregation hash table.
    * @param agg_exprs the aggregation expressions
    * @param agg_types the types of aggregations
+   * @param pool the pool to allocate the entries from, e.g. the arena of the executor context, or nullptr for the heap
    */
   SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
+                             const std::vector<AggregationType> &agg_types, AbstractPool *pool = nullptr)
+      : ht{0, std::hash<AggregateKey>{}, std::equal_to<AggregateKey>{}, HashTableAllocator{pool}},
+        agg_exprs_{agg_exprs},
+        agg_types_{agg_types} {}
 
   /** @return the initial aggregrate value for this aggregation executor */
   AggregateValue GenerateInitialAggregateValue() {
@@ -109,7 +117,7 @@ class SimpleAggregationHashTable {
   class Iterator {
    public:
     /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_(iter) {}
+    explicit Iterator(HashTable::const_iterator iter) : iter_(iter) {}
 
     /** @return the key of the iterator */
     const AggregateKey &Key() { return iter_->first; }
@@ -131,7 +139,7 @@ class SimpleAggregationHashTable {
 
    private:
     /** Aggregates map. */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
+    HashTable::const_iterator iter_;
   };
 
   /** @return iterator to the start of the hash table */
@@ -142,7 +150,7 @@ class SimpleAggregationHashTable {
 
  private:
   /** The hash table is just a map from aggregate keys to aggregate values. */
-  std::unordered_map<AggregateKey, AggregateValue> ht{};
+  HashTable ht;
   /** The aggregate expressions that we have. */
   const std::vector<const AbstractExpression *> &agg_exprs_;
   /** The types of aggregations that we have. */
@@ -18,6 +18,7 @@
 #include "catalog/schema.h"
 #include "execution/expressions/abstract_expression.h"
 #include "storage/table/tuple.h"
+#include "type/compare_kernel.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -32,7 +33,11 @@ class ComparisonExpression : public AbstractExpression {
  public:
   /** Creates a new comparison expression representing (left comp_type right). */
   ComparisonExpression(const AbstractExpression *left, const AbstractExpression *right, ComparisonType comp_type)
-      : AbstractExpression({left, right}, TypeId::BOOLEAN), comp_type_{comp_type} {}
+      : AbstractExpression({left, right}, TypeId::BOOLEAN),
+        comp_type_{comp_type},
+        left_type_{left->GetReturnType()},
+        right_type_{right->GetReturnType()},
+        compare_{GetCompareKernel(left_type_, right_type_).compare_values_} {}
 
   Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
     Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
@@ -55,6 +60,14 @@ class ComparisonExpression : public AbstractExpression {
 
  private:
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
+    // Use the kernel selected for the planned types, unless the children produced something else after all.
+    if (compare_ != nullptr && lhs.GetTypeId() == left_type_ && rhs.GetTypeId() == right_type_) {
+      if (lhs.IsNull() || rhs.IsNull()) {
+        return CmpBool::CmpNull;
+      }
+      return ApplyComparison(compare_(lhs, rhs));
+    }
+
     switch (comp_type_) {
       case ComparisonType::Equal:
         return lhs.CompareEquals(rhs);
@@ -73,7 +86,32 @@ class ComparisonExpression : public AbstractExpression {
     }
   }
 
+  /** @return the result of the comparison, given the three-way comparison of the operands */
+  CmpBool ApplyComparison(int result) const {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return GetCmpBool(result == 0);
+      case ComparisonType::NotEqual:
+        return GetCmpBool(result != 0);
+      case ComparisonType::LessThan:
+        return GetCmpBool(result < 0);
+      case ComparisonType::LessThanOrEqual:
+        return GetCmpBool(result <= 0);
+      case ComparisonType::GreaterThan:
+        return GetCmpBool(result > 0);
+      case ComparisonType::GreaterThanOrEqual:
+        return GetCmpBool(result >= 0);
+      default:
+        BUSTUB_ASSERT(false, "Unsupported comparison type.");
+    }
+  }
+
   std::vector<const AbstractExpression *> children_;
   ComparisonType comp_type_;
+  /** The types the children are planned to produce. */
+  TypeId left_type_;
+  TypeId right_type_;
+  /** The kernel comparing values of the planned types, or nullptr. */
+  ValueCompareFn compare_;
 };
 }  // namespace bustub
@@ -14,6 +14,8 @@
 
 #include <cassert>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,6 +34,8 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Inserting a batch of tuples into one table page. */
+  BULKINSERT,
 };
 
 /**
@@ -57,6 +61,10 @@ enum class LogRecordType {
  *--------------------------
  * | HEADER | prev_page_id |
  *--------------------------
+ * For bulk insert type log record, all tuples are on the same page
+ *----------------------------------------------------------------------------------------------------
+ * | HEADER | tuple_count | tuple_rid_1 | tuple_size_1 | tuple_data_1 | ... | tuple_rid_n | ... |
+ *----------------------------------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
@@ -110,6 +118,22 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for BULKINSERT type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, std::vector<RID> rids,
+            std::vector<Tuple> tuples)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        bulk_insert_rids_(std::move(rids)),
+        bulk_insert_tuples_(std::move(tuples)) {
+    assert(log_record_type == LogRecordType::BULKINSERT && bulk_insert_rids_.size() == bulk_insert_tuples_.size());
+    // calculate log record size
+    size_ = HEADER_SIZE + sizeof(uint32_t);
+    for (const auto &tuple : bulk_insert_tuples_) {
+      size_ += sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    }
+  }
+
   ~LogRecord() = default;
 
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
@@ -128,6 +152,10 @@ class LogRecord {
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline std::vector<RID> &GetBulkInsertRIDs() { return bulk_insert_rids_; }
+
+  inline std::vector<Tuple> &GetBulkInsertTuples() { return bulk_insert_tuples_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -176,6 +204,10 @@ class LogRecord {
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for bulk insert operation
+  std::vector<RID> bulk_insert_rids_;
+  std::vector<Tuple> bulk_insert_tuples_;
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
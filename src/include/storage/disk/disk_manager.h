@@ -13,14 +13,20 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
 #include <fstream>
 #include <future>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
 #include <string>
 
 #include "common/config.h"
 
 namespace bustub {
 
+/** Access pattern hints for a read-only mapped database file, see DiskManager::AdviseAccessPattern. */
+enum class AccessPattern { NORMAL, SEQUENTIAL, RANDOM };
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -33,7 +39,15 @@ class DiskManager {
    */
   explicit DiskManager(const std::string &db_file);
 
-  ~DiskManager() = default;
+  /**
+   * Creates a new disk manager over the specified database file.
+   * In read-only mode the existing file is mmap'ed and no log file is created; every write is rejected.
+   * @param db_file the file name of the database file
+   * @param read_only true to open the file read-only through a memory mapping
+   */
+  DiskManager(const std::string &db_file, bool read_only);
+
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -56,6 +70,11 @@ class DiskManager {
 
   /**
    * Flush the entire log buffer into disk.
+   * Only returns once the data is durable (fdatasync). Concurrent callers write their data in parallel and share
+   * syncs (group commit): whichever caller finds no sync in flight syncs everything written so far on behalf of all
+   * the others, which then return without issuing a sync of their own.
+   * @throws Exception if the data could not be made durable, because writing or syncing it or an earlier write or sync
+   * of the log failed; the log takes no more writes after such a failure
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -91,6 +110,35 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of log syncs, at most GetNumFlushes() thanks to group commit */
+  int GetNumLogSyncs() const;
+
+  /**
+   * @return the number of pages of the database file, including the allocated pages that were not written yet; zero
+   * for a new database
+   */
+  page_id_t GetNumPages();
+
+  /** @return true iff the database file was opened read-only through a memory mapping */
+  inline bool IsReadOnly() const { return read_only_; }
+
+  /** @return the number of pages in the read-only mapping */
+  inline page_id_t GetMappedPageCount() const { return static_cast<page_id_t>(mapped_size_ / PAGE_SIZE); }
+
+  /**
+   * Returns a pointer straight into the read-only mapping; the memory stays valid until ShutDown.
+   * @param page_id id of the page
+   * @return the page data, or nullptr if the page is beyond the end of the mapping
+   */
+  char *GetMappedPage(page_id_t page_id);
+
+  /**
+   * Passes an access pattern hint for the read-only mapping to the kernel (madvise).
+   * Use SEQUENTIAL before full scans so the kernel reads ahead aggressively, RANDOM for index lookups.
+   * @param pattern the expected access pattern
+   */
+  void AdviseAccessPattern(AccessPattern pattern);
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -102,17 +150,48 @@ class DiskManager {
 
  private:
   int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /** Opens and maps the database file for the read-only mode. */
+  void MapReadOnly();
+  /** Unmaps and closes the database file of the read-only mode. */
+  void UnmapReadOnly();
+  /** Reserves disk blocks for the log ahead of its end, so appends do not allocate. Must hold log_latch_. */
+  void PreallocateLog(size_t end);
+  /** Fails every pending and later WriteLog after an I/O error. Must hold log_latch_. */
+  void FailLog();
+
+  // file descriptor of the log file
+  int log_fd_{-1};
   std::string log_name_;
+  // group commit state of the log file, protected by log_latch_
+  std::mutex log_latch_;
+  std::condition_variable log_cv_;
+  // end of the space handed out to writers
+  size_t log_reserved_{0};
+  // every byte before this offset has been written
+  size_t log_written_{0};
+  // every byte before this offset is durable
+  size_t log_synced_{0};
+  // end of the blocks reserved by PreallocateLog
+  size_t log_preallocated_{0};
+  bool log_syncing_{false};
+  // a log write or sync failed, log_synced_ never moves again
+  bool log_failed_{false};
+  // writes that completed out of order: offset -> end
+  std::map<size_t, size_t> log_completed_;
+  int num_log_syncs_{0};
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
   int num_writes_;
-  bool flush_log_;
+  std::atomic<bool> flush_log_;
   std::future<void> *flush_log_f_;
+  // read-only mapping of the db file
+  bool read_only_{false};
+  int db_fd_{-1};
+  char *mapped_data_{nullptr};
+  size_t mapped_size_{0};
 };
 
 }  // namespace bustub
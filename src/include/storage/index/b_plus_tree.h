@@ -12,10 +12,13 @@
 
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
+#include "storage/index/posting_list.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
@@ -23,15 +26,43 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/** How many children of an inner page GetValues pins ahead of its probes. */
+static constexpr int PROBE_PREFETCH_DISTANCE = 4;
+
+/** How a BPlusTree synchronizes concurrent operations. */
+enum class BPlusTreeMode {
+  /** Latch crabbing, optimistic first, see BPlusTree. */
+  LATCH_CRABBING,
+  /**
+   * Lehman-Yao B-link tree: every page has a right link and a high key, so an operation that reaches a page after it
+   * split can still find its key by moving right. Operations hold at most one latch at a time on the way down, and
+   * readers never wait for a split to finish. Removes only take keys out of their leaf; pages are never merged.
+   */
+  B_LINK,
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, or, in a non-unique tree, map to any number of distinct values
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency: readers crab down with read latches. Writers first descend optimistically, read latching the inner
+ * pages and write latching only the leaf, and apply the change right there if it cannot split or merge the leaf. Only
+ * otherwise do they descend again pessimistically, write latching from the root down and letting go of the latches
+ * above the first page that is safe, i.e. that the change cannot propagate past. The latches held by a pessimistic
+ * writer are kept in the page set of its transaction, where nullptr stands for root_latch_, which protects
+ * root_page_id_. Most inserts and removes therefore never write latch anything but their leaf.
+ *
+ * Duplicates: a non-unique tree stores a key with a few values as that many pairs, ordered by value, in the same
+ * leaf; leaves are split and redistributed between keys only, so separators stay distinct. A key with more than
+ * max_inline_duplicates_ values instead has a single pair whose value is a posting reference to a PostingList of its
+ * values, protected by the latch of the leaf. Values of a non-unique tree are RIDs with slot numbers below
+ * PostingList::POSTING_FLAG.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -39,26 +70,85 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  // An internal page briefly holds one child more than its max size before it splits, hence the default.
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE - 1,
+                     BPlusTreeMode mode = BPlusTreeMode::LATCH_CRABBING, bool unique = true);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree; false if the key is there already, or in a non-unique tree the pair.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all its values from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  /**
+   * Remove a single key-value pair, e.g. the index entry of one deleted tuple when other tuples share its key.
+   * @return false if the key does not map to value
+   */
+  bool Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key, in a non-unique tree ordered by RID
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Look up many keys at once. The keys are probed in ascending order, so that a probe starts from the lowest page
+   * on the path of the one before it that still covers its key instead of from the root, which makes sorted probes
+   * cost about as much as merging them with the leaves. While on an inner page, the children that the next probes
+   * will visit are pinned ahead of time and their first cache lines prefetched.
+   * With latch crabbing, the pages on the path of the last probe stay read latched until the next probe leaves them,
+   * so writers wait for a batch rather than for a single lookup. A B-link tree only keeps the current leaf latched,
+   * and remembers its ancestors to climb back to.
+   * @param keys the keys, in any order and possibly repeated
+   * @param[out] result one vector per key, in the order of keys, holding the value of the key if it was found
+   * @return the number of keys found
+   */
+  size_t GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result,
+                   Transaction *transaction = nullptr);
+
+  /**
+   * Build an empty tree from key-value pairs in ascending key order. Rather than splitting its way there one insert
+   * at a time, the load fills leaves left to right, then builds every level above them bottom-up from the one below,
+   * each level on consecutively allocated pages. The tree is locked for the whole load.
+   * @param first the first pair; the pairs are read once, through first->first and first->second. In a non-unique
+   * tree, the values of a key may come in any order, and repeated ones are skipped
+   * @param last past the last pair
+   * @param fill_factor how full to fill the pages, between 0 and 1. Pages are never filled less than half, nor so full
+   * that the next insert into them splits them
+   * @return false if the tree is not empty, in which case nothing is read
+   * @throws Exception if a unique tree is given a key more than once, in which case the tree is left empty
+   */
+  template <typename InputIterator>
+  bool BulkLoad(InputIterator first, InputIterator last, double fill_factor = 1.0) {
+    BulkLoadState state;
+    if (!BeginBulkLoad(&state, fill_factor)) {
+      return false;
+    }
+    try {
+      for (; first != last; ++first) {
+        BulkLoadAppend(&state, first->first, first->second);
+      }
+      FinishBulkLoad(&state);
+    } catch (...) {
+      AbortBulkLoad(&state);
+      throw;
+    }
+    return true;
+  }
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  /** @return an iterator on the last pair, to move backwards from with operator-- */
+  INDEXITERATOR_TYPE rbegin();
+
+  /** @return an iterator on the last pair whose key is not greater than key, to move backwards from with operator-- */
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -77,13 +167,237 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
-  Page *FindLeafPage(const KeyType &key, bool leftMost = false);
+  // returns the leaf pinned and read latched, or nullptr if the tree is empty; rightMost finds the right most leaf
+  Page *FindLeafPage(const KeyType &key, bool leftMost = false, bool rightMost = false);
 
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
+  /** What a descent to a leaf is for, which decides which pages it is safe to let go of. */
+  enum class Operation { INSERT, REMOVE };
+
+  /** The outcome of changing the pairs of a key in a leaf. */
+  enum class LeafChange {
+    CHANGED,
+    /** There was nothing to change: the pair to insert was there already, or the one to remove was not. */
+    UNCHANGED,
+    /** The change needs a pair more or less in the leaf, which the caller did not allow. */
+    UNSAFE,
+  };
+
+  /**
+   * Insert a key-value pair into a leaf, write latched, which covers the key. In a non-unique tree, a key whose values
+   * no longer fit inline is moved to a posting list, and values of a key with a posting list are added to it.
+   * @param grow whether the leaf may take another pair; it is split by the caller once full
+   */
+  LeafChange InsertIntoLeafPage(LeafPage *leaf, const KeyType &key, const ValueType &value, bool grow);
+
+  /**
+   * Remove a key-value pair from a leaf, write latched, which covers the key. A posting list down to a single value
+   * is turned back into an inline pair.
+   * @param value the value, nullptr for the first pair of the key, which is all of its values if it has a posting list
+   * @param shrink whether the leaf may lose a pair; it is merged or redistributed by the caller if it underflows
+   */
+  LeafChange RemoveFromLeafPage(LeafPage *leaf, const KeyType &key, const ValueType *value, bool shrink);
+
+  /**
+   * Append the values of a key in a leaf, read latched, which covers the key.
+   * @return false if the leaf does not hold the key
+   */
+  bool CollectValues(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result);
+
+  /** Remove a key-value pair, or with value nullptr the first pair of the key. @return false if there was none */
+  bool RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  /**
+   * Descend to the leaf that should hold key, read latching the inner pages and write latching the leaf.
+   * @return the leaf, pinned and write latched, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageOptimistic(const KeyType &key);
+
+  /**
+   * Descend to the leaf that should hold key, write latching every page on the way. The caller holds root_latch_
+   * exclusively and has recorded it in the page set of the transaction; all latches are released as soon as a page
+   * turns out to be safe for the operation, the others are left in the page set.
+   * @return the leaf, pinned and write latched
+   */
+  Page *FindLeafPagePessimistic(const KeyType &key, Operation op, Transaction *transaction);
+
+  /**
+   * Find the last pair whose key is less than key, for an iterator moving left that lost track of the leaves.
+   * @param key the key, nullptr to find the last pair of the tree
+   * @param[out] index the position of the pair in the leaf, -1 if the pair is in a leaf before it
+   * @return the leaf, pinned and read latched, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageBefore(const KeyType *key, int *index);
+
+  /**
+   * Try to write latch the right sibling of a leaf about to split or be merged into its left sibling, whose prev link
+   * has to follow. Merges latch leaves right to left, so a writer holding the leaf must not wait for its sibling.
+   * @param leaf the leaf, write latched
+   * @param[out] page the right sibling, pinned and write latched, or nullptr if the leaf has none
+   * @return false if the right sibling is latched by someone else, in which case it is not pinned either
+   */
+  bool TryLatchNextLeaf(LeafPage *leaf, Page **page);
+
+  /** @return true if the operation on the subtree of node cannot change the parent of node */
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
+  /**
+   * Release the latches recorded in the page set of the transaction, then delete the pages recorded in its deleted
+   * page set.
+   * @param dirty whether the pages were modified
+   */
+  void ReleaseLatches(Transaction *transaction, bool dirty);
+
+  /** A child of an inner page on the path of GetValues, pinned ahead of the probe that will visit it. */
+  struct PrefetchedChild {
+    /** The probe, as a position in the probe order of GetValues. */
+    size_t probe_;
+    /** The index of the child in the inner page, so that the probe need not search the page again. */
+    int index_;
+    /** The child, pinned. */
+    Page *page_;
+  };
+
+  /** A page on the path of the probes of GetValues. */
+  struct ProbeFrame {
+    /** The page, pinned and read latched. */
+    Page *page_;
+    /** Whether the keys of the page are less than upper_; false on the right edge of the tree. */
+    bool bounded_;
+    KeyType upper_;
+    /** Children of an inner page pinned ahead of the probes that will visit them, in probe order. */
+    std::vector<PrefetchedChild> prefetched_;
+    /** The next probe to look at for children to pin, and the index of the last child pinned. */
+    size_t lookahead_;
+    int last_child_;
+  };
+
+  size_t GetValuesLatchCrabbing(const std::vector<KeyType> &keys, const std::vector<size_t> &order,
+                                std::vector<std::vector<ValueType>> *result);
+
+  size_t GetValuesBLink(const std::vector<KeyType> &keys, const std::vector<size_t> &order,
+                        std::vector<std::vector<ValueType>> *result);
+
+  /**
+   * Pin the children of an inner page on the path of GetValues that the probes after the current one will visit, up
+   * to PROBE_PREFETCH_DISTANCE of them ahead of the probes.
+   * @param frame the inner page
+   * @param child the index of the child the current probe descends to
+   * @param keys the keys of GetValues
+   * @param order the probes, as indices into keys in ascending key order
+   * @param probe the current probe, as a position in order
+   */
+  void PrefetchChildren(ProbeFrame *frame, int child, const std::vector<KeyType> &keys,
+                        const std::vector<size_t> &order, size_t probe);
+
+  /** Unlatch and unpin a page on the path of GetValues, and unpin the children pinned ahead for it. */
+  void ReleaseProbeFrame(ProbeFrame *frame);
+
+  /** Fetch a page, throwing an out of memory exception if the buffer pool has no frame for it. */
+  Page *FetchPage(page_id_t page_id);
+
+  /** @return the right sibling of a B-link tree page if key belongs there, INVALID_PAGE_ID if it belongs to node */
+  page_id_t MoveRight(BPlusTreePage *node, const KeyType &key) const;
+
+  /**
+   * Latch the page of a B-link tree that covers key on the level of page_id, moving right as needed while holding
+   * one latch at a time.
+   * @return the page, pinned and latched
+   */
+  Page *LatchCoveringPage(page_id_t page_id, const KeyType &key, bool exclusive);
+
+  /**
+   * Descend a B-link tree to the leaf covering key without latching it.
+   * @param left_most descend to the left most leaf instead
+   * @param right_most descend to the right most leaf instead
+   * @param[out] stack if not nullptr, the inner pages the descent went down from, root level first
+   * @return the id of the leaf, or of a page to its left on the leaf level; INVALID_PAGE_ID if the tree is empty
+   */
+  page_id_t FindLeafPageIdBLink(const KeyType &key, bool left_most, bool right_most, std::vector<page_id_t> *stack);
+
+  /** Like FindLeafPageIdBLink, but starting from page_id, an inner page or leaf of a B-link tree. */
+  page_id_t DescendBLink(page_id_t page_id, const KeyType &key, bool left_most, bool right_most,
+                         std::vector<page_id_t> *stack);
+
+  bool InsertBLink(const KeyType &key, const ValueType &value);
+
+  /**
+   * Post the separator of a split page of a B-link tree to the level above.
+   * @param stack the inner pages the descent to the split page went down from, see FindLeafPageIdBLink
+   * @param level the level of the split page, 0 for leaves
+   * @param left_page_id the split page
+   * @param key the lowest key of the new right sibling
+   * @param right_page_id the new right sibling
+   */
+  void InsertIntoParentBLink(std::vector<page_id_t> *stack, int level, page_id_t left_page_id, KeyType key,
+                             page_id_t right_page_id);
+
+  bool RemoveBLink(const KeyType &key, const ValueType *value);
+
+  /** A bulk load in progress, see BulkLoad. */
+  struct BulkLoadState {
+    /** Pairs read but not written to a leaf yet. */
+    std::vector<std::pair<KeyType, ValueType>> pending_;
+    /** The lowest key and the page id of every leaf written so far. */
+    std::vector<std::pair<KeyType, page_id_t>> leaves_;
+    /** The last leaf written, kept pinned until the next one is linked to it. */
+    Page *last_leaf_{nullptr};
+    /** Number of pairs to fill a leaf with. */
+    int leaf_fill_{0};
+    /** Number of children to fill an internal page with. */
+    int internal_fill_{0};
+    /** In a non-unique tree, the values read so far of the last key read, not pending yet. */
+    KeyType run_key_{};
+    std::vector<ValueType> run_;
+  };
+
+  /** Lock the tree for a bulk load. @return false if the tree is not empty, in which case it is not locked */
+  bool BeginBulkLoad(BulkLoadState *state, double fill_factor);
+
+  void BulkLoadAppend(BulkLoadState *state, const KeyType &key, const ValueType &value);
+
+  /** Make the values of the last key read by a bulk load of a non-unique tree pending, inline or as a posting list. */
+  void FlushBulkLoadRun(BulkLoadState *state);
+
+  /**
+   * Write the first size pending pairs of a bulk load to a new leaf, linked to the last one. In a non-unique tree,
+   * fewer if the pairs of a key would span two leaves.
+   */
+  void WriteBulkLoadLeaf(BulkLoadState *state, int size);
+
+  /** Write the pending pairs of a bulk load, build the levels above the leaves and unlock the tree. */
+  void FinishBulkLoad(BulkLoadState *state);
+
+  /** Release what a failed bulk load holds and unlock the tree, which is left empty. */
+  void AbortBulkLoad(BulkLoadState *state);
+
+  /**
+   * Build a level of internal pages over the level below it.
+   * @param children the lowest key and the page id of every page of the level below, in order
+   * @param fill the number of children to fill a page with
+   * @return the lowest key and the page id of every page of the new level
+   */
+  std::vector<std::pair<KeyType, page_id_t>> BuildInternalLevel(
+      const std::vector<std::pair<KeyType, page_id_t>> &children, int fill);
+
+  /**
+   * Size the next page of a level being bulk loaded: fill pages while enough entries remain to fill the last ones at
+   * least half, then split what remains over at most two pages.
+   * @param remaining the number of entries left for the level
+   * @param fill the number of entries to fill a page with
+   * @param capacity the most entries a page can take
+   * @return the number of entries to put into the next page
+   */
+  static int BulkLoadPageSize(size_t remaining, int fill, int capacity);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  bool RemoveFromLeaf(const KeyType &key, const ValueType *value, Transaction *transaction);
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
@@ -112,10 +426,18 @@ class BPlusTree {
   // member variable
   std::string index_name_;
   page_id_t root_page_id_;
+  mutable ReaderWriterLatch root_latch_;
+  BPlusTreeMode mode_;
+  /** Number of levels of a B-link tree, which never shrinks. Protected by root_latch_. */
+  int height_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_;
+  /** The most pairs a key of a non-unique tree keeps inline before its values move to a posting list. */
+  int max_inline_duplicates_;
+  PostingList posting_lists_;
 };
 
 }  // namespace bustub
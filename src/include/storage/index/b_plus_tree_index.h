@@ -17,6 +17,7 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -33,13 +34,57 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                Transaction *transaction) override;
+
+  void ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                 ScanDirection direction, size_t limit, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanEntries(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                   ScanDirection direction, size_t limit, std::vector<Tuple> *result,
+                   Transaction *transaction) override;
+
+  /**
+   * Index the tuples already in a table: sort their keys, spilling sorted runs to temporary pages past
+   * SORT_MEMORY_PAGES pages of keys, and bulk load the empty tree from them.
+   * @param table_heap the table of the index
+   * @param tuple_schema the schema of the table
+   * @param transaction the transaction reading the table
+   * @throws Exception if the index is unique and two tuples share a key
+   */
+  void BulkLoad(TableHeap *table_heap, const Schema &tuple_schema, Transaction *transaction);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  /** @return an iterator on the last entry, to move backwards from with operator-- */
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  /** @return an iterator on the last entry whose key is not greater than key, to move backwards from with operator-- */
+  INDEXITERATOR_TYPE GetReverseBeginIterator(const KeyType &key);
+
+  /** Number of pages worth of keys BulkLoad sorts in memory, and of sorted runs it merges at once. */
+  static constexpr size_t SORT_MEMORY_PAGES = 16;
+
  protected:
+  /**
+   * Visit the entries whose keys lie in a range, in scan order, see Index::ScanRange.
+   * @param visit called with the key and the rid of every entry scanned
+   */
+  template <typename Visitor>
+  void VisitRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                  ScanDirection direction, size_t limit, Visitor visit);
+
+  /**
+   * The entries of a covering index keep their included columns in the key bytes, after the key columns. Throw an out
+   * of range exception if an entry tuple does not fit the key type, rather than truncating its included columns.
+   */
+  void CheckEntryFits(const Tuple &entry) const;
+
+  BufferPoolManager *buffer_pool_manager_;
   // comparator for key
   KeyComparator comparator_;
   // container
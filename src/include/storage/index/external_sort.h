@@ -0,0 +1,286 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+/**
+ * ExternalSort sorts key-value pairs by key, e.g. to bulk load an index. Pairs are collected in memory up to a budget
+ * of memory_pages pages. Past it, every full buffer is sorted and spilled as a run of temporary pages, and the runs
+ * are merged, memory_pages of them at a time, until the last merge can stream the pairs out in order. A run page is
+ * given back as soon as it has been read. Run pages are not logged.
+ *
+ * Usage: Add every pair, then iterate from begin() to end() once.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExternalSort {
+  using PairType = std::pair<KeyType, ValueType>;
+
+ public:
+  /** Number of pairs a run page holds. */
+  static constexpr size_t PAIRS_PER_PAGE = PAGE_SIZE / sizeof(PairType);
+
+  /** Input iterator over the sorted pairs. Advancing an iterator advances the sort it reads from. */
+  class Iterator {
+   public:
+    explicit Iterator(ExternalSort *sort) : sort_(sort) {
+      if (sort_ != nullptr) {
+        ++*this;
+      }
+    }
+
+    const PairType &operator*() const { return pair_; }
+
+    const PairType *operator->() const { return &pair_; }
+
+    Iterator &operator++() {
+      if (!sort_->Next(&pair_)) {
+        sort_ = nullptr;
+      }
+      return *this;
+    }
+
+    bool operator==(const Iterator &other) const { return sort_ == other.sort_; }
+
+    bool operator!=(const Iterator &other) const { return !(*this == other); }
+
+   private:
+    ExternalSort *sort_;
+    PairType pair_;
+  };
+
+  /**
+   * Create an empty sort.
+   * @param buffer_pool_manager the buffer pool manager to spill runs through
+   * @param comparator the key comparator
+   * @param memory_pages number of pages worth of pairs to sort in memory, and of runs to merge at once, at least 2
+   */
+  ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator, size_t memory_pages)
+      : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), memory_pages_(memory_pages) {
+    BUSTUB_ASSERT(memory_pages_ >= 2, "A merge needs at least two runs.");
+  }
+
+  ExternalSort(const ExternalSort &) = delete;
+  ExternalSort &operator=(const ExternalSort &) = delete;
+
+  ~ExternalSort() {
+    CloseMerge();
+    for (auto &run : runs_) {
+      FreeRun(&run);
+    }
+  }
+
+  /** Add a pair to sort. */
+  void Add(const KeyType &key, const ValueType &value) {
+    buffer_.emplace_back(key, value);
+    if (buffer_.size() == memory_pages_ * PAIRS_PER_PAGE) {
+      SpillBuffer();
+    }
+  }
+
+  /** @return an iterator to the smallest pair; no pair may be added afterwards */
+  Iterator begin() {
+    if (runs_.empty()) {
+      std::sort(buffer_.begin(), buffer_.end(),
+                [this](const PairType &a, const PairType &b) { return comparator_(a.first, b.first) < 0; });
+    } else {
+      SpillBuffer();
+      while (runs_.size() > memory_pages_) {
+        MergePass();
+      }
+      OpenMerge(std::move(runs_));
+      runs_.clear();
+    }
+    return Iterator(this);
+  }
+
+  Iterator end() { return Iterator(nullptr); }
+
+  /** @return the number of runs spilled, 0 if the pairs fit in memory */
+  size_t GetSpilledRunCount() const { return spilled_run_count_; }
+
+ private:
+  /** A sorted run on temporary pages. Pages already read and given back are INVALID_PAGE_ID. */
+  struct Run {
+    std::vector<page_id_t> page_ids_;
+    size_t size_{0};
+  };
+
+  /** A run being merged and the position of its next pair, whose page is pinned. */
+  struct Cursor {
+    Run run_;
+    size_t position_{0};
+    Page *page_{nullptr};
+  };
+
+  Page *FetchRunPage(page_id_t page_id) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a page of a sorted run.");
+    }
+    return page;
+  }
+
+  /** Append a pair to a run being written; page is the last page of the run, pinned, or nullptr. */
+  void Append(Run *run, Page **page, const PairType &pair) {
+    if (run->size_ % PAIRS_PER_PAGE == 0) {
+      if (*page != nullptr) {
+        buffer_pool_manager_->UnpinPage((*page)->GetPageId(), true);
+      }
+      page_id_t page_id;
+      *page = buffer_pool_manager_->NewPage(&page_id);
+      if (*page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a page for a sorted run.");
+      }
+      run->page_ids_.push_back(page_id);
+    }
+    reinterpret_cast<PairType *>((*page)->GetData())[run->size_ % PAIRS_PER_PAGE] = pair;
+    run->size_++;
+  }
+
+  /** Sort the buffered pairs and spill them as a new run. */
+  void SpillBuffer() {
+    if (buffer_.empty()) {
+      return;
+    }
+    std::sort(buffer_.begin(), buffer_.end(),
+              [this](const PairType &a, const PairType &b) { return comparator_(a.first, b.first) < 0; });
+    Run run;
+    Page *page = nullptr;
+    for (const auto &pair : buffer_) {
+      Append(&run, &page, pair);
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    runs_.push_back(std::move(run));
+    buffer_.clear();
+    spilled_run_count_++;
+  }
+
+  /** Merge the oldest memory_pages_ runs into one. */
+  void MergePass() {
+    std::vector<Run> runs(std::make_move_iterator(runs_.begin()),
+                          std::make_move_iterator(runs_.begin() + memory_pages_));
+    runs_.erase(runs_.begin(), runs_.begin() + memory_pages_);
+    OpenMerge(std::move(runs));
+    Run merged;
+    Page *page = nullptr;
+    PairType pair;
+    while (Next(&pair)) {
+      Append(&merged, &page, pair);
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    CloseMerge();
+    runs_.push_back(std::move(merged));
+  }
+
+  const PairType &PairAt(const Cursor &cursor) const {
+    return reinterpret_cast<const PairType *>(cursor.page_->GetData())[cursor.position_ % PAIRS_PER_PAGE];
+  }
+
+  /** Order for a min-heap of cursors by their next key. */
+  bool CursorGreater(size_t a, size_t b) const {
+    return comparator_(PairAt(cursors_[a]).first, PairAt(cursors_[b]).first) > 0;
+  }
+
+  void OpenMerge(std::vector<Run> runs) {
+    merging_ = true;
+    for (auto &run : runs) {
+      Cursor cursor;
+      cursor.page_ = FetchRunPage(run.page_ids_[0]);
+      cursor.run_ = std::move(run);
+      cursors_.push_back(std::move(cursor));
+      heap_.push_back(cursors_.size() - 1);
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t a, size_t b) { return CursorGreater(a, b); });
+  }
+
+  void CloseMerge() {
+    for (auto &cursor : cursors_) {
+      if (cursor.page_ != nullptr) {
+        buffer_pool_manager_->UnpinPage(cursor.page_->GetPageId(), false);
+      }
+      FreeRun(&cursor.run_);
+    }
+    cursors_.clear();
+    heap_.clear();
+  }
+
+  /** Give back the pages of a run that have not been read yet. */
+  void FreeRun(Run *run) {
+    for (auto &page_id : run->page_ids_) {
+      if (page_id != INVALID_PAGE_ID) {
+        buffer_pool_manager_->DeletePage(page_id);
+        page_id = INVALID_PAGE_ID;
+      }
+    }
+  }
+
+  /** Read the next pair in order. @return false if every pair has been read */
+  bool Next(PairType *pair) {
+    if (!merging_) {
+      if (position_ == buffer_.size()) {
+        return false;
+      }
+      *pair = buffer_[position_++];
+      return true;
+    }
+    if (heap_.empty()) {
+      return false;
+    }
+    auto greater = [this](size_t a, size_t b) { return CursorGreater(a, b); };
+    std::pop_heap(heap_.begin(), heap_.end(), greater);
+    Cursor &cursor = cursors_[heap_.back()];
+    *pair = PairAt(cursor);
+    cursor.position_++;
+    if (cursor.position_ % PAIRS_PER_PAGE == 0 || cursor.position_ == cursor.run_.size_) {
+      // Done with this page.
+      page_id_t &page_id = cursor.run_.page_ids_[(cursor.position_ - 1) / PAIRS_PER_PAGE];
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      page_id = INVALID_PAGE_ID;
+      cursor.page_ = nullptr;
+      if (cursor.position_ == cursor.run_.size_) {
+        heap_.pop_back();
+        return true;
+      }
+      cursor.page_ = FetchRunPage(cursor.run_.page_ids_[cursor.position_ / PAIRS_PER_PAGE]);
+    }
+    std::push_heap(heap_.begin(), heap_.end(), greater);
+    return true;
+  }
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t memory_pages_;
+  /** Pairs not spilled yet, or all of them if they fit in memory. */
+  std::vector<PairType> buffer_;
+  /** Position of the next pair in buffer_ when the pairs fit in memory. */
+  size_t position_{0};
+  size_t spilled_run_count_{0};
+  std::vector<Run> runs_;
+  /** Whether the pairs are read from a merge of runs rather than from buffer_. */
+  bool merging_{false};
+  std::vector<Cursor> cursors_;
+  /** Indexes of the cursors that have pairs left, as a min-heap by their next key. */
+  std::vector<size_t> heap_;
+};
+
+}  // namespace bustub
@@ -12,9 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "storage/table/tuple.h"
+#include "type/compare_kernel.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -32,9 +38,13 @@ class GenericKey {
   inline void SetFromKey(const Tuple &tuple) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    // The null bitmap at the end of the key tuple may not fit, the keys only compare the columns.
+    memcpy(data_, tuple.GetData(), std::min<size_t>(tuple.GetLength(), KeySize));
   }
 
+  /** Same as SetFromKey(tuple): the key is the serialized key tuple, whatever its schema. See NormalizedKey. */
+  inline void SetFromKey(const Tuple &tuple, [[maybe_unused]] const Schema &key_schema) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -55,6 +65,16 @@ class GenericKey {
     return Value::DeserializeFrom(data_ptr, column_type);
   }
 
+  /** @return the serialized value of a column whose offset in the key and whether it is inlined are known */
+  inline const char *GetColumnData(uint32_t offset, bool is_inlined) const {
+    if (is_inlined) {
+      return data_ + offset;
+    }
+    int32_t varlen_offset;
+    memcpy(&varlen_offset, data_ + offset, sizeof(int32_t));
+    return data_ + varlen_offset;
+  }
+
   // NOTE: for test purpose only
   // interpret the first 8 bytes as int64_t from data vector
   inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
@@ -80,6 +100,16 @@ class GenericComparator {
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
+      const auto &column = (*columns_)[i];
+      if (column.compare_ != nullptr) {
+        int result = column.compare_(lhs.GetColumnData(column.offset_, column.is_inlined_),
+                                     rhs.GetColumnData(column.offset_, column.is_inlined_));
+        if (result != 0) {
+          return result < 0 ? -1 : 1;
+        }
+        continue;
+      }
+
       Value lhs_value = (lhs.ToValue(key_schema_, i));
       Value rhs_value = (rhs.ToValue(key_schema_, i));
 
@@ -94,13 +124,41 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_}, columns_{other.columns_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {
+    // Pick the comparison kernel of every key column once, instead of dispatching on its type for every comparison.
+    auto columns = std::make_shared<std::vector<KeyColumn>>();
+    for (const auto &col : key_schema->GetColumns()) {
+      columns->push_back({col.GetOffset(), col.IsInlined(),
+                          GetCompareKernel(col.GetType(), col.GetType()).compare_serialized_});
+    }
+    columns_ = std::move(columns);
+  }
 
  private:
+  /** How to compare a column of the key. */
+  struct KeyColumn {
+    uint32_t offset_;
+    bool is_inlined_;
+    /** The kernel comparing values of the column, or nullptr to compare them as Values. */
+    SerializedCompareFn compare_;
+  };
+
   Schema *key_schema_;
+  /** The key columns, shared by all copies of the comparator. */
+  std::shared_ptr<const std::vector<KeyColumn>> columns_;
 };
 
+/**
+ * Whether a key type is a GenericKey, which holds the serialized tuple of its columns and so can carry the included
+ * columns of a covering index after the key columns.
+ */
+template <typename KeyType>
+struct IsGenericKey : std::false_type {};
+
+template <size_t KeySize>
+struct IsGenericKey<GenericKey<KeySize>> : std::true_type {};
+
 }  // namespace bustub
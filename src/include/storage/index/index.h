@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -37,12 +39,24 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = false, std::vector<uint32_t> include_attrs = {})
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        include_attrs_(std::move(include_attrs)),
+        is_unique_(is_unique) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
+    entry_attrs_ = key_attrs_;
+    entry_attrs_.insert(entry_attrs_.end(), include_attrs_.begin(), include_attrs_.end());
+    entry_schema_ = include_attrs_.empty() ? key_schema_ : Schema::CopySchema(tuple_schema, entry_attrs_);
   }
 
-  ~IndexMetadata() { delete key_schema_; }
+  ~IndexMetadata() {
+    if (entry_schema_ != key_schema_) {
+      delete entry_schema_;
+    }
+    delete key_schema_;
+  }
 
   inline const std::string &GetName() const { return name_; }
 
@@ -60,6 +74,28 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns the base table columns stored in the index entries besides the key, for index-only scans
+  inline const std::vector<uint32_t> &GetIncludeAttrs() const { return include_attrs_; }
+
+  // Returns the base table columns of an index entry: the key columns, then the included columns
+  inline const std::vector<uint32_t> &GetEntryAttrs() const { return entry_attrs_; }
+
+  // Returns a schema object pointer that represents an index entry, the key schema if nothing is included
+  inline Schema *GetEntrySchema() const { return entry_schema_; }
+
+  /**
+   * @param column_attrs base table columns a query reads
+   * @return true if the index entries hold all of them, so the query can be answered from the index alone
+   */
+  bool Covers(const std::vector<uint32_t> &column_attrs) const {
+    return std::all_of(column_attrs.begin(), column_attrs.end(), [&](uint32_t attr) {
+      return std::find(entry_attrs_.begin(), entry_attrs_.end(), attr) != entry_attrs_.end();
+    });
+  }
+
+  // Whether every key maps to a single tuple; otherwise tuples may share a key
+  inline bool IsUnique() const { return is_unique_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -67,8 +103,12 @@ class IndexMetadata {
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
        << "Type = B+Tree, "
+       << "Unique = " << is_unique_ << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
+    if (!include_attrs_.empty()) {
+      os << " INCLUDE " << entry_schema_->ToString();
+    }
 
     return os.str();
   }
@@ -78,10 +118,20 @@ class IndexMetadata {
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  // The base table columns stored in the entries besides the key
+  const std::vector<uint32_t> include_attrs_;
+  // key_attrs_ followed by include_attrs_
+  std::vector<uint32_t> entry_attrs_;
+  const bool is_unique_;
   // schema of the indexed key
   Schema *key_schema_;
+  // schema of an index entry, key_schema_ if nothing is included
+  Schema *entry_schema_;
 };
 
+/** Order of an index range scan. */
+enum class ScanDirection { FORWARD, BACKWARD };
+
 /////////////////////////////////////////////////////////////////////
 // Index class definition
 /////////////////////////////////////////////////////////////////////
@@ -117,6 +167,10 @@ class Index {
 
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  Schema *GetEntrySchema() const { return metadata_->GetEntrySchema(); }
+
+  const std::vector<uint32_t> &GetEntryAttrs() const { return metadata_->GetEntryAttrs(); }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -129,7 +183,8 @@ class Index {
   ///////////////////////////////////////////////////////////////////
   // Point Modification
   ///////////////////////////////////////////////////////////////////
-  // designed for secondary indexes.
+  // designed for secondary indexes. The entry tuples of InsertEntry and DeleteEntry have the entry schema: the key
+  // columns followed by the included columns, see IndexMetadata::GetEntryAttrs.
   virtual void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
   // delete the index entry linked to given tuple
@@ -137,6 +192,55 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Scan many keys at once, e.g. the probes of an index join. Indexes that can look keys up faster together than one
+   * at a time override this; the default scans them one by one.
+   * @param keys the keys, in any order
+   * @param[out] result one vector per key, in the order of keys, holding the rids of its entries
+   * @param transaction the transaction scanning the index
+   */
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                        Transaction *transaction) {
+    result->assign(keys.size(), std::vector<RID>());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*result)[i], transaction);
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Range Scan
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Scan the entries whose keys lie in a range, in key order, e.g. for BETWEEN or ORDER BY ... DESC LIMIT k. Ordered
+   * indexes start at the bound the scan starts from and stop at the other one, or after limit entries.
+   * @param low_key the lower bound of the range, nullptr if there is none
+   * @param low_inclusive whether the range includes low_key
+   * @param high_key the upper bound of the range, nullptr if there is none
+   * @param high_inclusive whether the range includes high_key
+   * @param direction FORWARD for ascending keys, BACKWARD for descending keys
+   * @param limit the most entries to scan
+   * @param[out] result the rids of the entries scanned, in scan order
+   * @param transaction the transaction scanning the index
+   */
+  virtual void ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                         ScanDirection direction, size_t limit, std::vector<RID> *result, Transaction *transaction) {
+    throw NotImplementedException("Index does not support range scans: " + GetName());
+  }
+
+  /**
+   * Index-only range scan: like ScanRange, but return the index entries themselves, so that a query whose columns
+   * the index covers (see IndexMetadata::Covers) does not have to fetch the tuples from the table.
+   * @param[out] result the entries scanned, in scan order, as tuples of the entry schema whose rids are the rids of
+   * the table tuples they index
+   * @see ScanRange for the other parameters
+   */
+  virtual void ScanEntries(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                           ScanDirection direction, size_t limit, std::vector<Tuple> *result,
+                           Transaction *transaction) {
+    throw NotImplementedException("Index does not support index-only scans: " + GetName());
+  }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
@@ -13,17 +13,53 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * IndexIterator walks the leaf pages of a B+ tree from left to right, or with operator-- from right to left. The leaf
+ * of the current pair stays pinned and read latched until the iterator moves past it, so the pair it points to stays
+ * valid; the next leaf is pinned before the current one is released, but the iterator never holds two latches at
+ * once, so it cannot deadlock with writers merging leaves. Pairs moved between leaves by concurrent writers may be
+ * missed or produced twice.
+ *
+ * Moving left follows the prev link of the leaf, and takes the leaf it finds only if that leaf still links to the one
+ * it came from; a split or a merge in between makes it search the tree again for the pairs before the last leaf.
+ *
+ * A key with a posting list produces one pair per value of the list, read in full when the iterator reaches the key.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  // you may define your own constructor based on your member variables
+  /** Create the end iterator. */
   IndexIterator();
+
+  /**
+   * Create an iterator positioned on a pair of a leaf.
+   * @param tree the tree of the leaf
+   * @param leaf the leaf page, pinned and read latched by the caller; the iterator takes both over
+   * @param index the position of the pair in the leaf. Past its end the iterator moves right to the next pair, at -1
+   * it moves left to the pair before the leaf
+   * @param bound at -1 in an empty leaf, the key the pairs before the leaf are less than; nullptr if they may have any
+   * key
+   * @param backward whether the iterator is about to move left, so that it starts on the last value of a posting list
+   */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *leaf, int index,
+                const KeyType *bound = nullptr, bool backward = false);
+
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+  IndexIterator(const IndexIterator &) = delete;
+  IndexIterator &operator=(const IndexIterator &) = delete;
+
   ~IndexIterator();
 
   bool isEnd();
@@ -32,12 +68,51 @@ class IndexIterator {
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  /** Move to the pair before the current one; the iterator is at the end once it moves past the first pair. */
+  IndexIterator &operator--();
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const {
+    return page_id_ == itr.page_id_ && index_ == itr.index_ && posting_index_ == itr.posting_index_;
+  }
+
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
+  LeafPage *GetLeaf() const { return reinterpret_cast<LeafPage *>(page_->GetData()); }
+
+  /** Move to the next leaf while the current position is past the end of its leaf. */
+  void SkipExhaustedLeaves();
+
+  /** Move to the previous leaf while the current position is before the start of its leaf. */
+  void SkipExhaustedLeavesBackward();
+
+  /**
+   * Read the posting list of the current pair, if it has one, and position the iterator on its first value, or on its
+   * last one if backward.
+   */
+  void LoadPosting(bool backward);
+
+  /** Take over a leaf, pinned and read latched, and position the iterator on a pair of it. */
+  void Acquire(Page *leaf, int index);
+
+  /** Unlatch and unpin the current leaf, leaving the iterator at the end. */
+  void Release();
+
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  /** The current leaf, nullptr at the end. */
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int index_{0};
+  /** While moving left, the lowest key seen so far: the pairs still to come are less than it. */
+  KeyType bound_{};
+  bool has_bound_{false};
+  /** The values of the posting list of the current pair, empty if it has none, and the current one of them. */
+  std::vector<ValueType> posting_;
+  int posting_index_{0};
+  MappingType current_{};
 };
 
 }  // namespace bustub
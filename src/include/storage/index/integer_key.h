@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key.h
+//
+// Identification: src/include/storage/index/integer_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Key of a single integer column, stored as a native T (int32_t or int64_t). B+ tree pages of integer keys search
+ * with SimdCountLess instead of comparing one key at a time, see IsIntegerComparator. NULL is stored as the NULL
+ * value of the column's type, which is its smallest value.
+ */
+template <typename T>
+class IntegerKey {
+  static_assert(std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>, "Only 32-bit and 64-bit integer keys.");
+
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    BUSTUB_ASSERT(key_schema.GetColumnCount() == 1, "An integer key has a single column.");
+    Value value = tuple.GetValue(&key_schema, 0);
+    switch (value.GetTypeId()) {
+      case TypeId::TINYINT:
+        value_ = value.GetAs<int8_t>();
+        break;
+      case TypeId::SMALLINT:
+        value_ = value.GetAs<int16_t>();
+        break;
+      case TypeId::INTEGER:
+        value_ = value.GetAs<int32_t>();
+        break;
+      case TypeId::BIGINT:
+        BUSTUB_ASSERT(sizeof(T) == sizeof(int64_t), "A BIGINT key column needs a 64-bit integer key.");
+        value_ = static_cast<T>(value.GetAs<int64_t>());
+        break;
+      default:
+        throw Exception(ExceptionType::MISMATCH_TYPE, "An integer key needs an integer key column.");
+    }
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) { value_ = static_cast<T>(key); }
+
+  // NOTE: for test purpose only
+  inline int64_t ToString() const { return value_; }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const IntegerKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  T value_;
+};
+
+/** Compares integer keys. */
+template <typename T>
+class IntegerComparator {
+ public:
+  inline int operator()(const IntegerKey<T> &lhs, const IntegerKey<T> &rhs) const {
+    return lhs.value_ < rhs.value_ ? -1 : (rhs.value_ < lhs.value_ ? 1 : 0);
+  }
+
+  IntegerComparator(const IntegerComparator &other) = default;
+
+  // constructor, the key schema is a single integer column
+  explicit IntegerComparator([[maybe_unused]] Schema *key_schema) {}
+};
+
+/** Whether a comparator compares IntegerKeys, whose pages can be searched with SimdCountLess. */
+template <typename KeyComparator>
+struct IsIntegerComparator : std::false_type {};
+
+template <typename T>
+struct IsIntegerComparator<IntegerComparator<T>> : std::true_type {};
+
+}  // namespace bustub
@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Writes values in the normalized key encoding: bytes that compare with memcmp in the order of the values, so that
+ * comparing two keys needs neither the schema nor a single Value.
+ *
+ * Every column is appended in key schema order:
+ *  - integers and BOOLEAN: big-endian, with the sign bit flipped
+ *  - DECIMAL: big-endian IEEE 754 bits, with the sign bit flipped for positive numbers and all bits for negative ones
+ *  - TIMESTAMP: big-endian, plus one
+ *  - VARCHAR: 0 if NULL, else 1, then the characters with every 0 byte escaped as 0 255, then 0 0
+ * Fixed-length NULLs are stored as the smallest value of their type (one past the largest for TIMESTAMP), and so
+ * sort first, like VARCHAR NULLs do. No column encoding is a prefix of another one of the same column, so neither is
+ * the encoding of a key, and the encodings of keys compare like the keys even when their lengths differ.
+ *
+ * The bytes are handed to put(uint8_t byte), which returns false once it does not need any more of them.
+ */
+class KeyNormalizer {
+ public:
+  template <class Put>
+  static inline void Append(const Value &value, Put &&put) {
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendSigned(value.GetAs<int8_t>(), put);
+        return;
+      case TypeId::SMALLINT:
+        AppendSigned(value.GetAs<int16_t>(), put);
+        return;
+      case TypeId::INTEGER:
+        AppendSigned(value.GetAs<int32_t>(), put);
+        return;
+      case TypeId::BIGINT:
+        AppendSigned(value.GetAs<int64_t>(), put);
+        return;
+      case TypeId::DECIMAL: {
+        double decimal = value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(uint64_t));
+        AppendUnsigned((bits >> 63) != 0 ? ~bits : bits | (1ULL << 63), put);
+        return;
+      }
+      case TypeId::TIMESTAMP:
+        AppendUnsigned(static_cast<uint64_t>(value.GetAs<uint64_t>() + 1), put);
+        return;
+      case TypeId::VARCHAR: {
+        if (value.IsNull()) {
+          put(0);
+          return;
+        }
+        if (!put(1)) {
+          return;
+        }
+        const char *data = value.GetData();
+        for (uint32_t i = 0; i + 1 < value.GetLength(); i++) {
+          if (!put(static_cast<uint8_t>(data[i])) || (data[i] == '\0' && !put(255))) {
+            return;
+          }
+        }
+        if (put(0)) {
+          put(0);
+        }
+        return;
+      }
+      default:
+        throw Exception(ExceptionType::MISMATCH_TYPE, "Cannot normalize a key column of this type.");
+    }
+  }
+
+  template <class U, class Put>
+  static inline void AppendUnsigned(U bits, Put &&put) {
+    for (int shift = 8 * (sizeof(U) - 1); shift >= 0; shift -= 8) {
+      put(static_cast<uint8_t>(bits >> shift));
+    }
+  }
+
+  template <class S, class Put>
+  static inline void AppendSigned(S value, Put &&put) {
+    using U = std::make_unsigned_t<S>;
+    AppendUnsigned(static_cast<U>(static_cast<U>(value) ^ (U{1} << (8 * sizeof(U) - 1))), put);
+  }
+};
+
+/**
+ * Normalized key: the key columns encoded by KeyNormalizer. The encoding is cut off after KeySize bytes and padded
+ * with zeroes, so keys that only differ past KeySize bytes compare equal; unlike a GenericKey, a normalized key does
+ * not spend bytes on VARCHAR offsets and lengths.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    memset(data_, 0, KeySize);
+    size_t size = 0;
+    auto put = [&](uint8_t byte) {
+      if (size < KeySize) {
+        data_[size++] = static_cast<char>(byte);
+      }
+      return size < KeySize;
+    };
+    for (uint32_t i = 0; i < key_schema.GetColumnCount() && size < KeySize; i++) {
+      KeyNormalizer::Append(tuple.GetValue(&key_schema, i), put);
+    }
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) {
+    memset(data_, 0, KeySize);
+    size_t size = 0;
+    KeyNormalizer::AppendSigned(key, [&](uint8_t byte) {
+      if (size < KeySize) {
+        data_[size++] = static_cast<char>(byte);
+      }
+      return size < KeySize;
+    });
+  }
+
+  // NOTE: for test purpose only
+  // decode the first 8 bytes as a BIGINT
+  inline int64_t ToString() const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(int64_t) && i < KeySize; i++) {
+      bits |= static_cast<uint64_t>(static_cast<uint8_t>(data_[i])) << (8 * (sizeof(int64_t) - 1 - i));
+    }
+    return static_cast<int64_t>(bits ^ (1ULL << 63));
+  }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+  char data_[KeySize];
+};
+
+/**
+ * Compares normalized keys with memcmp. The comparisons that skip a prefix are what lets B+ tree pages compare only
+ * past the bytes all their keys share, see IsBytewiseComparator.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    return memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+
+  /** Compare the first length bytes of two keys. */
+  inline int ComparePrefix(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs,
+                           size_t length) const {
+    return memcmp(lhs.data_, rhs.data_, length);
+  }
+
+  /** Compare two keys that share their first offset bytes. */
+  inline int CompareFrom(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs, size_t offset) const {
+    return memcmp(lhs.data_ + offset, rhs.data_ + offset, KeySize - offset);
+  }
+
+  /** @return the number of leading bytes two keys share */
+  inline size_t CommonPrefixLength(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    size_t length = 0;
+    while (length < KeySize && lhs.data_[length] == rhs.data_[length]) {
+      length++;
+    }
+    return length;
+  }
+
+  NormalizedComparator(const NormalizedComparator &other) = default;
+
+  // constructor, the key schema is already part of the encoding
+  explicit NormalizedComparator([[maybe_unused]] Schema *key_schema) {}
+};
+
+/** Whether a comparator compares keys bytewise and supports the prefix comparisons of NormalizedComparator. */
+template <typename KeyComparator>
+struct IsBytewiseComparator : std::false_type {};
+
+template <size_t KeySize>
+struct IsBytewiseComparator<NormalizedComparator<KeySize>> : std::true_type {};
+
+}  // namespace bustub
@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.h
+//
+// Identification: src/include/storage/index/posting_list.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "storage/page/posting_page.h"
+
+namespace bustub {
+
+/**
+ * PostingList keeps the RIDs of a key with too many duplicates for a leaf of a non-unique BPlusTree out of line, in
+ * chains of posting pages. The leaf holds one entry for the key, whose value is a posting reference:
+ *  ---------------------------------------------------------------
+ *  | PageId = FirstPostingPageId (4) | SlotNum = POSTING_FLAG (4) |
+ *  ---------------------------------------------------------------
+ * Slot numbers of real RIDs never reach the flag, so references can be told apart from RIDs by the slot alone.
+ *
+ * The RIDs of a list are sorted by RID::Get() and distinct. Every posting page starts with its first RID in full,
+ * followed by the differences between consecutive RIDs as LEB128 varints, which for the RIDs of a key clustered in a
+ * few table pages mostly take one or two bytes each.
+ *
+ * Posting pages are not latched: a list belongs to the leaf entry referring to it, and is protected by the latch of
+ * that leaf. Posting pages are not logged.
+ */
+class PostingList {
+ public:
+  /** Set in the slot number of a posting reference. */
+  static constexpr uint32_t POSTING_FLAG = 1U << 31;
+
+  /**
+   * Create a posting list store.
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit PostingList(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /** @return true if value is a posting reference rather than a RID */
+  static bool IsPosting(const RID &value) { return (value.GetSlotNum() & POSTING_FLAG) != 0; }
+
+  /** @return a posting reference to the list starting at first_page_id */
+  static RID MakeReference(page_id_t first_page_id) { return RID(first_page_id, POSTING_FLAG); }
+
+  /**
+   * Write RIDs into a new posting list.
+   * @param rids the RIDs, sorted by RID::Get() and distinct
+   * @return a posting reference to the list
+   * @throws Exception OUT_OF_MEMORY if the pages could not be allocated, in which case nothing is left behind
+   */
+  RID Create(const std::vector<RID> &rids);
+
+  /**
+   * Append the RIDs of a posting list to result, in order.
+   * @param reference the posting reference
+   * @param[out] result where to append the RIDs
+   */
+  void Read(const RID &reference, std::vector<RID> *result);
+
+  /**
+   * Add a RID to a posting list.
+   * @param reference the posting reference
+   * @param rid the RID
+   * @return false if the list already holds rid
+   */
+  bool Insert(const RID &reference, const RID &rid);
+
+  /**
+   * Take a RID out of a posting list. The list keeps at least one RID.
+   * @param[in,out] reference the posting reference, updated if the list now starts on another page
+   * @param rid the RID
+   * @return false if the list does not hold rid
+   */
+  bool Remove(RID *reference, const RID &rid);
+
+  /**
+   * @param reference the posting reference
+   * @param[out] rid the RID of the list, if it holds only one
+   * @return true if the list holds exactly one RID
+   */
+  bool GetSingle(const RID &reference, RID *rid);
+
+  /**
+   * Delete the pages of a posting list.
+   * @param reference the posting reference
+   */
+  void Free(const RID &reference);
+
+ private:
+  /** Fetch a posting page, throwing an out of memory exception if the buffer pool has no frame for it. */
+  PostingPage *FetchPage(page_id_t page_id);
+
+  /** Allocate and initialize a posting page, throwing an out of memory exception if there is no frame for it. */
+  PostingPage *NewPage();
+
+  /** @return the first RID of a posting page, which must not be empty */
+  static int64_t FirstRid(PostingPage *page);
+
+  /** Append the RIDs of a posting page to result, as RID::Get() values. */
+  static void Decode(PostingPage *page, std::vector<int64_t> *result);
+
+  /** @return the number of bytes rids[begin, end) take encoded */
+  static uint32_t EncodedSize(const std::vector<int64_t> &rids, size_t begin, size_t end);
+
+  /** Overwrite the RIDs of a posting page with rids[begin, end), which must fit. */
+  static void Encode(PostingPage *page, const std::vector<int64_t> &rids, size_t begin, size_t end);
+
+  /**
+   * Walk a posting list to the page that holds rid, or would hold it: the last page whose first RID is not greater.
+   * @param first_page_id the first page of the list
+   * @param rid the RID, as a RID::Get() value
+   * @param[out] prev_page_id the page before the one returned, INVALID_PAGE_ID if it is the first
+   * @return the page, pinned
+   */
+  PostingPage *FindPage(page_id_t first_page_id, int64_t rid, page_id_t *prev_page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// simd_search.h
+//
+// Identification: src/include/storage/index/simd_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+/** Sorted keys are binary searched down to this many, then counted with SimdCountLess. */
+static constexpr int SIMD_SEARCH_WINDOW = 32;
+
+/**
+ * Count how many of n integers are less than key. The integers are laid out stride bytes apart from base, e.g. the
+ * keys of an array of key-value pairs, and are gathered into vector registers 16 (AVX-512) or 8 (AVX2) 32-bit, or 8
+ * or 4 64-bit integers at a time; without either instruction set, and for the last few integers, they are compared
+ * one by one. The count does not depend on the order of the integers, but on sorted integers it is their lower bound.
+ * @param base address of the first integer
+ * @param stride number of bytes from one integer to the next
+ * @param n number of integers
+ * @param key the integer to compare with
+ * @return the number of integers less than key
+ */
+template <typename T>
+inline int SimdCountLess(const char *base, size_t stride, int n, T key) {
+  static_assert(std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t>, "Only 32-bit and 64-bit integers.");
+  int count = 0;
+  int i = 0;
+#if defined(__AVX512F__)
+  if constexpr (sizeof(T) == sizeof(int32_t)) {
+    const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                                               _mm512_set1_epi32(static_cast<int32_t>(stride)));
+    const __m512i keys = _mm512_set1_epi32(key);
+    for (; i + 16 <= n; i += 16) {
+      __m512i values = _mm512_i32gather_epi32(offsets, base + i * stride, 1);
+      count += __builtin_popcount(_mm512_cmplt_epi32_mask(values, keys));
+    }
+  } else {
+    const auto wide_stride = static_cast<int64_t>(stride);
+    const __m512i offsets = _mm512_setr_epi64(0, wide_stride, 2 * wide_stride, 3 * wide_stride, 4 * wide_stride,
+                                              5 * wide_stride, 6 * wide_stride, 7 * wide_stride);
+    const __m512i keys = _mm512_set1_epi64(key);
+    for (; i + 8 <= n; i += 8) {
+      __m512i values = _mm512_i64gather_epi64(offsets, base + i * stride, 1);
+      count += __builtin_popcount(_mm512_cmplt_epi64_mask(values, keys));
+    }
+  }
+#elif defined(__AVX2__)
+  if constexpr (sizeof(T) == sizeof(int32_t)) {
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                               _mm256_set1_epi32(static_cast<int32_t>(stride)));
+    const __m256i keys = _mm256_set1_epi32(key);
+    for (; i + 8 <= n; i += 8) {
+      __m256i values = _mm256_i32gather_epi32(reinterpret_cast<const int *>(base + i * stride), offsets, 1);
+      count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(keys, values))));
+    }
+  } else {
+    const auto wide_stride = static_cast<int64_t>(stride);
+    const __m256i offsets = _mm256_setr_epi64x(0, wide_stride, 2 * wide_stride, 3 * wide_stride);
+    const __m256i keys = _mm256_set1_epi64x(key);
+    for (; i + 4 <= n; i += 4) {
+      __m256i values = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(base + i * stride),  // NOLINT
+                                              offsets, 1);
+      count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(keys, values))));
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    T value;
+    memcpy(&value, base + i * stride, sizeof(T));
+    count += value < key ? 1 : 0;
+  }
+  return count;
+}
+
+}  // namespace bustub
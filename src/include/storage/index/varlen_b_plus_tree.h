@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree.h
+//
+// Identification: src/include/storage/index/varlen_b_plus_tree.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "common/rwlatch.h"
+#include "storage/index/varlen_index_iterator.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/**
+ * B+ tree whose keys are byte strings of any length up to MAX_KEY_SIZE, compared with memcmp, e.g. the normalized
+ * encoding of key columns, see KeyNormalizer. BPlusTree stores keys of a fixed size, so that short keys waste the
+ * rest of their size and longer ones do not fit; this tree stores them in BPlusTreeSlottedPages, which take as many
+ * keys as their actual sizes allow. Keys are unique, and map to a RID.
+ *
+ * Pages split where both halves take about the same space rather than hold the same number of keys. A leaf split
+ * posts the shortest separator to its parent: the shortest prefix of the first key of the right leaf that is still
+ * greater than the last key of the left one, which keeps the internal pages of a tree of long keys with common
+ * prefixes small.
+ *
+ * Concurrency: latch crabbing, optimistic first, like BPlusTree. Readers crab down with read latches. Writers first
+ * descend read latching the inner pages and write latching only the leaf, and change the leaf right there if it has
+ * room. Only otherwise do they descend again write latching from the root down, letting go of the latches above the
+ * first page with room for a separator of MAX_KEY_SIZE bytes, and split their way back up the latched pages. A root
+ * split happens under root_latch_, which protects root_page_id_. Removes only take keys out of their leaf; pages are
+ * never merged, so a remove never latches more than its leaf, and page ids of the tree never change their page type.
+ */
+class VarlenBPlusTree {
+  using InternalPage = BPlusTreeSlottedPage<page_id_t>;
+  using LeafPage = BPlusTreeSlottedPage<RID>;
+
+ public:
+  /** The longest key the tree takes. */
+  static constexpr uint32_t MAX_KEY_SIZE = LeafPage::MAX_KEY_SIZE;
+
+  VarlenBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager);
+
+  // Returns true if this B+ tree has no keys and values.
+  bool IsEmpty() const;
+
+  /**
+   * Insert a key-value pair.
+   * @return false if the key is there already
+   * @throws Exception OUT_OF_RANGE if the key is longer than MAX_KEY_SIZE bytes
+   */
+  bool Insert(std::string_view key, const RID &value);
+
+  /** Remove a key. @return false if the key is not there */
+  bool Remove(std::string_view key);
+
+  // return the value associated with a given key
+  bool GetValue(std::string_view key, std::vector<RID> *result);
+
+  // index iterator
+  VarlenIndexIterator begin();
+  VarlenIndexIterator Begin(std::string_view key);
+  VarlenIndexIterator end();
+
+ private:
+  /**
+   * Descend to the leaf that should hold key, read latching the inner pages.
+   * @param left_most descend to the left most leaf instead
+   * @param exclusive whether to write latch the leaf rather than read latch it
+   * @return the leaf, pinned and latched, or nullptr if the tree is empty
+   */
+  Page *FindLeafPage(std::string_view key, bool left_most, bool exclusive);
+
+  /**
+   * Insert a key-value pair whose leaf has no room for it, or into an empty tree, splitting pages on the way up.
+   * @return false if the key is there already
+   */
+  bool InsertPessimistic(std::string_view key, const RID &value);
+
+  /**
+   * Split a full internal page around its middle, after which the separator of a split child can go into one half.
+   * @param node the internal page, write latched
+   * @param[out] middle_key the key between the halves, to post to the parent
+   * @return the new right half, pinned and write latched
+   */
+  Page *SplitInternal(InternalPage *node, std::string *middle_key);
+
+  /** @return the shortest key greater than left and not greater than right, which must be greater than left */
+  static std::string ShortestSeparator(std::string_view left, std::string_view right);
+
+  /** Allocate and initialize a page, throwing an out of memory exception if there is no frame for it. */
+  Page *NewPage(IndexPageType page_type);
+
+  /** Fetch a page, throwing an out of memory exception if the buffer pool has no frame for it. */
+  Page *FetchPage(page_id_t page_id);
+
+  /** Unlatch and unpin pages write latched by a pessimistic writer. */
+  void ReleasePages(std::vector<Page *> *pages, bool dirty);
+
+  void UpdateRootPageId(int insert_record = 0);
+
+  std::string index_name_;
+  page_id_t root_page_id_{INVALID_PAGE_ID};
+  mutable ReaderWriterLatch root_latch_;
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+}  // namespace bustub
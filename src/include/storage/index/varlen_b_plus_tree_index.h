@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree_index.h
+//
+// Identification: src/include/storage/index/varlen_b_plus_tree_index.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "storage/index/index.h"
+#include "storage/index/varlen_b_plus_tree.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * Index over a VarlenBPlusTree, for keys too long or too varied in length for the key sizes of BPlusTreeIndex, e.g.
+ * long VARCHAR columns. The tree key of an entry is the whole KeyNormalizer encoding of its key columns, which is
+ * never cut off. A non-unique index appends the rid of the entry to it, big-endian, so that equal keys are distinct
+ * tree keys ordered by rid; since the encoding of the key columns is prefix-free, the entries of a key are the tree
+ * keys that start with its encoding.
+ */
+class VarlenBPlusTreeIndex : public Index {
+ public:
+  /** @throws NotImplementedException if the index includes columns */
+  VarlenBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+
+  /** @throws Exception OUT_OF_RANGE if the encoded key is longer than VarlenBPlusTree::MAX_KEY_SIZE bytes */
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key, bool high_inclusive,
+                 ScanDirection direction, size_t limit, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Index the tuples already in a table: sort their keys in memory and insert them in order, so that every insert
+   * goes to the right most leaf.
+   * @param table_heap the table of the index
+   * @param tuple_schema the schema of the table
+   * @param transaction the transaction reading the table
+   * @throws Exception if the index is unique and two tuples share a key
+   */
+  void BulkLoad(TableHeap *table_heap, const Schema &tuple_schema, Transaction *transaction);
+
+  /** Size of the rid a non-unique index appends to its tree keys. */
+  static constexpr size_t RID_SUFFIX_SIZE = sizeof(uint32_t) * 2;
+
+ private:
+  /** @return the KeyNormalizer encoding of the key columns of a key tuple */
+  std::string EncodeKey(const Tuple &key) const;
+
+  /** @return the tree key of an entry, the encoded key followed by the rid in a non-unique index */
+  std::string EntryKey(const Tuple &key, RID rid) const;
+
+  /** @return the encoded key columns of a tree key, without the rid suffix of a non-unique index */
+  std::string_view KeyPart(std::string_view entry_key) const;
+
+  VarlenBPlusTree container_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_index_iterator.h
+//
+// Identification: src/include/storage/index/varlen_index_iterator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string_view>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+/**
+ * VarlenIndexIterator walks the leaf pages of a VarlenBPlusTree from left to right. Like IndexIterator, the leaf of
+ * the current pair stays pinned and read latched until the iterator moves past it, and the next leaf is pinned before
+ * the current one is released, but never latched at the same time. Leaves emptied by removes are skipped.
+ */
+class VarlenIndexIterator {
+ public:
+  /** Create the end iterator. */
+  VarlenIndexIterator() = default;
+
+  /**
+   * Create an iterator positioned on a pair of a leaf.
+   * @param buffer_pool_manager the buffer pool manager of the tree
+   * @param leaf the leaf page, pinned and read latched by the caller; the iterator takes both over
+   * @param index the position of the pair in the leaf; past its end the iterator moves right to the next pair
+   */
+  VarlenIndexIterator(BufferPoolManager *buffer_pool_manager, Page *leaf, int index);
+
+  VarlenIndexIterator(VarlenIndexIterator &&other) noexcept;
+  VarlenIndexIterator &operator=(VarlenIndexIterator &&other) noexcept;
+  VarlenIndexIterator(const VarlenIndexIterator &) = delete;
+  VarlenIndexIterator &operator=(const VarlenIndexIterator &) = delete;
+
+  ~VarlenIndexIterator();
+
+  bool isEnd() const { return page_ == nullptr; }
+
+  /** @return the current pair; the key points into the leaf, and is valid until the iterator moves */
+  std::pair<std::string_view, RID> operator*() const;
+
+  VarlenIndexIterator &operator++();
+
+  bool operator==(const VarlenIndexIterator &itr) const { return page_id_ == itr.page_id_ && index_ == itr.index_; }
+
+  bool operator!=(const VarlenIndexIterator &itr) const { return !(*this == itr); }
+
+ private:
+  using LeafPage = BPlusTreeSlottedPage<RID>;
+
+  LeafPage *GetLeaf() const { return reinterpret_cast<LeafPage *>(page_->GetData()); }
+
+  /** Move to the next leaf while the current position is past the end of its leaf. */
+  void SkipExhaustedLeaves();
+
+  /** Unlatch and unpin the current leaf, leaving the iterator at the end. */
+  void Release();
+
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  /** The current leaf, nullptr at the end. */
+  Page *page_{nullptr};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  int index_{0};
+};
+
+}  // namespace bustub
@@ -18,26 +18,29 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 32
+#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType)) / sizeof(MappingType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. In a non-unique tree a key may have several pairs, ordered by RID and all kept in the same leaf, so that
+ * splits and redistributions move the pairs of a key as a whole, see BPlusTree.
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes plus the size of a key in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) | HighKey (sizeof(KeyType))
+ *  -----------------------------------------------------------------------------------------
+ * HighKey is the high key of B-link trees, see BPlusTreeInternalPage; it is only maintained by B-link trees.
+ * PrevPageId links the leaves from right to left for backward scans, see IndexIterator.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,26 +51,40 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
+  KeyType GetHighKey() const;
+  void SetHighKey(const KeyType &high_key);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
   const MappingType &GetItem(int index);
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+  /** @return the number of pairs from index on whose key equals the key at index */
+  int RunLength(int index, const KeyComparator &comparator) const;
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+  /** Insert a pair at index, which must keep the pairs in order. */
+  void InsertAt(int index, const KeyType &key, const ValueType &value);
+  /** Remove count pairs from index on. */
+  void RemoveAt(int index, int count = 1);
+  void PopulateFrom(const MappingType *items, int size);
 
   // Split and Merge utility methods
-  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveHalfTo(BPlusTreeLeafPage *recipient, const KeyComparator &comparator);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
-  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
-  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient, const KeyComparator &comparator);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient, const KeyComparator &comparator);
 
  private:
   void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+  void CopyFirstNFrom(MappingType *items, int size);
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  KeyType high_key_;
   MappingType array[0];
 };
 }  // namespace bustub
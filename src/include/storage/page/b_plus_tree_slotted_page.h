@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_slotted_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_slotted_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_SLOTTED_PAGE_TYPE BPlusTreeSlottedPage<ValueType>
+
+/**
+ * Leaf or internal page of a VarlenBPlusTree, whose keys are byte strings of any length up to MAX_KEY_SIZE, compared
+ * with memcmp. Instead of an array of fixed-size pairs, the page keeps an array of slots sorted by key, each holding
+ * the offset and length of its key and its value, and stores the keys themselves in a heap growing down from the end
+ * of the page, so that a page holds as many keys as their actual sizes allow:
+ *  ------------------------------------------------------------------------------------------
+ * | HEADER | SLOT(0) | SLOT(1) | ... | SLOT(n-1) | ... FREE SPACE ... | KEY(n-1) ... KEY(0) |
+ *  ------------------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 32 bytes in total):
+ *  ----------------------------------------------------------------
+ * | BPlusTreePage header (24) | NextPageId (4) | HeapOffset (4) |
+ *  ----------------------------------------------------------------
+ *  Slot format (size in byte, 4 bytes plus the size of a value):
+ *  ---------------------------------------------------
+ * | KeyOffset (2) | KeyLength (2) | Value (sizeof(ValueType)) |
+ *  ---------------------------------------------------
+ * Leaf pages map keys to RIDs and link to their right sibling through NextPageId. Internal pages map keys to child
+ * page ids like BPlusTreeInternalPage: the key of the first slot is empty, and child i holds the keys K with
+ * KEY(i) <= K < KEY(i+1). The heap is kept compact, so the free space of a page is all between the slots and the keys.
+ * Size is the number of slots; max size and parent page id are not used.
+ */
+template <typename ValueType>
+class BPlusTreeSlottedPage : public BPlusTreePage {
+ public:
+  struct Slot {
+    uint16_t key_offset_;
+    uint16_t key_length_;
+    ValueType value_;
+  };
+
+  static constexpr uint32_t HEADER_SIZE = 32;
+
+  /** The longest key a page takes, so that a full page can be split in two with room for another key of that size. */
+  static constexpr uint32_t MAX_KEY_SIZE = (PAGE_SIZE - HEADER_SIZE) / 4 - sizeof(Slot);
+
+  // must call initialize method after "create" a new node
+  void Init(page_id_t page_id, IndexPageType page_type);
+
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+
+  /** @return the key of a slot, valid until the page changes */
+  std::string_view KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+
+  /** @return the number of bytes between the slots and the keys */
+  uint32_t GetFreeSpace() const;
+
+  /** @return the number of bytes taken by the slots and the keys */
+  uint32_t GetUsedSpace() const { return PAGE_SIZE - HEADER_SIZE - GetFreeSpace(); }
+
+  /** @return the number of bytes a slot with a key of key_size bytes takes */
+  static constexpr uint32_t GetRequiredSpace(size_t key_size) { return sizeof(Slot) + key_size; }
+
+  /** @return true if the page has room for a slot with a key of key_size bytes */
+  bool HasRoom(size_t key_size) const { return GetFreeSpace() >= GetRequiredSpace(key_size); }
+
+  /** @return the first slot of a leaf whose key is not less than key, the size of the page if there is none */
+  int KeyIndex(std::string_view key) const;
+
+  /** @return the slot of an internal page whose child covers key */
+  int ChildIndex(std::string_view key) const;
+
+  /** @return the slot of an internal page pointing to a child, the size of the page if there is none */
+  int ValueIndex(const ValueType &value) const;
+
+  /**
+   * Insert a slot, moving the slots from index on one position right. The page must have room for it.
+   * @param index the position of the new slot, at most the size of the page
+   */
+  void InsertAt(int index, std::string_view key, const ValueType &value);
+
+  /** Remove a slot and its key, moving the slots after it one position left. */
+  void RemoveAt(int index);
+
+  /**
+   * @return where to split a page with at least two slots so that both halves take about the same space: the first
+   * slot of the right half, never the first slot
+   */
+  int SplitIndex() const;
+
+  /** Remove the slots from size on, and compact the keys of the others. */
+  void Truncate(int size);
+
+ private:
+  Slot *GetSlots() { return reinterpret_cast<Slot *>(reinterpret_cast<char *>(this) + HEADER_SIZE); }
+  const Slot *GetSlots() const {
+    return reinterpret_cast<const Slot *>(reinterpret_cast<const char *>(this) + HEADER_SIZE);
+  }
+
+  page_id_t next_page_id_;
+  /** Offset of the first byte of the key heap, PAGE_SIZE when empty. */
+  uint32_t heap_offset_;
+};
+
+}  // namespace bustub
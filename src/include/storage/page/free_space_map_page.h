@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A free space map page records, for a run of table pages, the page id and a one-byte fill category approximating
+ * the free space left on that page. The free space map of a table is a singly-linked list of these pages; entries are
+ * appended in the order the table pages are created, so the map also enumerates the pages of the table.
+ *
+ * Free space map page format (sizes in bytes):
+ *  ---------------------------------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | EntryCount (4) | TablePageId_1 (4) | ... | Category_1 (1) | ... |
+ *  ---------------------------------------------------------------------------------------------------------
+ *
+ * A page in category c has at least c * CATEGORY_SIZE bytes of free space.
+ */
+class FreeSpaceMapPage : public Page {
+ public:
+  /** Number of bytes of free space represented by one category step. */
+  static constexpr uint32_t CATEGORY_SIZE = PAGE_SIZE / 256;
+  /** Number of table pages tracked by one free space map page. */
+  static constexpr uint32_t CAPACITY = (PAGE_SIZE - 16) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  /**
+   * Initialize the free space map page header.
+   * @param page_id the page ID of this free space map page
+   */
+  void Init(page_id_t page_id);
+
+  /** @return the page ID of this free space map page */
+  page_id_t GetMapPageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the next free space map page */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next free space map page. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of table pages tracked by this page */
+  uint32_t GetEntryCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_ENTRY_COUNT); }
+
+  /** @return true if no more table pages can be tracked by this page */
+  bool IsFull() { return GetEntryCount() == CAPACITY; }
+
+  /**
+   * Start tracking a table page.
+   * @param table_page_id the table page to track
+   * @param category fill category of the table page, see ToCategory
+   * @return the slot of the new entry
+   */
+  uint32_t Append(page_id_t table_page_id, uint8_t category);
+
+  /** @return the table page tracked at slot slot_num */
+  page_id_t GetTablePageId(uint32_t slot_num) {
+    return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_ENTRIES + sizeof(page_id_t) * slot_num);
+  }
+
+  /** @return the fill category of the table page tracked at slot slot_num */
+  uint8_t GetCategory(uint32_t slot_num) {
+    return *reinterpret_cast<uint8_t *>(GetData() + OFFSET_CATEGORIES + slot_num);
+  }
+
+  /** Set the fill category of the table page tracked at slot slot_num. */
+  void SetCategory(uint32_t slot_num, uint8_t category) {
+    *reinterpret_cast<uint8_t *>(GetData() + OFFSET_CATEGORIES + slot_num) = category;
+  }
+
+  /**
+   * @param required_space the number of bytes needed
+   * @return the first slot whose table page surely has required_space bytes free, or GetEntryCount() if there is none
+   */
+  uint32_t FindSlot(uint32_t required_space);
+
+  /** @return the category of a page with free_space bytes free, rounded down */
+  static uint8_t ToCategory(uint32_t free_space) {
+    uint32_t category = free_space / CATEGORY_SIZE;
+    return static_cast<uint8_t>(category > UINT8_MAX ? UINT8_MAX : category);
+  }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_ENTRY_COUNT = 12;
+  static constexpr size_t OFFSET_ENTRIES = 16;
+  static constexpr size_t OFFSET_CATEGORIES = OFFSET_ENTRIES + sizeof(page_id_t) * CAPACITY;
+
+  /** Set the number of table pages tracked by this page. */
+  void SetEntryCount(uint32_t entry_count) { memcpy(GetData() + OFFSET_ENTRY_COUNT, &entry_count, sizeof(uint32_t)); }
+};
+
+}  // namespace bustub
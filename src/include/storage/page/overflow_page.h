@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_page.h
+//
+// Identification: src/include/storage/page/overflow_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * An overflow page holds one chunk of a value that is too large to be stored in its tuple. The chunks of a value are
+ * a singly-linked list of overflow pages, see OverflowStore.
+ *
+ * Overflow page format (sizes in bytes):
+ *  -----------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | DataSize (4) | ... DATA ... |
+ *  -----------------------------------------------------------------------
+ */
+class OverflowPage : public Page {
+ public:
+  /** Number of bytes of a value one overflow page holds. */
+  static constexpr uint32_t CAPACITY = PAGE_SIZE - 16;
+
+  /**
+   * Initialize the overflow page header.
+   * @param page_id the page ID of this overflow page
+   */
+  void Init(page_id_t page_id) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetNextPageId(INVALID_PAGE_ID);
+    SetDataSize(0);
+  }
+
+  /** @return the page ID of the next overflow page of the value */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next overflow page of the value. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of bytes of the value stored in this page */
+  uint32_t GetDataSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /** Set the number of bytes of the value stored in this page. */
+  void SetDataSize(uint32_t data_size) { memcpy(GetData() + OFFSET_DATA_SIZE, &data_size, sizeof(uint32_t)); }
+
+  /** @return the chunk of the value stored in this page */
+  char *GetChunk() { return GetData() + OFFSET_CHUNK; }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_DATA_SIZE = 12;
+  static constexpr size_t OFFSET_CHUNK = 16;
+};
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * PageGuard keeps a page pinned for as long as it lives, so that the page stays in its frame and pointers into it stay
+ * valid; it does not latch the page, readers latch it themselves while they look at its contents. The guard is movable
+ * but not copyable; the page is unpinned when the guard is destroyed, assigned to or explicitly released.
+ */
+class PageGuard {
+ public:
+  /** Create an empty guard that does not hold any page. */
+  PageGuard() = default;
+
+  /**
+   * Fetch a page and pin it.
+   * @param bpm the buffer pool manager to fetch the page from
+   * @param page_id id of the page to fetch
+   */
+  PageGuard(BufferPoolManager *bpm, page_id_t page_id) : bpm_(bpm), page_(bpm->FetchPage(page_id)) {}
+
+  PageGuard(PageGuard &&other) noexcept : bpm_(other.bpm_), page_(other.page_) { other.page_ = nullptr; }
+
+  PageGuard &operator=(PageGuard &&other) noexcept {
+    if (this != &other) {
+      Release();
+      bpm_ = other.bpm_;
+      page_ = other.page_;
+      other.page_ = nullptr;
+    }
+    return *this;
+  }
+
+  PageGuard(const PageGuard &) = delete;
+  PageGuard &operator=(const PageGuard &) = delete;
+
+  ~PageGuard() { Release(); }
+
+  /** @return true if the guard holds a page, false if it is empty or the page could not be fetched */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the guarded page, or nullptr */
+  Page *GetPage() const { return page_; }
+
+  /** Unpin the page, leaving the guard empty. */
+  void Release() {
+    if (page_ != nullptr) {
+      bpm_->UnpinPage(page_->GetPageId(), false);
+      page_ = nullptr;
+    }
+  }
+
+ private:
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+};
+
+/**
+ * ReadPageGuard keeps a page pinned and read latched for as long as it lives, so that pointers into the page stay
+ * valid and nobody modifies what they point to. The guard is movable but not copyable; the page is released when the
+ * guard is destroyed, assigned to or explicitly released.
+ *
+ * The page is latched for the whole lifetime of the guard, so the thread holding it must not try to write latch the
+ * same page (e.g. by updating a tuple of it) before releasing the guard.
+ */
+class ReadPageGuard {
+ public:
+  /** Create an empty guard that does not hold any page. */
+  ReadPageGuard() = default;
+
+  /**
+   * Fetch a page, pin it and read latch it.
+   * @param bpm the buffer pool manager to fetch the page from
+   * @param page_id id of the page to fetch
+   */
+  ReadPageGuard(BufferPoolManager *bpm, page_id_t page_id) : bpm_(bpm), page_(bpm->FetchPage(page_id)) {
+    if (page_ != nullptr) {
+      page_->RLatch();
+    }
+  }
+
+  ReadPageGuard(ReadPageGuard &&other) noexcept : bpm_(other.bpm_), page_(other.page_) { other.page_ = nullptr; }
+
+  ReadPageGuard &operator=(ReadPageGuard &&other) noexcept {
+    if (this != &other) {
+      Release();
+      bpm_ = other.bpm_;
+      page_ = other.page_;
+      other.page_ = nullptr;
+    }
+    return *this;
+  }
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+
+  ~ReadPageGuard() { Release(); }
+
+  /** @return true if the guard holds a page, false if it is empty or the page could not be fetched */
+  bool IsValid() const { return page_ != nullptr; }
+
+  /** @return the guarded page, or nullptr */
+  Page *GetPage() const { return page_; }
+
+  /** Unlatch and unpin the page, leaving the guard empty. */
+  void Release() {
+    if (page_ != nullptr) {
+      page_->RUnlatch();
+      bpm_->UnpinPage(page_->GetPageId(), false);
+      page_ = nullptr;
+    }
+  }
+
+ private:
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+};
+
+}  // namespace bustub
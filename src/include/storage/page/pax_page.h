@@ -0,0 +1,315 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.h
+//
+// Identification: src/include/storage/page/pax_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/page/page.h"
+#include "storage/table/tuple.h"
+#include "type/limits.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * PAX (Partition Attributes Across) page format. The rows of a page are stored column by column: every column gets a
+ * minipage holding the values of that column for all rows of the page, so a scan that reads a few columns only touches
+ * those minipages. Fixed-length columns are dense arrays of values; a VARCHAR minipage is an array of offsets into a
+ * variable-length area that grows from the end of the page, like the tuples of a TablePage.
+ *
+ *  --------------------------------------------------------------------------------------------------
+ *  | HEADER | ROW STATES | MINIPAGE_1 | ... | MINIPAGE_n | ... FREE SPACE ... | ... VARCHAR DATA ... |
+ *  --------------------------------------------------------------------------------------------------
+ *                                                                            ^
+ *                                                                            free space pointer
+ *
+ *  Header format (size in bytes):
+ *  ----------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  ----------------------------------------------------------------------------
+ *  -------------------------------------------------------------------------------------------------
+ *  | TupleCount (4) | FsmPageId (4) | FsmSlot (4) | LayoutTag (4) | Capacity (4) | ColumnCount (4) |
+ *  -------------------------------------------------------------------------------------------------
+ *  ---------------------------------------------------------
+ *  | InlinedLength (4) | Column_1 (8) | ... | Column_n (8) |
+ *  ---------------------------------------------------------
+ *
+ *  FsmPageId and FsmSlot are where they are in a TablePage, so the first page of a table of either layout leads to
+ *  its free space map. LayoutTag is where a TablePage keeps its DictionaryOffset, and holds LAYOUT_TAG, which is
+ *  never a dictionary offset; that tells PAX pages from slotted pages, see IsPaxPage.
+ *
+ *  Every column entry records where the minipage of the column starts, and where and how the column is stored in a
+ *  Tuple; together with the length of the inlined part of a tuple this lets the page be read without the schema.
+ *  The null bitmaps of the tuples are stored in one more minipage behind the ones of the schema's columns.
+ *  The row states hold one byte per row.
+ *
+ *  The number of rows a page can hold is fixed when the page is initialized; it is computed from the schema assuming
+ *  VARCHAR_ESTIMATE bytes of data per VARCHAR value. Pages with longer strings fill up before all rows are used.
+ *  Rows are only ever appended: deleted rows are not reused, which keeps the minipages dense for scans.
+ */
+class PaxPage : public Page {
+ public:
+  /** Number of bytes reserved per VARCHAR value when sizing the minipages. */
+  static constexpr uint32_t VARCHAR_ESTIMATE = 32;
+
+  /**
+   * Initialize the PaxPage header and lay out the minipages for the given schema.
+   * @param page_id the page ID of this page
+   * @param prev_page_id the previous table page ID
+   * @param schema the schema of the rows stored in this page
+   * @param log_manager the log manager in use
+   * @param txn the transaction that this page is created in
+   */
+  void Init(page_id_t page_id, page_id_t prev_page_id, const Schema &schema, LogManager *log_manager,
+            Transaction *txn);
+
+  /** @return true if a page of a table is a PaxPage rather than a TablePage */
+  static bool IsPaxPage(Page *page) {
+    return *reinterpret_cast<uint32_t *>(page->GetData() + OFFSET_LAYOUT_TAG) == LAYOUT_TAG;
+  }
+
+  /** @return the page ID of this table page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the page ID of the previous table page */
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  /** @return the page ID of the next table page */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the previous page in the table. */
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the page ID of the free space map page that tracks this page */
+  page_id_t GetFsmPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FSM_PAGE_ID); }
+
+  /** Set where this page is tracked in the free space map. */
+  void SetFsmLocation(page_id_t fsm_page_id, uint32_t fsm_slot) {
+    memcpy(GetData() + OFFSET_FSM_PAGE_ID, &fsm_page_id, sizeof(page_id_t));
+    memcpy(GetData() + OFFSET_FSM_SLOT, &fsm_slot, sizeof(uint32_t));
+  }
+
+  /** @return the number of rows in this page, including deleted ones */
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  /** @return the number of rows this page can hold */
+  uint32_t GetCapacity() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_CAPACITY); }
+
+  /** @return the number of columns of the rows in this page */
+  uint32_t GetColumnCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMN_COUNT); }
+
+  /**
+   * @param schema the schema of a table
+   * @return the size of the largest tuple that fits into an empty page of that table
+   */
+  static uint32_t GetMaxTupleSize(const Schema &schema);
+
+  /**
+   * Append a tuple to the page.
+   * @param tuple tuple to insert
+   * @param[out] rid rid of the inserted tuple
+   * @param txn transaction performing the insert
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return true if the insert is successful (i.e. there is a free row and enough space for its VARCHAR values)
+   */
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /**
+   * Append as many tuples of a batch to the page as fit, in order, writing a single log record for all of them.
+   * @param tuples tuples to insert
+   * @param count number of tuples in the batch
+   * @param[out] rids rids of the inserted tuples, must have room for count entries
+   * @param txn transaction performing the insert
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return the number of tuples inserted, i.e. the length of the prefix of the batch that fit
+   */
+  uint32_t InsertTuples(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn, LockManager *lock_manager,
+                        LogManager *log_manager);
+
+  /**
+   * Mark a tuple as deleted. This does not actually delete the tuple.
+   * @param rid rid of the tuple to mark as deleted
+   * @param txn transaction performing the delete
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return true if marking the tuple as deleted is successful (i.e the tuple exists)
+   */
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /**
+   * PAX pages do not update rows in place, so the update always fails and the caller has to delete and re-insert.
+   * @return false
+   */
+  bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                   LockManager *lock_manager, LogManager *log_manager);
+
+  /** To be called on commit or abort. Actually perform the delete or rollback an insert. The row is not reused. */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+
+  /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
+  void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+
+  /**
+   * Read a tuple from a table, reassembling it from the minipages.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+
+  /**
+   * Read one column of a row straight from its minipage. The row must exist.
+   * @param slot_num the row to read
+   * @param column_idx the column to read
+   * @return the value of the column
+   */
+  Value GetValue(uint32_t slot_num, uint32_t column_idx);
+
+  /**
+   * Read one column of many rows straight from its minipage. The rows must exist.
+   * @param column_idx the column to read
+   * @param rids the rows to read
+   * @param[out] values the values of the column are appended here, in the order of rids
+   */
+  void GetValues(uint32_t column_idx, const std::vector<RID> &rids, std::vector<Value> *values);
+
+  /** @return true if the row at slot_num holds a tuple that is not deleted */
+  bool IsLive(uint32_t slot_num) { return slot_num < GetTupleCount() && GetRowState(slot_num) == ROW_LIVE; }
+
+  /**
+   * @param[out] first_rid the RID of the first tuple in this page
+   * @return true if the first tuple exists, false otherwise
+   */
+  bool GetFirstTupleRid(RID *first_rid);
+
+  /**
+   * @param cur_rid the RID of the current tuple
+   * @param[out] next_rid the RID of the tuple following the current tuple
+   * @return true if the next tuple exists, false otherwise
+   */
+  bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
+
+ private:
+  /** How a column is stored, both in this page and in a Tuple. */
+  struct PaxColumn {
+    /** Offset of the minipage of the column in the page. */
+    uint32_t minipage_offset_;
+    /** Offset of the column in a Tuple, see Column::GetOffset. */
+    uint16_t tuple_offset_;
+    /** Size of one minipage entry: the value itself, or the 4-byte offset of a VARCHAR value. */
+    uint8_t width_;
+    /** The TypeId of the column. */
+    uint8_t type_;
+  };
+  static_assert(sizeof(PaxColumn) == 8);
+
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_FREE_SPACE = 16;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
+  static constexpr size_t OFFSET_FSM_PAGE_ID = 24;
+  static constexpr size_t OFFSET_FSM_SLOT = 28;
+  static constexpr size_t OFFSET_LAYOUT_TAG = 32;
+  static constexpr size_t OFFSET_CAPACITY = 36;
+  static constexpr size_t OFFSET_COLUMN_COUNT = 40;
+  static constexpr size_t OFFSET_INLINED_LENGTH = 44;
+  static constexpr size_t OFFSET_COLUMNS = 48;
+  /** Marks PAX pages, never a valid TablePage dictionary offset. */
+  static constexpr uint32_t LAYOUT_TAG = UINT32_MAX;
+  static constexpr size_t MINIPAGE_ALIGNMENT = 8;
+
+  static constexpr uint8_t ROW_LIVE = 0;
+  static constexpr uint8_t ROW_DELETED = 1;
+  static constexpr uint8_t ROW_EMPTY = 2;
+
+  /**
+   * Compute the minipage layout of a page for the given schema.
+   * @param schema the schema of the rows
+   * @param[out] columns the column entries of the page, may be nullptr
+   * @param[out] capacity the number of rows of the page
+   * @return the end of the last minipage, where the free space starts in an empty page
+   */
+  static uint32_t ComputeLayout(const Schema &schema, std::vector<PaxColumn> *columns, uint32_t *capacity);
+
+  /**
+   * Copy a tuple into the minipages without logging or locking it.
+   * @param tuple tuple to insert
+   * @param[out] rid rid of the inserted tuple
+   * @return true if there was enough space
+   */
+  bool PlaceTuple(const Tuple &tuple, RID *rid);
+
+  /** @return the entry of column column_idx */
+  PaxColumn *GetColumn(uint32_t column_idx) {
+    return reinterpret_cast<PaxColumn *>(GetData() + OFFSET_COLUMNS) + column_idx;
+  }
+
+  /** @return the offset of the row states, right after the column entries */
+  size_t GetRowStatesOffset() { return OFFSET_COLUMNS + sizeof(PaxColumn) * GetColumnCount(); }
+
+  /** @return the state of the row at slot_num */
+  uint8_t GetRowState(uint32_t slot_num) {
+    return *reinterpret_cast<uint8_t *>(GetData() + GetRowStatesOffset() + slot_num);
+  }
+
+  /** Set the state of the row at slot_num. */
+  void SetRowState(uint32_t slot_num, uint8_t state) {
+    *reinterpret_cast<uint8_t *>(GetData() + GetRowStatesOffset() + slot_num) = state;
+  }
+
+  /** @return the length of the inlined part of the tuples, see Schema::GetLength */
+  uint32_t GetInlinedLength() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_INLINED_LENGTH); }
+
+  /** @return the end of the minipages, i.e. the start of the free space */
+  uint32_t GetMinipagesEnd();
+
+  /** Copy the row at slot_num into tuple, reassembling it from the minipages. */
+  void CopyTuple(uint32_t slot_num, Tuple *tuple);
+
+  /** @return pointer to the end of the current free space, see header comment */
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  /** Sets the pointer, this should be the end of the current free space. */
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+
+  /** Set the number of rows in this page. */
+  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+
+  /** @return the size of the serialized VARCHAR value at data, including its length field */
+  static uint32_t GetVarlenSize(const char *data) {
+    uint32_t len = *reinterpret_cast<const uint32_t *>(data);
+    return sizeof(uint32_t) + (len == BUSTUB_VALUE_NULL ? 0 : len);
+  }
+};
+
+}  // namespace bustub
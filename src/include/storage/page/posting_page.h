@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_page.h
+//
+// Identification: src/include/storage/page/posting_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * A posting page holds a range of the RIDs of a posting list, see PostingList. The pages of a posting list are a
+ * singly-linked list in ascending RID order.
+ *
+ * Posting page format (sizes in bytes):
+ *  -------------------------------------------------------------------------------------------------
+ *  | PageId (4) | LSN (4) | NextPageId (4) | LastPageId (4) | Count (4) | DataSize (4) | ... DATA ... |
+ *  -------------------------------------------------------------------------------------------------
+ * LastPageId is the last page of the list, only maintained in its first page. DATA holds Count RIDs, encoded by
+ * PostingList.
+ */
+class PostingPage : public Page {
+ public:
+  /** Number of bytes of encoded RIDs one posting page holds. */
+  static constexpr uint32_t CAPACITY = PAGE_SIZE - 24;
+
+  /**
+   * Initialize the posting page header.
+   * @param page_id the page ID of this posting page
+   */
+  void Init(page_id_t page_id) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetNextPageId(INVALID_PAGE_ID);
+    SetLastPageId(page_id);
+    SetCount(0);
+    SetDataSize(0);
+  }
+
+  /** @return the page ID of the next posting page of the list */
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  /** Set the page id of the next posting page of the list. */
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the page ID of the last posting page of the list, if this is its first page */
+  page_id_t GetLastPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_LAST_PAGE_ID); }
+
+  /** Set the page id of the last posting page of the list, in its first page. */
+  void SetLastPageId(page_id_t last_page_id) {
+    memcpy(GetData() + OFFSET_LAST_PAGE_ID, &last_page_id, sizeof(page_id_t));
+  }
+
+  /** @return the number of RIDs stored in this page */
+  uint32_t GetCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COUNT); }
+
+  /** Set the number of RIDs stored in this page. */
+  void SetCount(uint32_t count) { memcpy(GetData() + OFFSET_COUNT, &count, sizeof(uint32_t)); }
+
+  /** @return the number of bytes of encoded RIDs stored in this page */
+  uint32_t GetDataSize() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DATA_SIZE); }
+
+  /** Set the number of bytes of encoded RIDs stored in this page. */
+  void SetDataSize(uint32_t data_size) { memcpy(GetData() + OFFSET_DATA_SIZE, &data_size, sizeof(uint32_t)); }
+
+  /** @return the encoded RIDs stored in this page */
+  char *GetEncodedRids() { return GetData() + OFFSET_ENCODED_RIDS; }
+
+ private:
+  static_assert(sizeof(page_id_t) == 4);
+
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 8;
+  static constexpr size_t OFFSET_LAST_PAGE_ID = 12;
+  static constexpr size_t OFFSET_COUNT = 16;
+  static constexpr size_t OFFSET_DATA_SIZE = 20;
+  static constexpr size_t OFFSET_ENCODED_RIDS = 24;
+};
+
+}  // namespace bustub
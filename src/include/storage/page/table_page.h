@@ -13,12 +13,14 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
 
 #include "common/rid.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/page.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
 
 static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
 
@@ -36,10 +38,44 @@ namespace bustub {
  *  ----------------------------------------------------------------------------
  *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ------------------------------------------------------------------------
+ *  | TupleCount (4) | FsmPageId (4) | FsmSlot (4) | DictionaryOffset (4) |
+ *  ------------------------------------------------------------------------
+ *  ---------------------------------------------
+ *  | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------
  *
+ *  FsmPageId and FsmSlot locate the entry of this page in the table's free space map (see FreeSpaceMapPage).
+ *  The entry of the first page of a table is the first entry of the map, so the first page also leads to the map.
+ *  Tables without a free space map have INVALID_PAGE_ID there.
+ *
+ *  A page may dictionary-encode the VARCHAR values of its tuples (see InitDictionary). Every distinct string is then
+ *  stored once, as a dictionary entry in a slot of its own, and tuples refer to it by its slot number, the code.
+ *  Tuples are stored with the length of an encoded value replaced by DICTIONARY_REFERENCE | code, and are decoded
+ *  back into the usual format when read. Equal codes mean equal strings, so equality predicates can be evaluated on
+ *  the codes (see FindEqual). Values stored out of line, NULLs and strings that do not fit into the dictionary are
+ *  stored as they are.
+ *
+ *  Dictionary entry format:
+ *  -------------------------------------
+ *  | RefCount (4) | Length (4) | DATA |
+ *  -------------------------------------
+ *
+ *  The list of encoded columns is kept at DictionaryOffset, at the end of the page, so that the page can be read
+ *  without the schema. DictionaryOffset is 0 on pages without a dictionary.
+ *  ----------------------------------------------------------------------------------------------
+ *  | InlinedLength (4) | EntryCount (4) | ColumnCount (4) | Column_1 offset (4) | ... |
+ *  ----------------------------------------------------------------------------------------------
+ *  InlinedLength is the length of the fixed-size part of a tuple, the column offsets are the offsets of the VARCHAR
+ *  columns in a tuple.
+ *
+ *  A tuple that no longer fits into its page after an update is moved to another page, and its slot becomes a
+ *  forwarding stub holding the RID of the new location, so that the RID of the tuple stays the same. The slot of the
+ *  moved tuple is flagged with MOVED_MASK and is skipped by scans, which reach the tuple through its stub instead.
+ *  Stubs always point at the moved tuple itself, never at another stub.
+ *  ---------------------------------
+ *  | PageId (4) | SlotNum (4) |
+ *  ---------------------------------
  */
 class TablePage : public Page {
  public:
@@ -53,6 +89,21 @@ class TablePage : public Page {
    */
   void Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager, Transaction *txn);
 
+  /**
+   * Dictionary-encode the VARCHAR values of the tuples of this page. Must be called right after Init.
+   * @param inlined_length the length of the fixed-size part of a tuple, see Schema::GetLength
+   * @param column_offsets the offsets of the VARCHAR columns in a tuple, in column order
+   */
+  void InitDictionary(uint32_t inlined_length, const std::vector<uint32_t> &column_offsets);
+
+  /** @return true if the page dictionary-encodes its VARCHAR values */
+  bool HasDictionary() { return GetDictionaryOffset() != 0; }
+
+  /** @return the number of distinct strings in the dictionary of this page */
+  uint32_t GetDictionaryEntryCount() {
+    return *reinterpret_cast<uint32_t *>(GetData() + GetDictionaryOffset() + OFFSET_DICTIONARY_ENTRY_COUNT);
+  }
+
   /** @return the page ID of this table page */
   page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
 
@@ -72,6 +123,34 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the page ID of the free space map page that tracks this page */
+  page_id_t GetFsmPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_FSM_PAGE_ID); }
+
+  /** @return the slot of this page in its free space map page */
+  uint32_t GetFsmSlot() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FSM_SLOT); }
+
+  /** Set where this page is tracked in the free space map. */
+  void SetFsmLocation(page_id_t fsm_page_id, uint32_t fsm_slot) {
+    memcpy(GetData() + OFFSET_FSM_PAGE_ID, &fsm_page_id, sizeof(page_id_t));
+    memcpy(GetData() + OFFSET_FSM_SLOT, &fsm_slot, sizeof(uint32_t));
+  }
+
+  /** @return the number of bytes left for new tuples and their slots */
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return the number of bytes a tuple of the given size consumes on a page, including its slot */
+  static constexpr uint32_t GetRequiredSpace(uint32_t tuple_size) { return tuple_size + SIZE_TUPLE; }
+
+  /** @return the number of bytes the list of dictionary-encoded columns takes from a page */
+  static constexpr uint32_t GetDictionarySize(uint32_t column_count) {
+    return OFFSET_DICTIONARY_COLUMNS + sizeof(uint32_t) * column_count;
+  }
+
+  /** @return the size of the largest tuple that fits into an empty page */
+  static constexpr uint32_t GetMaxTupleSize() { return PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE; }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -83,6 +162,19 @@ class TablePage : public Page {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Insert as many tuples of a batch into the page as fit, in order, writing a single log record for all of them.
+   * @param tuples tuples to insert
+   * @param count number of tuples in the batch
+   * @param[out] rids rids of the inserted tuples, must have room for count entries
+   * @param txn transaction performing the insert
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return the number of tuples inserted, i.e. the length of the prefix of the batch that fit
+   */
+  uint32_t InsertTuples(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn, LockManager *lock_manager,
+                        LogManager *log_manager);
+
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
@@ -94,9 +186,9 @@ class TablePage : public Page {
   bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
   /**
-   * Update a tuple.
+   * Update a tuple. A tuple that was moved to another page is moved back into this page, replacing its stub.
    * @param new_tuple new value of the tuple
-   * @param[out] old_tuple old value of the tuple
+   * @param[out] old_tuple old value of the tuple, empty if the tuple was moved to another page
    * @param rid rid of the tuple
    * @param txn transaction performing the update
    * @param lock_manager the lock manager
@@ -106,8 +198,59 @@ class TablePage : public Page {
   bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                    LockManager *lock_manager, LogManager *log_manager);
 
-  /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  /**
+   * Replace a tuple with a forwarding stub, once its new value has been stored at another page by InsertMovedTuple.
+   * The stub of a tuple that was already moved is pointed at the new location instead.
+   * @param rid rid of the tuple
+   * @param new_rid where the new value of the tuple is stored
+   * @param[out] old_tuple old value of the tuple, empty if the tuple was already moved to another page
+   * @param txn transaction performing the update
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return true if there was room for the stub and the tuple exists
+   */
+  bool ForwardTuple(const RID &rid, const RID &new_rid, Tuple *old_tuple, Transaction *txn, LockManager *lock_manager,
+                    LogManager *log_manager);
+
+  /**
+   * @param rid rid of a tuple of this page
+   * @param[out] forward_rid where the tuple is stored now
+   * @return true if the tuple was moved to another page by an update, even if it is marked deleted
+   */
+  bool GetForwardRid(const RID &rid, RID *forward_rid);
+
+  /**
+   * Store a tuple that was moved out of its page by an update, see ForwardTuple. The moved tuple is neither locked nor
+   * logged, it is only ever reached through the stub at its original RID.
+   * @param tuple the new value of the tuple
+   * @param[out] rid where the tuple is stored
+   * @return true if there was enough space
+   */
+  bool InsertMovedTuple(const Tuple &tuple, RID *rid);
+
+  /**
+   * Read a tuple moved into this page. Takes no lock, the caller locks the RID of its stub.
+   * @param rid where the tuple is stored
+   * @param[out] tuple the tuple, its RID is left to the caller
+   * @return true if there is a moved tuple at rid
+   */
+  bool GetMovedTuple(const RID &rid, Tuple *tuple);
+
+  /**
+   * Remove a tuple moved into this page, once its stub points elsewhere or is deleted.
+   * @param rid where the tuple is stored
+   * @param[out] removed_tuple if not nullptr, the tuple that was removed
+   */
+  void RemoveMovedTuple(const RID &rid, Tuple *removed_tuple = nullptr);
+
+  /**
+   * To be called on commit or abort. Actually perform the delete or rollback an insert.
+   * @param rid rid of the tuple to delete
+   * @param txn transaction performing the delete
+   * @param log_manager the log manager
+   * @param[out] deleted_tuple if not nullptr, the tuple that was removed from the page
+   */
+  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple = nullptr);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
   void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
@@ -118,13 +261,41 @@ class TablePage : public Page {
    * @param[out] tuple the tuple that was read
    * @param txn transaction performing the read
    * @param lock_manager the lock manager
+   * @param[out] forward_rid if not nullptr, where the tuple is stored now if it was moved to another page by an update,
+   * in which case the tuple is left to be read from there; an invalid RID otherwise
    * @return true if the read is successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                RID *forward_rid = nullptr);
 
-  /** @return the rid of the first tuple in this page */
+  /**
+   * Read a tuple from a table without copying it out of the page. On a page with a dictionary the view is of the
+   * encoded tuple, use GetTuple to read it in the usual format. Fails for tuples moved to another page.
+   * @param rid rid of the tuple to read
+   * @param[out] view view of the tuple data, valid while the page stays pinned and latched
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  bool GetTupleView(const RID &rid, TupleView *view, Transaction *txn, LockManager *lock_manager);
+
+  /**
+   * Find the tuples of this page whose VARCHAR value equals a string. Dictionary-encoded values are matched by their
+   * code, so the string is only compared once, against the dictionary. The matching tuples are shared locked.
+   * @param column_offset the offset of the VARCHAR column in a tuple, see Column::GetOffset
+   * @param data the string
+   * @param len the length of the string as serialized, see Value::GetLength
+   * @param[out] rids the rids of the matching tuples are appended here
+   * @param[out] external_rids the rids of the tuples whose value is stored out of line and has the same length, and of
+   * the tuples moved to other pages, are appended here, the caller has to compare their values
+   * @param txn transaction performing the read
+   * @param lock_manager the lock manager
+   */
+  void FindEqual(uint32_t column_offset, const char *data, uint32_t len, std::vector<RID> *rids,
+                 std::vector<RID> *external_rids, Transaction *txn, LockManager *lock_manager);
 
   /**
+   * Stubs of moved tuples count as tuples of this page, the moved tuples themselves do not.
    * @param[out] first_rid the RID of the first tuple in this page
    * @return true if the first tuple exists, false otherwise
    */
@@ -140,14 +311,133 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 36;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_FSM_PAGE_ID = 24;
+  static constexpr size_t OFFSET_FSM_SLOT = 28;
+  static constexpr size_t OFFSET_DICTIONARY = 32;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 36;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 40;
+
+  static constexpr size_t OFFSET_DICTIONARY_INLINED_LENGTH = 0;
+  static constexpr size_t OFFSET_DICTIONARY_ENTRY_COUNT = 4;
+  static constexpr size_t OFFSET_DICTIONARY_COLUMN_COUNT = 8;
+  static constexpr size_t OFFSET_DICTIONARY_COLUMNS = 12;
+  static constexpr size_t SIZE_DICTIONARY_ENTRY_HEADER = 8;
+  static constexpr uint32_t SIZE_FORWARDING_STUB = 8;
+
+  /** Set in the size of the slot of a dictionary entry. */
+  static constexpr uint32_t DICTIONARY_ENTRY_MASK = 1U << 30;
+  /** Set in the length of a VARCHAR value that refers to a dictionary entry, the rest is the code. */
+  static constexpr uint32_t DICTIONARY_REFERENCE = 1U << 30;
+  /** Most dictionary entries a page holds, this bounds the cost of looking up a string. */
+  static constexpr uint32_t DICTIONARY_CAPACITY = 64;
+  /** Code of a value that is not in the dictionary. */
+  static constexpr uint32_t NO_CODE = UINT32_MAX;
+  /** Set in the size of the slot of a forwarding stub. */
+  static constexpr uint32_t FORWARD_MASK = 1U << 29;
+  /** Set in the size of the slot of a tuple moved into this page by an update. */
+  static constexpr uint32_t MOVED_MASK = 1U << 28;
+  /** The bits of the size of a slot that hold the number of bytes it takes. */
+  static constexpr uint32_t SIZE_MASK = MOVED_MASK - 1;
+
+  /**
+   * Copy a tuple into the page without logging or locking it.
+   * @param tuple tuple to insert
+   * @param[in,out] slot_hint the first slot that may be empty; advanced past the slot that was used
+   * @param[out] rid rid of the inserted tuple
+   * @return true if there was enough space
+   */
+  bool PlaceTuple(const Tuple &tuple, uint32_t *slot_hint, RID *rid);
+
+  /**
+   * Copy data into a slot of the page.
+   * @param data the data
+   * @param size the size of the data
+   * @param slot_size what to record as the size of the slot
+   * @param[in,out] slot_hint the first slot that may be empty; advanced past the slot that was used
+   * @return the slot, or GetTupleCount() if there was not enough space
+   */
+  uint32_t PlaceData(const char *data, uint32_t size, uint32_t slot_size, uint32_t *slot_hint);
+
+  /** Remove the data of a slot from the page and mark the slot empty. */
+  void RemoveData(uint32_t slot_num, uint32_t size);
+
+  /**
+   * Check that a tuple can be read and take at least a shared lock on it.
+   * @return true if the tuple exists and was locked
+   */
+  bool CheckTuple(const RID &rid, Transaction *txn, LockManager *lock_manager);
+
+  /** Give the empty slots at the end of the slot array back to the free space. */
+  void TrimSlots();
+
+  /**
+   * Replace the data of a tuple's slot, which may be a forwarding stub, logging it as an update of the tuple.
+   * @param data the new data of the slot
+   * @param size the size of the new data
+   * @param slot_size what to record as the size of the slot
+   * @param logged_tuple the new value of the tuple for the log record
+   * @param[out] old_tuple old value of the tuple, empty if the slot held a stub
+   * @param rid rid of the tuple
+   * @param txn transaction performing the update
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @return true if there was room for the new data and the tuple exists
+   */
+  bool ReplaceData(const char *data, uint32_t size, uint32_t slot_size, const Tuple &logged_tuple, Tuple *old_tuple,
+                   const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /** @return the offset of the dictionary column list, 0 if the page has no dictionary */
+  uint32_t GetDictionaryOffset() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_DICTIONARY); }
+
+  /** @return the field of the dictionary column list at the given offset */
+  uint32_t GetDictionaryField(size_t offset) {
+    return *reinterpret_cast<uint32_t *>(GetData() + GetDictionaryOffset() + offset);
+  }
+
+  /** Set the number of dictionary entries. */
+  void SetDictionaryEntryCount(uint32_t entry_count) {
+    memcpy(GetData() + GetDictionaryOffset() + OFFSET_DICTIONARY_ENTRY_COUNT, &entry_count, sizeof(uint32_t));
+  }
+
+  /** @return the code of the dictionary entry of a string, NO_CODE if there is none */
+  uint32_t FindEntry(const char *data, uint32_t len);
+
+  /** @return the code of a new dictionary entry for a string, NO_CODE if there was not enough space */
+  uint32_t AddEntry(const char *data, uint32_t len);
+
+  /** @return pointer to the reference count of a dictionary entry, followed by the serialized string */
+  char *GetEntry(uint32_t code) { return GetData() + GetTupleOffsetAtSlot(code); }
+
+  /**
+   * Dictionary-encode a tuple, adding an entry for every string not yet in the dictionary if add_entries is set and
+   * there is room for the new entries and the tuple. Takes a reference to every entry the encoded tuple refers to.
+   * @param tuple the tuple in the usual format
+   * @param add_entries whether strings may be added to the dictionary
+   * @param[out] encoded the encoded tuple
+   * @return false if add_entries is set and there might not be room for the new entries and the tuple
+   */
+  bool EncodeTuple(const Tuple &tuple, bool add_entries, Tuple *encoded);
+
+  /**
+   * Decode a tuple stored in this page.
+   * @param data the stored tuple
+   * @param size the size of the stored tuple
+   * @param rid the rid of the tuple
+   * @param[out] tuple the tuple in the usual format
+   */
+  void DecodeTuple(const char *data, uint32_t size, const RID &rid, Tuple *tuple);
+
+  /**
+   * Drop the references a stored tuple holds, removing the entries nothing refers to anymore.
+   * @param data a copy of the stored tuple, not the tuple in the page: removing entries moves the page data
+   */
+  void ReleaseReferences(const char *data);
 
   /** @return pointer to the end of the current free space, see header comment */
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
@@ -166,10 +456,6 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   /** @return tuple offset at slot slot_num */
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -190,8 +476,24 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
   }
 
-  /** @return true if the tuple is deleted or empty */
-  static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
+  /** @return true if the slot is empty, deleted, not a tuple at all, or a tuple only reached through its stub */
+  static bool IsDeleted(uint32_t tuple_size) {
+    return static_cast<bool>(tuple_size & (DELETE_MASK | DICTIONARY_ENTRY_MASK | MOVED_MASK)) || tuple_size == 0;
+  }
+
+  /** @return true if the slot holds a forwarding stub */
+  static bool IsForwardingStub(uint32_t slot_size) { return (slot_size & FORWARD_MASK) != 0; }
+
+  /** @return true if the slot holds a tuple moved into this page */
+  static bool IsMovedTuple(uint32_t slot_size) { return (slot_size & MOVED_MASK) != 0; }
+
+  /** @return true if the slot holds a dictionary entry */
+  static bool IsDictionaryEntry(uint32_t slot_size) { return (slot_size & DICTIONARY_ENTRY_MASK) != 0; }
+
+  /** @return true if a stored VARCHAR length refers to a dictionary entry */
+  static bool IsReference(uint32_t len) {
+    return len != BUSTUB_VALUE_NULL && (len & ~(DICTIONARY_REFERENCE - 1)) == DICTIONARY_REFERENCE;
+  }
 
   /** @return tuple size with the deleted flag set */
   static uint32_t SetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size | DELETE_MASK); }
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_iterator.h
+//
+// Identification: src/include/storage/table/column_iterator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+class TableHeap;
+class TablePage;
+class PaxPage;
+
+/**
+ * ColumnIterator scans some of the columns of a TableHeap. It reads one page at a time: the requested columns of all
+ * tuples of the page are copied out under a single latch acquisition, column by column, so that on PAX pages every
+ * requested minipage is read sequentially and the other minipages are not touched at all.
+ */
+class ColumnIterator {
+ public:
+  /**
+   * Create an iterator positioned before the first tuple of the table.
+   * @param table_heap the table to scan
+   * @param schema the schema of the tuples of the table
+   * @param column_ids the columns to produce, in order
+   * @param txn the transaction performing the scan
+   */
+  ColumnIterator(TableHeap *table_heap, const Schema *schema, std::vector<uint32_t> column_ids, Transaction *txn);
+
+  /**
+   * Produce the requested columns of the next tuple.
+   * @param[out] values the values of the requested columns
+   * @param[out] rid the rid of the tuple
+   * @return false if the scan is over
+   */
+  bool Next(std::vector<Value> *values, RID *rid);
+
+  /**
+   * Produce the requested columns of all remaining tuples of the next page that has any, without copying them.
+   * Must not be mixed with Next.
+   * @param[out] columns the values of the tuples, one vector per requested column
+   * @param[out] rids the rids of the tuples
+   * @return false if the scan is over
+   */
+  bool NextBatch(std::vector<std::vector<Value>> *columns, std::vector<RID> *rids);
+
+ private:
+  /** Copy the requested columns of all tuples of the next page into the buffer. */
+  void LoadPage();
+
+  /** Copy the requested columns out of the tuples of a slotted page. */
+  void LoadTuples(TablePage *page);
+
+  /** Copy the requested columns out of the minipages of a PAX page. */
+  void LoadTuples(PaxPage *page);
+
+  /** Copy the requested columns of a tuple into the buffer. */
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+
+  TableHeap *table_heap_;
+  const Schema *schema_;
+  std::vector<uint32_t> column_ids_;
+  Transaction *txn_;
+  page_id_t next_page_id_;
+  /** The rids of the tuples of the current page. */
+  std::vector<RID> rids_;
+  /** The values of the current page, one vector per requested column. */
+  std::vector<std::vector<Value>> columns_;
+  /** The position of the next tuple in rids_ and columns_. */
+  size_t position_{0};
+  /** The tuples of the current page that were moved to other pages by updates. */
+  std::vector<RID> forwarded_rids_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/free_space_map_page.h"
+#include "storage/page/table_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks how much free space every page of a table heap has, so that inserts can go straight to a page
+ * with room instead of walking the page chain. It is a hint: the categories are conservative, but callers must still
+ * handle a page turning out to be full and call Update to correct its entry.
+ *
+ * Latching: a table page latch may be held while latching free space map pages, never the other way around.
+ * The map itself is not logged; after a crash it may under-report free space, which only costs space.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * Create a new, empty free space map.
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit FreeSpaceMap(BufferPoolManager *buffer_pool_manager);
+
+  /**
+   * Open an existing free space map.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param root_page_id the id of the first free space map page
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id);
+
+  /** @return the id of the first free space map page */
+  page_id_t GetRootPageId() const { return root_page_id_; }
+
+  /**
+   * Start tracking a new table page, which becomes the last page of the map. Records the location of its entry in
+   * the table page header. Calls must be serialized by the caller.
+   * @param table_page the new table page, write latched by the caller
+   * @return false if the map could not grow
+   */
+  bool AddPage(TablePage *table_page);
+
+  /**
+   * Start tracking a new table page, which becomes the last page of the map. Calls must be serialized by the caller.
+   * @param table_page_id the new table page
+   * @param free_space the free space of the table page
+   * @param[out] map_page_id if not nullptr, the free space map page holding the entry of the table page
+   * @param[out] slot_num if not nullptr, the slot of the entry in that page
+   * @return false if the map could not grow
+   */
+  bool AddPage(page_id_t table_page_id, uint32_t free_space, page_id_t *map_page_id, uint32_t *slot_num);
+
+  /**
+   * Refresh the entry of a table page after its free space changed.
+   * @param table_page the table page, latched by the caller
+   */
+  void Update(TablePage *table_page);
+
+  /**
+   * @param required_space the number of bytes needed on the page
+   * @return a table page that had at least required_space bytes free when last updated, INVALID_PAGE_ID if none
+   */
+  page_id_t FindPage(uint32_t required_space);
+
+  /** @return the most recently added table page */
+  page_id_t GetLastPageId() const { return last_table_page_id_; }
+
+  /**
+   * Take a snapshot of the map pages, through which the table pages can be addressed by their position in the map:
+   * every map page but the last is full, so the table page at position i has its entry in slot i % CAPACITY of map
+   * page i / CAPACITY, CAPACITY being FreeSpaceMapPage::CAPACITY.
+   * @param[out] map_page_ids the ids of the map pages, in order
+   * @return the number of table pages tracked by those map pages
+   */
+  uint32_t GetMapPageIds(std::vector<page_id_t> *map_page_ids);
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  page_id_t root_page_id_{INVALID_PAGE_ID};
+  /** The free space map page new entries are appended to. Only changed by AddPage. */
+  page_id_t last_map_page_id_{INVALID_PAGE_ID};
+  std::atomic<page_id_t> last_table_page_id_{INVALID_PAGE_ID};
+  /** Protects map_page_ids_ and table_page_count_, which AddPage changes while others take snapshots. */
+  std::mutex latch_;
+  /** The ids of all map pages, in order. */
+  std::vector<page_id_t> map_page_ids_;
+  uint32_t table_page_count_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_store.h
+//
+// Identification: src/include/storage/table/overflow_store.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstring>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/overflow_page.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+/**
+ * OverflowStore keeps VARCHAR values that are too large for their tuple out of line, in chains of overflow pages.
+ *
+ * A tuple refers to an external value with an external pointer in place of the serialized value:
+ *  ---------------------------------------------------------------
+ *  | Length with EXTERNAL_FLAG set (4) | FirstOverflowPageId (4) |
+ *  ---------------------------------------------------------------
+ * The flag cannot be part of a real length, and the NULL length has all bits set, so external pointers can be told
+ * apart from inline values by the length alone.
+ *
+ * Overflow pages are not logged.
+ */
+class OverflowStore {
+ public:
+  /** Set in the length of an external pointer. */
+  static constexpr uint32_t EXTERNAL_FLAG = 1U << 31;
+  /** Number of bytes of an external pointer. */
+  static constexpr uint32_t EXTERNAL_POINTER_SIZE = sizeof(uint32_t) + sizeof(page_id_t);
+
+  /**
+   * Create an overflow store.
+   * @param buffer_pool_manager the buffer pool manager
+   */
+  explicit OverflowStore(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {}
+
+  /**
+   * Write a value into a new chain of overflow pages.
+   * @param data the value
+   * @param size the number of bytes of the value
+   * @param[out] first_page_id the first page of the chain
+   * @return false if the pages could not be allocated, in which case nothing is left behind
+   */
+  bool Write(const char *data, uint32_t size, page_id_t *first_page_id);
+
+  /**
+   * Read a value back from its chain of overflow pages.
+   * @param first_page_id the first page of the chain
+   * @param size the number of bytes of the value
+   * @param[out] out where to copy the value, must have room for size bytes
+   * @return false if a page of the chain could not be fetched
+   */
+  bool Read(page_id_t first_page_id, uint32_t size, char *out);
+
+  /**
+   * Delete the pages of a chain.
+   * @param first_page_id the first page of the chain
+   */
+  void Free(page_id_t first_page_id);
+
+  /** @return true if the serialized VARCHAR at varlen is an external pointer */
+  static bool IsExternal(const char *varlen) {
+    uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+    return len != BUSTUB_VALUE_NULL && (len & EXTERNAL_FLAG) != 0;
+  }
+
+  /** @return the length of the value an external pointer refers to */
+  static uint32_t GetExternalLength(const char *varlen) {
+    return *reinterpret_cast<const uint32_t *>(varlen) & ~EXTERNAL_FLAG;
+  }
+
+  /** @return the first overflow page of the value an external pointer refers to */
+  static page_id_t GetExternalPageId(const char *varlen) {
+    return *reinterpret_cast<const page_id_t *>(varlen + sizeof(uint32_t));
+  }
+
+  /** Serialize an external pointer to storage. */
+  static void SetExternal(char *storage, uint32_t len, page_id_t first_page_id) {
+    uint32_t flagged = len | EXTERNAL_FLAG;
+    memcpy(storage, &flagged, sizeof(uint32_t));
+    memcpy(storage + sizeof(uint32_t), &first_page_id, sizeof(page_id_t));
+  }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_scan.h
+//
+// Identification: src/include/storage/table/parallel_scan.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "storage/table/tuple_view_iterator.h"
+
+namespace bustub {
+
+class TableHeap;
+
+/**
+ * ParallelScan splits a scan of a TableHeap among worker threads. The table pages are numbered by their position in
+ * the free space map, and workers claim morsels of consecutive page numbers through a shared atomic cursor, so that
+ * workers that get through their pages faster take on more of the table. Page numbers are turned into page ids by
+ * reading the map pages, each of which lists the ids of many table pages, so no worker walks the page chain.
+ *
+ * The scan covers the pages the table had when the scan was created. Every page is claimed by exactly one worker,
+ * so every tuple is produced once; a tuple moved to another page by an update is produced by the worker that scans
+ * its original page.
+ */
+class ParallelScan {
+ public:
+  /** Upper bound on the number of pages of a morsel. */
+  static constexpr uint32_t MAX_MORSEL_SIZE = 64;
+  /** Morsels are made small enough for every worker to claim about this many of them, to balance the load. */
+  static constexpr uint32_t MORSELS_PER_WORKER = 16;
+
+  /**
+   * Create a parallel scan over the current pages of a table.
+   * @param table_heap the table to scan
+   * @param worker_count the number of workers the scan is meant to be split among, used to size the morsels
+   */
+  ParallelScan(TableHeap *table_heap, uint32_t worker_count);
+
+  /**
+   * Create the iterator of one worker, which produces the tuples of the morsels it claims. Every worker needs its
+   * own iterator, and any number of them may be created.
+   * @param txn the transaction the worker performs the scan for
+   * @return an iterator producing a view of the tuples of the claimed pages, see TupleViewIterator
+   */
+  TupleViewIterator CreateWorker(Transaction *txn);
+
+  /**
+   * Claim the next morsel of pages.
+   * @param[out] page_ids the ids of the pages of the morsel
+   * @return false if every page has already been claimed
+   */
+  bool NextMorsel(std::vector<page_id_t> *page_ids);
+
+  /** @return the number of pages the scan covers */
+  uint32_t GetPageCount() const { return page_count_; }
+
+  /** @return the number of pages of a morsel */
+  uint32_t GetMorselSize() const { return morsel_size_; }
+
+ private:
+  TableHeap *table_heap_;
+  BufferPoolManager *buffer_pool_manager_;
+  /** The free space map pages, the table page with number i has its entry in page i / FreeSpaceMapPage::CAPACITY. */
+  std::vector<page_id_t> map_page_ids_;
+  uint32_t page_count_;
+  uint32_t morsel_size_;
+  /** Number of the first page of the next morsel to be claimed. */
+  std::atomic<uint32_t> cursor_{0};
+};
+
+}  // namespace bustub
@@ -12,26 +12,57 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
 #include "recovery/log_manager.h"
+#include "storage/page/pax_page.h"
 #include "storage/page/table_page.h"
+#include "storage/table/column_iterator.h"
+#include "storage/table/free_space_map.h"
+#include "storage/table/overflow_store.h"
+#include "storage/table/parallel_scan.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_view_iterator.h"
 
 namespace bustub {
 
+/** How the tuples of a table are laid out in its pages. */
+enum class TableLayout {
+  /** Slotted pages of row-major tuples, see TablePage. */
+  ROW,
+  /** Column minipages, see PaxPage. Tuples are appended to the last page and are never updated in place. */
+  PAX,
+};
+
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages, plus a free space map that tells inserts which pages have room.
+ *
+ * Row tables created with a schema store large VARCHAR values out of line: a tuple larger than TOAST_THRESHOLD has
+ * its largest VARCHAR values moved into chains of overflow pages (see OverflowStore) until it is small enough, and
+ * keeps external pointers to them. Tuples are returned with the pointers in place, so reading a tuple never touches
+ * the overflow pages; use GetValue or Detoast to read the external values.
  */
 class TableHeap {
   friend class TableIterator;
+  friend class ColumnIterator;
+  friend class TupleViewIterator;
+  friend class ParallelScan;
 
  public:
+  /** Tuples larger than this have VARCHAR values moved out of line, if the table stores values out of line. */
+  static constexpr uint32_t TOAST_THRESHOLD = TablePage::GetMaxTupleSize() / 4;
+
   ~TableHeap() = default;
 
   /**
    * Create a table heap without a transaction. (open table)
+   * Only for tables created without a schema, which are made of slotted pages and store every value inline.
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
@@ -40,6 +71,18 @@ class TableHeap {
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
             page_id_t first_page_id);
 
+  /**
+   * Open a table created with a schema. The page layout is read from the first page, see PaxPage::IsPaxPage.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param first_page_id the id of the first page
+   * @param schema the schema the table was created with
+   * @param dictionary_encoding whether new slotted pages of the table dictionary-encode VARCHAR values
+   */
+  TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+            page_id_t first_page_id, const Schema &schema, bool dictionary_encoding = false);
+
   /**
    * Create a table heap with a transaction. (create table)
    * @param buffer_pool_manager the buffer pool manager
@@ -51,7 +94,22 @@ class TableHeap {
             Transaction *txn);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Create a table heap with the given page layout. (create table)
+   * @param buffer_pool_manager the buffer pool manager
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param txn the creating transaction
+   * @param schema the schema of the tuples of the table
+   * @param layout the page layout of the table
+   * @param dictionary_encoding whether the slotted pages of the table dictionary-encode VARCHAR values, see TablePage
+   */
+  TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+            Transaction *txn, const Schema &schema, TableLayout layout, bool dictionary_encoding = false);
+
+  /**
+   * Insert a tuple into the table. If the tuple is too large (>= page_size) even after moving its large values out of
+   * line, return false.
+   * The tuple goes to a page the free space map says has room, or to a new page appended to the table.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +117,17 @@ class TableHeap {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples into the table. Each page receives as many tuples as fit under one latch acquisition and
+   * one log record, so this is much cheaper than calling InsertTuple for every tuple.
+   * If a tuple is too large, nothing is inserted; if the table cannot grow, a prefix of the batch may be inserted.
+   * @param tuples tuples to insert
+   * @param[out] rids the rids of the inserted tuples are appended here, in the order of tuples
+   * @param txn the transaction performing the insert
+   * @return true iff all tuples were inserted
+   */
+  bool InsertTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -68,7 +137,9 @@ class TableHeap {
   bool MarkDelete(const RID &rid, Transaction *txn);  // for delete
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * Update a tuple, keeping its RID. If the new tuple does not fit into the page of the tuple, it is moved to another
+   * page and a forwarding stub takes its place, so indexes only need to change if their keys did. A tuple moved by an
+   * update moves back into its own page once it fits again.
    * @param tuple new tuple
    * @param rid rid of the old tuple
    * @param txn transaction performing the update
@@ -76,6 +147,21 @@ class TableHeap {
    */
   bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
+  /**
+   * Called on Commit to free the values stored out of line of the version of a tuple that an update replaced.
+   * @param old_tuple the replaced version, as saved in the write set of the update
+   */
+  void ApplyUpdate(const Tuple &old_tuple);
+
+  /**
+   * Called on Abort to rollback an update: put the replaced version of the tuple back, and free the values stored out
+   * of line of the version the update wrote.
+   * @param rid rid of the updated tuple
+   * @param old_tuple the replaced version, as saved in the write set of the update
+   * @param txn transaction performing the rollback
+   */
+  void RollbackUpdate(const RID &rid, const Tuple &old_tuple, Transaction *txn);
+
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
    * @param rid rid of the tuple to delete
@@ -99,20 +185,223 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read a column of a tuple of this table. Unlike Tuple::GetValue this also reads values stored out of line.
+   * @param tuple a tuple read from this table
+   * @param column_idx the column to read
+   * @param[out] value the value of the column
+   * @param txn transaction performing the read
+   * @return true if the read was successful (i.e. the overflow pages could be read)
+   */
+  bool GetValue(const Tuple &tuple, uint32_t column_idx, Value *value, Transaction *txn);
+
+  /**
+   * Replace the external pointers of a tuple with the values they refer to.
+   * @param[in,out] tuple a tuple read from this table
+   * @param txn transaction performing the read
+   * @return true if the read was successful (i.e. the overflow pages could be read)
+   */
+  bool Detoast(Tuple *tuple, Transaction *txn);
+
+  /**
+   * Find the tuples whose VARCHAR column equals a value. On pages with a dictionary the value is only compared
+   * against the dictionary, the tuples are matched by their dictionary codes.
+   * @param column_idx the VARCHAR column
+   * @param value the value to look for, NULL matches nothing
+   * @param[out] rids the rids of the matching tuples are appended here
+   * @param txn the transaction performing the scan
+   * @return true if the scan was successful (i.e. all the pages could be read)
+   */
+  bool ScanEquals(uint32_t column_idx, const Value &value, std::vector<RID> *rids, Transaction *txn);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
   /** @return the end iterator of this table */
   TableIterator End();
 
+  /**
+   * Scan some columns of the table. On PAX pages only the minipages of the requested columns are read.
+   * @param schema the schema of the tuples of the table
+   * @param column_ids the columns to read, in the order they should be produced
+   * @param txn the transaction performing the scan
+   * @return an iterator producing the requested columns of every tuple
+   */
+  ColumnIterator ScanColumns(const Schema *schema, std::vector<uint32_t> column_ids, Transaction *txn);
+
+  /**
+   * Scan the table without copying tuples out of its pages.
+   * @param txn the transaction performing the scan
+   * @return an iterator producing a view of every tuple, see TupleViewIterator for how long the views are valid
+   */
+  TupleViewIterator ScanViews(Transaction *txn);
+
+  /**
+   * Prepare a scan of the table that is split among worker threads, each of which creates its own iterator with
+   * ParallelScan::CreateWorker. Pages added to the table afterwards are not scanned.
+   * @param worker_count the number of workers that will take part in the scan
+   * @return the parallel scan
+   */
+  std::unique_ptr<ParallelScan> CreateParallelScan(uint32_t worker_count);
+
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the free space map of this table */
+  inline FreeSpaceMap *GetFreeSpaceMap() { return free_space_map_.get(); }
+
+  /** @return the page layout of this table */
+  inline TableLayout GetLayout() const { return layout_; }
+
  private:
+  /**
+   * Call func with page viewed as a page of this table's layout, i.e. as a TablePage or a PaxPage.
+   * @return whatever func returns
+   */
+  template <class Func>
+  auto ForLayout(Page *page, Func &&func) {
+    if (layout_ == TableLayout::PAX) {
+      return func(reinterpret_cast<PaxPage *>(page));
+    }
+    return func(reinterpret_cast<TablePage *>(page));
+  }
+
+  /** @return true if the tuple has to have values moved out of line before it is stored */
+  bool NeedsToast(const Tuple &tuple) const {
+    return layout_ == TableLayout::ROW && schema_ != nullptr && !schema_->IsInlined() && tuple.size_ > TOAST_THRESHOLD;
+  }
+
+  /**
+   * Move the largest VARCHAR values of a tuple into overflow pages until it is no larger than TOAST_THRESHOLD, or no
+   * value is left that would shrink it.
+   * @param tuple the tuple to store
+   * @param[out] toasted the tuple with external pointers in place of the moved values
+   * @return false if the overflow pages could not be allocated
+   */
+  bool ToastTuple(const Tuple &tuple, Tuple *toasted);
+
+  /** @return true if the tuple holds external pointers */
+  bool HasExternalValues(const Tuple &tuple) const;
+
+  /** Free the overflow pages of all the external values of a tuple. */
+  void FreeExternalValues(const Tuple &tuple);
+
+  /**
+   * Replace a tuple with a new version that needs no toasting, moving it to another page if it does not fit into its
+   * own, see UpdateTuple. Neither the write set nor the external values are touched.
+   * @param new_tuple the new version
+   * @param rid rid of the tuple
+   * @param[out] old_tuple the replaced version, left empty if it was moved and could not be read back
+   * @param txn transaction performing the update
+   * @return true if the tuple was replaced
+   */
+  bool ReplaceTuple(const Tuple &new_tuple, const RID &rid, Tuple *old_tuple, Transaction *txn);
+
+  /** Insert a tuple that needs no toasting, see InsertTuple. */
+  bool InsertToastedTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+
+  /** Create the first page of a new table and start tracking it in the free space map. */
+  void CreateFirstPage(Transaction *txn);
+
+  /** Read the layout and the free space map of an existing table from its first page. */
+  void OpenFirstPage();
+
+  /** Size the tuples of the table for its layout and schema, and pick the VARCHAR columns to dictionary-encode. */
+  void InitTupleFormat(bool dictionary_encoding);
+
+  /** Initialize a new page of this table. */
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn) {
+    page->Init(page_id, PAGE_SIZE, prev_page_id, log_manager_, txn);
+    if (!dictionary_columns_.empty()) {
+      page->InitDictionary(schema_->GetLength(), dictionary_columns_);
+    }
+  }
+  void InitPage(PaxPage *page, page_id_t page_id, page_id_t prev_page_id, Transaction *txn) {
+    page->Init(page_id, prev_page_id, *schema_, log_manager_, txn);
+  }
+
+  /**
+   * Start tracking a new page in the free space map. PAX pages are tracked without any free space, so that only
+   * appends to the last page fill them.
+   * @return false if the map could not grow
+   */
+  bool TrackPage(TablePage *page) { return free_space_map_->AddPage(page); }
+  bool TrackPage(PaxPage *page) {
+    page_id_t map_page_id;
+    uint32_t slot_num;
+    if (!free_space_map_->AddPage(page->GetTablePageId(), 0, &map_page_id, &slot_num)) {
+      return false;
+    }
+    page->SetFsmLocation(map_page_id, slot_num);
+    return true;
+  }
+
+  /** Refresh the free space map entry of a page after its free space changed. */
+  void UpdateFreeSpace(TablePage *page) { free_space_map_->Update(page); }
+  void UpdateFreeSpace(PaxPage *page) {}
+
+  /**
+   * Append a new page to the table and insert tuples into it, unless the current last page has room by now.
+   * @param tuples tuples to insert
+   * @param count number of tuples
+   * @param[out] rids the rids of the inserted tuples
+   * @param txn the transaction performing the insert
+   * @return the number of tuples inserted from the front of tuples, 0 if the table could not grow
+   */
+  template <class PageType>
+  uint32_t InsertIntoNewPage(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn);
+
+  /**
+   * Insert into the last page of the table, or into a new page appended to the table if the last page has no room.
+   * @param insert inserts into a page, returning the number of tuples that fit
+   * @param txn the transaction performing the insert
+   * @return the number of tuples inserted, 0 if the table could not grow
+   */
+  template <class PageType, class InsertFunc>
+  uint32_t InsertIntoLastPage(InsertFunc &&insert, Transaction *txn);
+
+  /**
+   * Move the new value of an updated tuple of a slotted page to another page, see TablePage::InsertMovedTuple.
+   * @param tuple the new value of the tuple
+   * @param[out] rid where the value is stored
+   * @param txn the transaction performing the update
+   * @return false if the table could not grow
+   */
+  bool InsertMovedTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+
+  /**
+   * Read a tuple moved by an update.
+   * @param moved_rid where the tuple is stored
+   * @param rid the rid of the tuple, i.e. of its stub
+   * @param[out] tuple the tuple
+   * @param txn the transaction performing the read
+   * @return false if the page could not be fetched or the tuple has moved on
+   */
+  bool GetMovedTuple(const RID &moved_rid, const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Remove a tuple moved by an update from the page it was moved to.
+   * @param moved_rid where the tuple is stored
+   * @param[out] removed_tuple if not nullptr, the tuple that was removed
+   */
+  void RemoveMovedTuple(const RID &moved_rid, Tuple *removed_tuple = nullptr);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  TableLayout layout_{TableLayout::ROW};
+  /** The schema of the tuples, kept for laying out PAX pages and for storing values out of line. */
+  std::unique_ptr<Schema> schema_;
+  /** The offsets of the VARCHAR columns new slotted pages dictionary-encode, empty if they do not. */
+  std::vector<uint32_t> dictionary_columns_;
+  /** The overflow pages of the values stored out of line. */
+  OverflowStore overflow_store_{buffer_pool_manager_};
+  /** The size of the largest tuple that fits into a page. */
+  uint32_t max_tuple_size_{TablePage::GetMaxTupleSize()};
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  /** Serializes appending pages to the table. */
+  std::mutex extend_latch_;
 };
 
 }  // namespace bustub
@@ -12,20 +12,26 @@
 
 #pragma once
 
+#include <cassert>
+#include <cstring>
 #include <string>
 #include <vector>
 
 #include "catalog/schema.h"
 #include "common/rid.h"
+#include "type/abstract_pool.h"
 #include "type/value.h"
 
 namespace bustub {
 
 /**
  * Tuple format:
- * ---------------------------------------------------------------------
- * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
- * ---------------------------------------------------------------------
+ * -----------------------------------------------------------------------------------
+ * | FIXED-SIZE or VARIED-SIZED OFFSET | NULL BITMAP | PAYLOAD OF VARIED-SIZED FIELD |
+ * -----------------------------------------------------------------------------------
+ *
+ * The null bitmap has one bit per column, bit i % 8 of byte i / 8 is set if column i is NULL. NULL values still
+ * store their type's NULL sentinel in the fixed-size part, so code that only looks at the values keeps working.
  */
 class Tuple {
   friend class TablePage;
@@ -34,6 +40,9 @@ class Tuple {
 
   friend class TableIterator;
 
+  friend class PaxPage;
+  friend class TupleView;
+
  public:
   // Default constructor (to create a dummy tuple)
   Tuple() = default;
@@ -41,8 +50,9 @@ class Tuple {
   // constructor for table heap tuple
   explicit Tuple(RID rid) : rid_(rid) {}
 
-  // constructor for creating a new tuple based on input value
-  Tuple(std::vector<Value> values, const Schema *schema);
+  // constructor for creating a new tuple based on input value, the data is allocated from pool if there is one and
+  // owned by it, the tuple is then a shallow alias that stays valid as long as the pool memory does
+  Tuple(std::vector<Value> values, const Schema *schema, AbstractPool *pool = nullptr);
 
   // copy constructor, deep copy
   Tuple(const Tuple &other);
@@ -50,6 +60,12 @@ class Tuple {
   // assign operator, deep copy
   Tuple &operator=(const Tuple &other);
 
+  // move constructor, takes over the data of other
+  Tuple(Tuple &&other) noexcept;
+
+  // move assign operator, takes over the data of other
+  Tuple &operator=(Tuple &&other) noexcept;
+
   ~Tuple() {
     if (allocated_) {
       delete[] data_;
@@ -66,6 +82,9 @@ class Tuple {
   // return RID of current tuple
   inline RID GetRid() const { return rid_; }
 
+  // set RID of current tuple, e.g. to the table tuple an index entry points to
+  inline void SetRid(RID rid) { rid_ = rid; }
+
   // Get the address of this tuple in the table's backing store
   inline char *GetData() const { return data_; }
 
@@ -73,16 +92,66 @@ class Tuple {
   inline uint32_t GetLength() const { return size_; }
 
   // Get the value of a specified column (const)
-  // checks the schema to see how to return the Value.
-  Value GetValue(const Schema *schema, uint32_t column_idx) const;
+  // checks the schema to see how to return the Value. VARCHAR values a table stored out of line have to be read
+  // through TableHeap::GetValue or TableHeap::Detoast instead, reading one here throws an Exception.
+  Value GetValue(const Schema *schema, uint32_t column_idx) const { return GetValue(data_, schema, column_idx); }
+
+  // Get the value of a specified column, copying variable-length data into pool instead of the heap
+  Value GetValue(const Schema *schema, uint32_t column_idx, AbstractPool *pool) const;
+
+  // Get the value of a specified column of serialized tuple data, see GetValue above
+  static Value GetValue(const char *data, const Schema *schema, uint32_t column_idx);
+
+  // Read a fixed-width column straight out of the tuple data, without building a Value. T must be the C++ type the
+  // column's type is stored as (e.g. int32_t for INTEGER, see NativeType); NULLs read as the type's NULL value.
+  template <class T>
+  inline T GetFixed(const Schema *schema, uint32_t column_idx) const {
+    const auto &layout = schema->GetColumnLayout(column_idx);
+    assert(layout.inlined_ && layout.width_ == sizeof(T));
+    T value;
+    memcpy(&value, data_ + layout.offset_, sizeof(T));
+    return value;
+  }
+
+  // Read a fixed-width column of a batch of tuples into out, which must have room for count values.
+  template <class T>
+  static void ExtractColumn(const Tuple *tuples, size_t count, const Schema *schema, uint32_t column_idx, T *out) {
+    const auto &layout = schema->GetColumnLayout(column_idx);
+    assert(layout.inlined_ && layout.width_ == sizeof(T));
+    const uint32_t offset = layout.offset_;
+    for (size_t i = 0; i < count; i++) {
+      memcpy(out + i, tuples[i].data_ + offset, sizeof(T));
+    }
+  }
 
-  // Generates a key tuple given schemas and attributes
+  // Read a fixed-width column of all the tuples into out, which must have room for a value per tuple.
+  template <class T>
+  static void ExtractColumn(const std::vector<Tuple> &tuples, const Schema *schema, uint32_t column_idx, T *out) {
+    ExtractColumn(tuples.data(), tuples.size(), schema, column_idx, out);
+  }
+
+  // Read the null bits of a column of a batch of tuples into out as a bitmap, bit i % 8 of byte i / 8 is set if the
+  // column is NULL in tuple i. out must have room for (count + 7) / 8 bytes.
+  static void ExtractNullMask(const Tuple *tuples, size_t count, const Schema *schema, uint32_t column_idx,
+                              uint8_t *out) {
+    const uint32_t byte = schema->GetNullBitmapOffset() + column_idx / 8;
+    const uint32_t bit = column_idx % 8;
+    memset(out, 0, (count + 7) / 8);
+    for (size_t i = 0; i < count; i++) {
+      out[i / 8] |= static_cast<uint8_t>(((static_cast<uint8_t>(tuples[i].data_[byte]) >> bit) & 1U) << (i % 8));
+    }
+  }
+
+  // Generates a key tuple given schemas and attributes; the key attributes must not be stored out of line, see GetValue
   Tuple KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs);
 
   // Is the column value null ?
-  inline bool IsNull(const Schema *schema, uint32_t column_idx) const {
-    Value value = GetValue(schema, column_idx);
-    return value.IsNull();
+  inline bool IsNull(const Schema *schema, uint32_t column_idx) const { return IsNull(data_, schema, column_idx); }
+
+  // Is the column value null in serialized tuple data ?
+  static inline bool IsNull(const char *data, const Schema *schema, uint32_t column_idx) {
+    auto byte = static_cast<uint8_t>(data[schema->GetNullBitmapOffset() + column_idx / 8]);
+    return ((byte >> (column_idx % 8)) & 1U) != 0;
   }
   inline bool IsAllocated() { return allocated_; }
 
@@ -90,7 +159,12 @@ class Tuple {
 
  private:
   // Get the starting storage address of specific column
-  const char *GetDataPtr(const Schema *schema, uint32_t column_idx) const;
+  const char *GetDataPtr(const Schema *schema, uint32_t column_idx) const {
+    return GetDataPtr(data_, schema, column_idx);
+  }
+
+  // Get the starting storage address of specific column in serialized tuple data
+  static const char *GetDataPtr(const char *data, const Schema *schema, uint32_t column_idx);
 
   bool allocated_{false};  // is allocated?
   RID rid_{};              // if pointing to the table heap, the rid is valid
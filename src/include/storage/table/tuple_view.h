@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view.h
+//
+// Identification: src/include/storage/table/tuple_view.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <string>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleView is a non-owning reference to the serialized data of a tuple, usually somewhere inside a pinned page.
+ * Reading values through a view costs no allocation and no copy, but the view is only valid for as long as whatever
+ * produced it keeps the underlying bytes alive and unmodified (see TupleViewIterator). Materialize the view into a
+ * Tuple when the tuple has to outlive that.
+ */
+class TupleView {
+ public:
+  /** Create an empty view. */
+  TupleView() = default;
+
+  /**
+   * Create a view over serialized tuple data.
+   * @param data the serialized tuple
+   * @param size length of the serialized tuple
+   * @param rid rid of the tuple
+   */
+  TupleView(const char *data, uint32_t size, RID rid) : data_(data), size_(size), rid_(rid) {}
+
+  /** Create a view over the data of a tuple. The tuple must outlive the view. */
+  explicit TupleView(const Tuple &tuple) : data_(tuple.GetData()), size_(tuple.GetLength()), rid_(tuple.GetRid()) {}
+
+  /** @return rid of the viewed tuple */
+  inline RID GetRid() const { return rid_; }
+
+  /** @return the serialized tuple */
+  inline const char *GetData() const { return data_; }
+
+  /** @return length of the serialized tuple, including varchar data */
+  inline uint32_t GetLength() const { return size_; }
+
+  /** @return the value of the given column, see Tuple::GetValue */
+  Value GetValue(const Schema *schema, uint32_t column_idx) const;
+
+  /** @return the value of a fixed-width column read straight out of the data, see Tuple::GetFixed */
+  template <class T>
+  inline T GetFixed(const Schema *schema, uint32_t column_idx) const {
+    const auto &layout = schema->GetColumnLayout(column_idx);
+    assert(layout.inlined_ && layout.width_ == sizeof(T));
+    T value;
+    memcpy(&value, data_ + layout.offset_, sizeof(T));
+    return value;
+  }
+
+  /** @return true if the value of the given column is null */
+  inline bool IsNull(const Schema *schema, uint32_t column_idx) const {
+    return Tuple::IsNull(data_, schema, column_idx);
+  }
+
+  /** @return a tuple owning a copy of the viewed data */
+  Tuple Materialize() const;
+
+  std::string ToString(const Schema *schema) const;
+
+ private:
+  const char *data_{nullptr};
+  uint32_t size_{0};
+  RID rid_{};
+};
+
+}  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view_iterator.h
+//
+// Identification: src/include/storage/table/tuple_view_iterator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/page/page_guard.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
+
+namespace bustub {
+
+class TableHeap;
+class TablePage;
+class PaxPage;
+class ParallelScan;
+
+/**
+ * TupleViewIterator scans a TableHeap without copying tuples one by one. The page of the current tuple stays pinned
+ * between calls to Next, and the views it produces point into that page; Materialize a view to keep the tuple around
+ * after the following call to Next or the destruction of the iterator.
+ *
+ * The page is only latched while Next looks for and reads a tuple, so the thread running the scan may pause, or modify
+ * the table it is scanning. Next locks a tuple before it reads it, and reads it from the page as it is once the lock
+ * is granted. The shared lock keeps other transactions from changing the tuple while its view is in use, but not
+ * from deleting or growing other tuples of the page, which moves the tuples of a slotted page around: materialize
+ * views right away when other transactions write to the table.
+ *
+ * The rows of PAX pages are not stored contiguously, so on PAX tables every tuple is still assembled into a buffer
+ * that the view points to. The same goes for the dictionary-encoded tuples of slotted pages with a dictionary, and
+ * for the tuples moved to other pages by updates, which are produced after the other tuples of their page.
+ *
+ * The iterator of a worker of a ParallelScan scans the pages of the morsels it claims instead of the page chain.
+ */
+class TupleViewIterator {
+ public:
+  /**
+   * Create an iterator positioned before the first tuple of the table.
+   * @param table_heap the table to scan
+   * @param txn the transaction performing the scan
+   */
+  TupleViewIterator(TableHeap *table_heap, Transaction *txn);
+
+  /**
+   * Create an iterator for one worker of a parallel scan, positioned before its first tuple.
+   * @param table_heap the table to scan
+   * @param parallel_scan the scan to claim morsels of pages from
+   * @param txn the transaction performing the scan
+   */
+  TupleViewIterator(TableHeap *table_heap, ParallelScan *parallel_scan, Transaction *txn);
+
+  /**
+   * Produce the next tuple.
+   * @param[out] view view of the next tuple, valid until the next call
+   * @return false if the scan is over
+   */
+  bool Next(TupleView *view);
+
+ private:
+  /** Point the view at the tuple at rid_ of a slotted page, decoded into the buffer if the page has a dictionary. */
+  bool ReadTuple(TablePage *page, TupleView *view);
+
+  /** Assemble the tuple at rid_ of a PAX page into the buffer and point the view at it. */
+  bool ReadTuple(PaxPage *page, TupleView *view);
+
+  /** Take a shared lock on the tuple at rid_, unless the transaction holds a lock on it already. */
+  bool LockTuple();
+
+  /** Take next_page_id_ from the morsels of the parallel scan. @return false if there is no page left */
+  bool ClaimPage();
+
+  TableHeap *table_heap_;
+  Transaction *txn_;
+  /** Pin of the page of the current tuple, empty between pages. */
+  PageGuard page_;
+  page_id_t next_page_id_;
+  RID rid_;
+  /** Buffer for the current tuple of a PAX page or a page with a dictionary, or of a moved tuple. */
+  Tuple buffer_;
+  /** The tuples of the current page that were moved to other pages by updates. */
+  std::vector<RID> forwarded_rids_;
+  /** The parallel scan the pages come from, nullptr to follow the page chain. */
+  ParallelScan *parallel_scan_{nullptr};
+  /** The pages of the morsel claimed last, and the position of the next one to scan. */
+  std::vector<page_id_t> morsel_;
+  size_t morsel_position_{0};
+};
+
+}  // namespace bustub
@@ -13,6 +13,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <new>
 
 namespace bustub {
 
@@ -38,4 +39,54 @@ class AbstractPool {
   virtual void Free(void *ptr) = 0;
 };
 
+/**
+ * Standard library allocator that takes its memory from an AbstractPool, so that containers such as the executors'
+ * hash tables can live in a query's arena. Without a pool it falls back to the global operator new.
+ */
+template <class T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+
+  explicit PoolAllocator(AbstractPool *pool = nullptr) noexcept : pool_(pool) {}
+
+  template <class U>
+  PoolAllocator(const PoolAllocator<U> &other) noexcept : pool_(other.GetPool()) {}  // NOLINT
+
+  T *allocate(size_t n) {  // NOLINT
+    if (pool_ == nullptr) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    void *ptr = pool_->Allocate(n * sizeof(T));
+    if (ptr == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(ptr);
+  }
+
+  void deallocate(T *ptr, size_t n) noexcept {  // NOLINT
+    if (pool_ == nullptr) {
+      ::operator delete(ptr);
+    } else {
+      pool_->Free(ptr);
+    }
+  }
+
+  /** @return the pool this allocator takes its memory from, or nullptr */
+  AbstractPool *GetPool() const noexcept { return pool_; }
+
+  template <class U>
+  bool operator==(const PoolAllocator<U> &other) const noexcept {
+    return pool_ == other.GetPool();
+  }
+
+  template <class U>
+  bool operator!=(const PoolAllocator<U> &other) const noexcept {
+    return pool_ != other.GetPool();
+  }
+
+ private:
+  AbstractPool *pool_;
+};
+
 }  // namespace bustub
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena_pool.h
+//
+// Identification: src/include/type/arena_pool.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "type/abstract_pool.h"
+
+namespace bustub {
+
+/**
+ * ArenaPool is a bump-pointer memory pool. Allocating only moves a pointer forward in the current block, and memory is
+ * never returned piecemeal: Free does nothing, and everything is released at once by Reset or by destroying the pool.
+ * It is meant for short-lived allocations whose lifetime is bounded by a query or a batch, e.g. the data of the tuples
+ * and values an executor produces.
+ *
+ * Blocks survive a Reset and are reused, so a pool that is reset between queries stops calling malloc once it has
+ * grown to the size a query needs. Allocations larger than a quarter of a block get a block of their own, which is
+ * released by Reset.
+ */
+class ArenaPool : public AbstractPool {
+ public:
+  /** Size of the blocks the pool allocates by default. */
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  /**
+   * Create an empty pool. No memory is allocated until the first call to Allocate.
+   * @param block_size the size of the blocks to carve allocations from
+   */
+  explicit ArenaPool(size_t block_size = DEFAULT_BLOCK_SIZE);
+
+  ~ArenaPool() override = default;
+
+  DISALLOW_COPY_AND_MOVE(ArenaPool);
+
+  /**
+   * Allocate memory that stays valid until the next Reset.
+   * @param size number of bytes to allocate
+   * @return a pointer aligned for any fundamental type
+   */
+  void *Allocate(size_t size) override;
+
+  /** Does nothing, memory is only released by Reset. */
+  void Free(void *ptr) override {}
+
+  /** Release all allocations at once. Every pointer handed out so far becomes invalid. */
+  void Reset();
+
+  /** @return the number of bytes handed out since the last Reset */
+  size_t GetAllocatedBytes() const { return allocated_bytes_; }
+
+  /** @return the number of bytes the pool currently holds, including unused space */
+  size_t GetReservedBytes() const;
+
+ private:
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  const size_t block_size_;
+  /** Regular blocks, all of block_size_ bytes. Blocks past current_block_ are empty. */
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  /** Blocks of oversized allocations. */
+  std::vector<std::pair<std::unique_ptr<char[]>, size_t>> large_blocks_;
+  size_t current_block_{0};
+  /** Offset of the free space in the current block. */
+  size_t offset_{0};
+  size_t allocated_bytes_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compare_kernel.h
+//
+// Identification: src/include/type/compare_kernel.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "type/limits.h"
+#include "type/type_id.h"
+#include "type/type_util.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** The C++ type that values of a fixed-length SQL type are stored as, and the stored value that represents NULL. */
+template <TypeId T>
+struct NativeType;
+
+template <>
+struct NativeType<TypeId::BOOLEAN> {
+  using type = int8_t;
+  static constexpr type NULL_VALUE = BUSTUB_BOOLEAN_NULL;
+};
+
+template <>
+struct NativeType<TypeId::TINYINT> {
+  using type = int8_t;
+  static constexpr type NULL_VALUE = BUSTUB_INT8_NULL;
+};
+
+template <>
+struct NativeType<TypeId::SMALLINT> {
+  using type = int16_t;
+  static constexpr type NULL_VALUE = BUSTUB_INT16_NULL;
+};
+
+template <>
+struct NativeType<TypeId::INTEGER> {
+  using type = int32_t;
+  static constexpr type NULL_VALUE = BUSTUB_INT32_NULL;
+};
+
+template <>
+struct NativeType<TypeId::BIGINT> {
+  using type = int64_t;
+  static constexpr type NULL_VALUE = BUSTUB_INT64_NULL;
+};
+
+template <>
+struct NativeType<TypeId::DECIMAL> {
+  using type = double;
+  static constexpr type NULL_VALUE = BUSTUB_DECIMAL_NULL;
+};
+
+template <>
+struct NativeType<TypeId::TIMESTAMP> {
+  using type = uint64_t;
+  static constexpr type NULL_VALUE = BUSTUB_TIMESTAMP_NULL;
+};
+
+/** @return a negative number, zero or a positive number if a is less than, equal to or greater than b */
+template <class A, class B>
+inline int ThreeWayCompare(A a, B b) {
+  return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+/**
+ * CompareKernel compares values of two statically known types. It does what Value::CompareLessThan and friends do
+ * for these types, but without looking up the Type, without a virtual call and without any type checks, so the
+ * comparison inlines into the kernel. Kernels are selected once, e.g. when a comparator or an expression is built,
+ * through GetCompareKernel.
+ *
+ * The primary template covers the numeric types, which compare with the usual arithmetic conversions just like the
+ * Type implementations do; BOOLEAN and TIMESTAMP only compare with themselves.
+ */
+template <TypeId L, TypeId R>
+struct CompareKernel {
+  using LeftType = typename NativeType<L>::type;
+  using RightType = typename NativeType<R>::type;
+
+  /** Compare two values that are not NULL. */
+  static int CompareValues(const Value &lhs, const Value &rhs) {
+    return ThreeWayCompare(lhs.GetAs<LeftType>(), rhs.GetAs<RightType>());
+  }
+
+  /** Compare two serialized values, see Value::SerializeTo. NULL compares equal to everything. */
+  static int CompareSerialized(const char *lhs, const char *rhs) {
+    LeftType left;
+    RightType right;
+    memcpy(&left, lhs, sizeof(LeftType));
+    memcpy(&right, rhs, sizeof(RightType));
+    if (left == NativeType<L>::NULL_VALUE || right == NativeType<R>::NULL_VALUE) {
+      return 0;
+    }
+    return ThreeWayCompare(left, right);
+  }
+};
+
+/** VARCHARs compare bytewise, and a string that is a prefix of another one is smaller than it. */
+template <>
+struct CompareKernel<TypeId::VARCHAR, TypeId::VARCHAR> {
+  static int CompareValues(const Value &lhs, const Value &rhs) {
+    return TypeUtil::CompareStrings(lhs.GetVarlenData(), lhs.GetVarlenLength() - 1, rhs.GetVarlenData(),
+                                    rhs.GetVarlenLength() - 1);
+  }
+
+  static int CompareSerialized(const char *lhs, const char *rhs) {
+    uint32_t left_len;
+    uint32_t right_len;
+    memcpy(&left_len, lhs, sizeof(uint32_t));
+    memcpy(&right_len, rhs, sizeof(uint32_t));
+    if (left_len == BUSTUB_VALUE_NULL || right_len == BUSTUB_VALUE_NULL) {
+      return 0;
+    }
+    return TypeUtil::CompareStrings(lhs + sizeof(uint32_t), left_len - 1, rhs + sizeof(uint32_t), right_len - 1);
+  }
+};
+
+/** Compares two values that are not NULL, returning a negative number, zero or a positive number. */
+using ValueCompareFn = int (*)(const Value &lhs, const Value &rhs);
+
+/** Compares two serialized values, returning a negative number, zero or a positive number. */
+using SerializedCompareFn = int (*)(const char *lhs, const char *rhs);
+
+/** The entry points of a CompareKernel. */
+struct CompareKernelFns {
+  ValueCompareFn compare_values_{nullptr};
+  SerializedCompareFn compare_serialized_{nullptr};
+};
+
+/**
+ * Select the kernel that compares values of the given types.
+ * @param left type of the left-hand side
+ * @param right type of the right-hand side
+ * @return the kernel's functions, both nullptr if there is no kernel for these types and the generic Value
+ * comparison has to be used
+ */
+CompareKernelFns GetCompareKernel(TypeId left, TypeId right);
+
+}  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <utility>
@@ -26,6 +28,11 @@ inline CmpBool GetCmpBool(bool boolean) { return boolean ? CmpBool::CmpTrue : Cm
 // A value is an abstract class that represents a view over SQL data stored in
 // some materialized state. All values have a type and comparison functions, but
 // subclasses implement other type-specific functionality.
+//
+// Values are 16 bytes. A VARCHAR either borrows its data (manage_data == false,
+// e.g. from a page or an arena), stores it inline if it is at most
+// INLINE_VARCHAR_LENGTH bytes long, or shares a reference-counted heap buffer
+// with its copies, so that copying a Value never copies string data.
 class Value {
   // Friend Type classes
   friend class Type;
@@ -39,9 +46,17 @@ class Value {
   friend class TimestampType;
   friend class BooleanType;
   friend class VarlenType;
+  template <TypeId L, TypeId R>
+  friend struct CompareKernel;
 
  public:
-  explicit Value(const TypeId type) : manage_data_(false), type_id_(type) { size_.len_ = BUSTUB_VALUE_NULL; }
+  // VARCHARs up to this length (including the terminating null byte) are stored inside the Value
+  static constexpr uint32_t INLINE_VARCHAR_LENGTH = 12;
+
+  explicit Value(const TypeId type) : type_id_(static_cast<uint8_t>(type)) {
+    value_.bigint_ = 0;
+    size_.len_ = BUSTUB_VALUE_NULL;
+  }
   // BOOLEAN and TINYINT
   Value(TypeId type, int8_t i);
   // DECIMAL
@@ -60,72 +75,103 @@ class Value {
   Value(TypeId type, const std::string &data);
 
   Value() : Value(TypeId::INVALID) {}
-  Value(const Value &other);
-  Value &operator=(Value other);
-  ~Value();
+  Value(const Value &other) noexcept
+      : value_(other.value_),
+        size_(other.size_),
+        type_id_(other.type_id_),
+        storage_(other.storage_),
+        inline_len_(other.inline_len_) {
+    if (storage_ == VarlenStorage::SHARED) {
+      AddReference();
+    }
+  }
+  Value(Value &&other) noexcept
+      : value_(other.value_),
+        size_(other.size_),
+        type_id_(other.type_id_),
+        storage_(other.storage_),
+        inline_len_(other.inline_len_) {
+    // The buffer changes hands, other no longer references it.
+    other.storage_ = VarlenStorage::BORROWED;
+  }
+  Value &operator=(const Value &other) noexcept {
+    Value tmp(other);
+    Swap(*this, tmp);
+    return *this;
+  }
+  Value &operator=(Value &&other) noexcept {
+    Swap(*this, other);
+    return *this;
+  }
+  ~Value() {
+    if (storage_ == VarlenStorage::SHARED) {
+      ReleaseReference();
+    }
+  }
   // NOLINTNEXTLINE
   friend void Swap(Value &first, Value &second) {
     std::swap(first.value_, second.value_);
     std::swap(first.size_, second.size_);
-    std::swap(first.manage_data_, second.manage_data_);
     std::swap(first.type_id_, second.type_id_);
+    std::swap(first.storage_, second.storage_);
+    std::swap(first.inline_len_, second.inline_len_);
   }
   // check whether value is integer
   bool CheckInteger() const;
   bool CheckComparable(const Value &o) const;
 
   // Get the type of this value
-  inline TypeId GetTypeId() const { return type_id_; }
+  inline TypeId GetTypeId() const { return static_cast<TypeId>(type_id_); }
 
   // Get the length of the variable length data
-  inline uint32_t GetLength() const { return Type::GetInstance(type_id_)->GetLength(*this); }
+  inline uint32_t GetLength() const { return Type::GetInstance(GetTypeId())->GetLength(*this); }
   // Access the raw variable length data
-  inline const char *GetData() const { return Type::GetInstance(type_id_)->GetData(*this); }
+  inline const char *GetData() const { return Type::GetInstance(GetTypeId())->GetData(*this); }
 
   template <class T>
   inline T GetAs() const {
     return *reinterpret_cast<const T *>(&value_);
   }
 
-  inline Value CastAs(const TypeId type_id) const { return Type::GetInstance(type_id_)->CastAs(*this, type_id); }
+  inline Value CastAs(const TypeId type_id) const { return Type::GetInstance(GetTypeId())->CastAs(*this, type_id); }
   // Comparison Methods
-  inline CmpBool CompareEquals(const Value &o) const { return Type::GetInstance(type_id_)->CompareEquals(*this, o); }
+  inline CmpBool CompareEquals(const Value &o) const { return Type::GetInstance(GetTypeId())->CompareEquals(*this, o); }
   inline CmpBool CompareNotEquals(const Value &o) const {
-    return Type::GetInstance(type_id_)->CompareNotEquals(*this, o);
+    return Type::GetInstance(GetTypeId())->CompareNotEquals(*this, o);
   }
   inline CmpBool CompareLessThan(const Value &o) const {
-    return Type::GetInstance(type_id_)->CompareLessThan(*this, o);
+    return Type::GetInstance(GetTypeId())->CompareLessThan(*this, o);
   }
   inline CmpBool CompareLessThanEquals(const Value &o) const {
-    return Type::GetInstance(type_id_)->CompareLessThanEquals(*this, o);
+    return Type::GetInstance(GetTypeId())->CompareLessThanEquals(*this, o);
   }
   inline CmpBool CompareGreaterThan(const Value &o) const {
-    return Type::GetInstance(type_id_)->CompareGreaterThan(*this, o);
+    return Type::GetInstance(GetTypeId())->CompareGreaterThan(*this, o);
   }
   inline CmpBool CompareGreaterThanEquals(const Value &o) const {
-    return Type::GetInstance(type_id_)->CompareGreaterThanEquals(*this, o);
+    return Type::GetInstance(GetTypeId())->CompareGreaterThanEquals(*this, o);
   }
 
   // Other mathematical functions
-  inline Value Add(const Value &o) const { return Type::GetInstance(type_id_)->Add(*this, o); }
-  inline Value Subtract(const Value &o) const { return Type::GetInstance(type_id_)->Subtract(*this, o); }
-  inline Value Multiply(const Value &o) const { return Type::GetInstance(type_id_)->Multiply(*this, o); }
-  inline Value Divide(const Value &o) const { return Type::GetInstance(type_id_)->Divide(*this, o); }
-  inline Value Modulo(const Value &o) const { return Type::GetInstance(type_id_)->Modulo(*this, o); }
-  inline Value Min(const Value &o) const { return Type::GetInstance(type_id_)->Min(*this, o); }
-  inline Value Max(const Value &o) const { return Type::GetInstance(type_id_)->Max(*this, o); }
-  inline Value Sqrt() const { return Type::GetInstance(type_id_)->Sqrt(*this); }
-
-  inline Value OperateNull(const Value &o) const { return Type::GetInstance(type_id_)->OperateNull(*this, o); }
-  inline bool IsZero() const { return Type::GetInstance(type_id_)->IsZero(*this); }
-  inline bool IsNull() const { return size_.len_ == BUSTUB_VALUE_NULL; }
+  inline Value Add(const Value &o) const { return Type::GetInstance(GetTypeId())->Add(*this, o); }
+  inline Value Subtract(const Value &o) const { return Type::GetInstance(GetTypeId())->Subtract(*this, o); }
+  inline Value Multiply(const Value &o) const { return Type::GetInstance(GetTypeId())->Multiply(*this, o); }
+  inline Value Divide(const Value &o) const { return Type::GetInstance(GetTypeId())->Divide(*this, o); }
+  inline Value Modulo(const Value &o) const { return Type::GetInstance(GetTypeId())->Modulo(*this, o); }
+  inline Value Min(const Value &o) const { return Type::GetInstance(GetTypeId())->Min(*this, o); }
+  inline Value Max(const Value &o) const { return Type::GetInstance(GetTypeId())->Max(*this, o); }
+  inline Value Sqrt() const { return Type::GetInstance(GetTypeId())->Sqrt(*this); }
+
+  inline Value OperateNull(const Value &o) const { return Type::GetInstance(GetTypeId())->OperateNull(*this, o); }
+  inline bool IsZero() const { return Type::GetInstance(GetTypeId())->IsZero(*this); }
+  inline bool IsNull() const { return storage_ != VarlenStorage::INLINED && size_.len_ == BUSTUB_VALUE_NULL; }
 
   // Serialize this value into the given storage space. The inlined parameter
   // indicates whether we are allowed to inline this value into the storage
   // space, or whether we must store only a reference to this value. If inlined
   // is false, we may use the provided data pool to allocate space for this
   // value, storing a reference into the allocated pool space in the storage.
-  inline void SerializeTo(char *storage) const { Type::GetInstance(type_id_)->SerializeTo(*this, storage); }
+  inline void SerializeTo(char *storage) const { Type::GetInstance(GetTypeId())->SerializeTo(*this, storage); }
 
   // Deserialize a value of the given type from the given storage space.
   inline static Value DeserializeFrom(const char *storage, const TypeId type_id) {
@@ -133,11 +179,43 @@ class Value {
   }
 
   // Return a string version of this value
-  inline std::string ToString() const { return Type::GetInstance(type_id_)->ToString(*this); }
+  inline std::string ToString() const { return Type::GetInstance(GetTypeId())->ToString(*this); }
   // Create a copy of this value
-  inline Value Copy() const { return Type::GetInstance(type_id_)->Copy(*this); }
+  inline Value Copy() const { return Type::GetInstance(GetTypeId())->Copy(*this); }
 
  protected:
+  // Where the data of a VARCHAR lives
+  enum class VarlenStorage : uint8_t {
+    // somewhere else, value_.varlen_ points to it; also used by all other types
+    BORROWED,
+    // in a reference-counted heap buffer, value_.varlen_ points to the data behind the SharedHeader
+    SHARED,
+    // in the bytes of value_ and size_, inline_len_ is the length
+    INLINED
+  };
+
+  // Header of a shared VARCHAR buffer
+  struct alignas(8) SharedHeader {
+    std::atomic<uint32_t> references_;
+  };
+
+  // Store a copy of a VARCHAR's data, inline if possible
+  void StoreVarlen(const char *data, uint32_t len);
+  // Take another reference to the shared buffer
+  void AddReference() const { GetSharedHeader()->references_.fetch_add(1, std::memory_order_relaxed); }
+  // Drop a reference to the shared buffer, freeing it if it was the last one
+  void ReleaseReference();
+  SharedHeader *GetSharedHeader() const {
+    return reinterpret_cast<SharedHeader *>(value_.varlen_ - sizeof(SharedHeader));
+  }
+
+  // The data of a VARCHAR
+  inline const char *GetVarlenData() const {
+    return storage_ == VarlenStorage::INLINED ? reinterpret_cast<const char *>(&value_) : value_.const_varlen_;
+  }
+  // The length of a VARCHAR, including the terminating null byte
+  inline uint32_t GetVarlenLength() const { return storage_ == VarlenStorage::INLINED ? inline_len_ : size_.len_; }
+
   // The actual value item
   union Val {
     int8_t boolean_;
@@ -156,8 +234,9 @@ class Value {
     TypeId elem_type_id_;
   } size_;
 
-  bool manage_data_;
   // The data type
-  TypeId type_id_;
+  uint8_t type_id_;
+  VarlenStorage storage_{VarlenStorage::BORROWED};
+  uint8_t inline_len_{0};
 };
 }  // namespace bustub
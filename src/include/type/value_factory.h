@@ -13,6 +13,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 
@@ -34,8 +35,12 @@ namespace bustub {
 
 class ValueFactory {
  public:
-  static inline Value Clone(const Value &src, __attribute__((__unused__)) AbstractPool *dataPool = nullptr) {
-    return src.Copy();
+  /** Copy a value. Variable-length data is copied into dataPool if there is one, and owned by it. */
+  static inline Value Clone(const Value &src, AbstractPool *dataPool = nullptr) {
+    if (dataPool == nullptr || src.GetTypeId() != TypeId::VARCHAR || src.IsNull()) {
+      return src.Copy();
+    }
+    return GetVarcharValue(src.GetData(), src.GetLength(), false, dataPool);
   }
 
   static inline Value GetTinyIntValue(int8_t value) { return Value(TypeId::TINYINT, value); }
@@ -58,19 +63,26 @@ class ValueFactory {
 
   static inline Value GetBooleanValue(int8_t value) { return Value(TypeId::BOOLEAN, value); }
 
-  static inline Value GetVarcharValue(const char *value, bool manage_data,
-                                      __attribute__((__unused__)) AbstractPool *pool = nullptr) {
+  // The string is copied into the pool if there is one; the pool then owns the copy and manage_data is ignored.
+  static inline Value GetVarcharValue(const char *value, bool manage_data, AbstractPool *pool = nullptr) {
     auto len = static_cast<uint32_t>(value == nullptr ? 0U : strlen(value) + 1);
-    return GetVarcharValue(value, len, manage_data);
+    return GetVarcharValue(value, len, manage_data, pool);
   }
 
   static inline Value GetVarcharValue(const char *value, uint32_t len, bool manage_data,
-                                      __attribute__((__unused__)) AbstractPool *pool = nullptr) {
+                                      AbstractPool *pool = nullptr) {
+    if (pool != nullptr && value != nullptr) {
+      auto *data = static_cast<char *>(pool->Allocate(len));
+      memcpy(data, value, len);
+      return Value(TypeId::VARCHAR, data, len, false);
+    }
     return Value(TypeId::VARCHAR, value, len, manage_data);
   }
 
-  static inline Value GetVarcharValue(const std::string &value,
-                                      __attribute__((__unused__)) AbstractPool *pool = nullptr) {
+  static inline Value GetVarcharValue(const std::string &value, AbstractPool *pool = nullptr) {
+    if (pool != nullptr) {
+      return GetVarcharValue(value.c_str(), static_cast<uint32_t>(value.length()) + 1, false, pool);
+    }
     return Value(TypeId::VARCHAR, value);
   }
 
@@ -95,6 +107,9 @@ class ValueFactory {
       case TypeId::DECIMAL:
         ret_value = GetDecimalValue(BUSTUB_DECIMAL_NULL);
         break;
+      case TypeId::TIMESTAMP:
+        ret_value = GetTimestampValue(BUSTUB_TIMESTAMP_NULL);
+        break;
       case TypeId::VARCHAR:
         ret_value = GetVarcharValue(nullptr, false, nullptr);
         break;
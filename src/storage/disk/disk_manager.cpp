@@ -10,8 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <string>
@@ -25,12 +30,36 @@ namespace bustub {
 
 static char *buffer_used;
 
+/** The log file is preallocated in steps of this many bytes. */
+static constexpr size_t LOG_PREALLOCATE_SIZE = 16 << 20;
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file) : DiskManager(db_file, false) {}
+
+/**
+ * Constructor: open/create a single database file & log file, or in read-only
+ * mode map the existing database file and never create a log file
+ * @input db_file: database file name
+ * @input read_only: whether to map the database file read-only
+ */
+DiskManager::DiskManager(const std::string &db_file, bool read_only)
+    : file_name_(db_file),
+      next_page_id_(0),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      read_only_(read_only) {
+  if (read_only_) {
+    MapReadOnly();
+    next_page_id_ = GetMappedPageCount();
+    buffer_used = nullptr;
+    return;
+  }
+
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -38,19 +67,14 @@ DiskManager::DiskManager(const std::string &db_file)
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
+  log_fd_ = open(log_name_.c_str(), O_RDWR | O_CREAT, 0644);
+  // directory does not exist
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
   }
+  // new log data is appended after whatever is already in the file
+  int log_size = GetFileSize(log_name_);
+  log_reserved_ = log_written_ = log_synced_ = log_preallocated_ = static_cast<size_t>(std::max(log_size, 0));
 
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -68,18 +92,97 @@ DiskManager::DiskManager(const std::string &db_file)
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  UnmapReadOnly();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  UnmapReadOnly();
   db_io_.close();
-  log_io_.close();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+}
+
+void DiskManager::MapReadOnly() {
+  db_fd_ = open(file_name_.c_str(), O_RDONLY);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(db_fd_, &stat_buf) != 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception("can't stat db file");
+  }
+  // a trailing partial page is never handed out
+  mapped_size_ = static_cast<size_t>(stat_buf.st_size) / PAGE_SIZE * PAGE_SIZE;
+  if (mapped_size_ == 0) {
+    return;
+  }
+  void *addr = mmap(nullptr, mapped_size_, PROT_READ, MAP_SHARED, db_fd_, 0);
+  if (addr == MAP_FAILED) {
+    close(db_fd_);
+    db_fd_ = -1;
+    mapped_size_ = 0;
+    throw Exception("can't mmap db file");
+  }
+  mapped_data_ = static_cast<char *>(addr);
+}
+
+void DiskManager::UnmapReadOnly() {
+  if (mapped_data_ != nullptr) {
+    munmap(mapped_data_, mapped_size_);
+    mapped_data_ = nullptr;
+    mapped_size_ = 0;
+  }
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+}
+
+char *DiskManager::GetMappedPage(page_id_t page_id) {
+  if (mapped_data_ == nullptr || page_id < 0 || page_id >= GetMappedPageCount()) {
+    return nullptr;
+  }
+  return mapped_data_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+}
+
+void DiskManager::AdviseAccessPattern(AccessPattern pattern) {
+  if (mapped_data_ == nullptr) {
+    return;
+  }
+  int advice = MADV_NORMAL;
+  switch (pattern) {
+    case AccessPattern::SEQUENTIAL:
+      advice = MADV_SEQUENTIAL;
+      break;
+    case AccessPattern::RANDOM:
+      advice = MADV_RANDOM;
+      break;
+    case AccessPattern::NORMAL:
+      break;
+  }
+  if (madvise(mapped_data_, mapped_size_, advice) != 0) {
+    LOG_DEBUG("madvise failed on the db file mapping");
+  }
 }
 
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
+  if (read_only_) {
+    throw Exception("cannot write a page of a read-only db file");
+  }
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
   // set write cursor to offset
   num_writes_ += 1;
@@ -98,6 +201,15 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
+  if (read_only_) {
+    const char *mapped_page = GetMappedPage(page_id);
+    if (mapped_page == nullptr) {
+      LOG_DEBUG("I/O error reading past end of file");
+      return;
+    }
+    memcpy(page_data, mapped_page, PAGE_SIZE);
+    return;
+  }
   int offset = page_id * PAGE_SIZE;
   // check if read beyond file length
   if (offset > GetFileSize(file_name_)) {
@@ -124,9 +236,18 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
 
 /**
  * Write the contents of the log into disk file
- * Only return when sync is done, and only perform sequence write
+ * Only return when sync is done. Concurrent writers reserve disjoint ranges of
+ * the log and write them in parallel; a single fdatasync then makes every
+ * write that completed before it durable (group commit). A failed write or
+ * sync fails its caller and every caller still waiting for a sync, and all
+ * later ones: the log past the failure may have a hole, so none of it may be
+ * acknowledged as durable
  */
 void DiskManager::WriteLog(char *log_data, int size) {
+  if (read_only_) {
+    throw Exception("cannot write the log of a read-only db file");
+  }
+  std::unique_lock<std::mutex> lock(log_latch_);
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -135,6 +256,9 @@ void DiskManager::WriteLog(char *log_data, int size) {
     return;
   }
 
+  if (log_failed_) {
+    throw Exception("cannot write the log after an I/O error");
+  }
   flush_log_ = true;
 
   if (flush_log_f_ != nullptr) {
@@ -143,17 +267,78 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
-  // sequence write
-  log_io_.write(log_data, size);
+  // reserve our range of the log, then write it without holding the latch
+  size_t offset = log_reserved_;
+  size_t end = offset + size;
+  log_reserved_ = end;
+  PreallocateLog(end);
+  lock.unlock();
 
-  // check for I/O error
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while writing log");
-    return;
+  size_t written = 0;
+  while (written < static_cast<size_t>(size)) {
+    ssize_t rc = pwrite(log_fd_, log_data + written, size - written, offset + written);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // check for I/O error
+      LOG_DEBUG("I/O error while writing log");
+      lock.lock();
+      FailLog();
+      throw Exception("I/O error while writing log");
+    }
+    written += rc;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+
+  lock.lock();
+  // publish the write; log_written_ only advances over a gap-free prefix of the log
+  log_completed_.emplace(offset, end);
+  while (!log_completed_.empty() && log_completed_.begin()->first == log_written_) {
+    log_written_ = log_completed_.begin()->second;
+    log_completed_.erase(log_completed_.begin());
+  }
+  log_cv_.notify_all();
+
+  // wait until a sync covers our range, becoming the syncing leader if nobody else is
+  while (log_synced_ < end) {
+    if (log_failed_) {
+      throw Exception("log write failed before it was synced");
+    }
+    if (!log_syncing_ && log_written_ >= end) {
+      log_syncing_ = true;
+      size_t sync_end = log_written_;
+      num_log_syncs_ += 1;
+      lock.unlock();
+#ifdef __linux__
+      int rc = fdatasync(log_fd_);
+#else
+      int rc = fsync(log_fd_);
+#endif
+      lock.lock();
+      log_syncing_ = false;
+      if (rc != 0) {
+        // the kernel may have dropped the dirty pages it failed to write back, a retry could wrongly succeed
+        LOG_DEBUG("I/O error while syncing log");
+        FailLog();
+        throw Exception("I/O error while syncing log");
+      }
+      log_synced_ = std::max(log_synced_, sync_end);
+      log_cv_.notify_all();
+    } else {
+      log_cv_.wait(lock);
+    }
+  }
+  flush_log_ = log_synced_ < log_reserved_;
+}
+
+/**
+ * Mark the log as failed and wake up every caller waiting for a sync, so that
+ * they fail instead of waiting for a sync that never comes. Must hold log_latch_
+ */
+void DiskManager::FailLog() {
+  log_failed_ = true;
   flush_log_ = false;
+  log_cv_.notify_all();
 }
 
 /**
@@ -162,33 +347,68 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * @return: false means already reach the end
  */
 bool DiskManager::ReadLog(char *log_data, int size, int offset) {
+  if (read_only_) {
+    return false;
+  }
   if (offset >= GetFileSize(log_name_)) {
     // LOG_DEBUG("end of log file");
     // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+  ssize_t read_count = pread(log_fd_, log_data, size, offset);
 
-  if (log_io_.bad()) {
+  if (read_count < 0) {
     LOG_DEBUG("I/O error while reading log");
     return false;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
   return true;
 }
 
+/**
+ * Grow the disk space reserved for the log in large steps. FALLOC_FL_KEEP_SIZE
+ * keeps the file size at the end of the written log, so ReadLog still knows
+ * where the log ends while appends no longer have to allocate blocks
+ */
+void DiskManager::PreallocateLog(size_t end) {
+  if (end <= log_preallocated_) {
+    return;
+  }
+  size_t new_end = (end / LOG_PREALLOCATE_SIZE + 1) * LOG_PREALLOCATE_SIZE;
+#ifdef __linux__
+  if (fallocate(log_fd_, FALLOC_FL_KEEP_SIZE, log_preallocated_, new_end - log_preallocated_) != 0) {
+    LOG_DEBUG("could not preallocate the log file");
+  }
+#endif
+  log_preallocated_ = new_end;
+}
+
+/**
+ * Number of pages of the database file: the pages that were written, or allocated by this disk manager
+ */
+page_id_t DiskManager::GetNumPages() {
+  if (read_only_) {
+    return GetMappedPageCount();
+  }
+  int file_size = GetFileSize(file_name_);
+  auto written_pages = static_cast<page_id_t>((std::max(file_size, 0) + PAGE_SIZE - 1) / PAGE_SIZE);
+  return std::max(next_page_id_.load(), written_pages);
+}
+
 /**
  * Allocate new page (operations like create index/table)
  * For now just keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() {
+  if (read_only_) {
+    throw Exception("cannot allocate a page in a read-only db file");
+  }
+  return next_page_id_++;
+}
 
 /**
  * Deallocate page (operations like drop index/table)
@@ -207,6 +427,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of log syncs made so far
+ */
+int DiskManager::GetNumLogSyncs() const { return num_log_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -9,7 +9,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -19,19 +23,29 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, BPlusTreeMode mode, bool unique)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
+      mode_(mode),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      unique_(unique),
+      // Small enough that a full leaf always has a key boundary near its middle to split at.
+      max_inline_duplicates_(std::max(1, (leaf_max_size - 1) / 4)),
+      posting_lists_(buffer_pool_manager) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const {
+  root_latch_.RLock();
+  bool empty = root_page_id_ == INVALID_PAGE_ID;
+  root_latch_.RUnlock();
+  return empty;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +56,176 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return false;
+  }
+  bool found = CollectValues(reinterpret_cast<LeafPage *>(page->GetData()), key, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result,
+                                 Transaction *transaction) {
+  result->assign(keys.size(), std::vector<ValueType>());
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this, &keys](size_t lhs, size_t rhs) { return comparator_(keys[lhs], keys[rhs]) < 0; });
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    return GetValuesBLink(keys, order, result);
+  }
+  return GetValuesLatchCrabbing(keys, order, result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::GetValuesLatchCrabbing(const std::vector<KeyType> &keys, const std::vector<size_t> &order,
+                                              std::vector<std::vector<ValueType>> *result) {
+  size_t found = 0;
+  // The path of the last probe, root first. The probes ascend, so a page covers a probe if it is below its bound.
+  std::vector<ProbeFrame> path;
+  for (size_t probe = 0; probe < order.size(); probe++) {
+    const KeyType &key = keys[order[probe]];
+    while (!path.empty() && path.back().bounded_ && comparator_(key, path.back().upper_) >= 0) {
+      ReleaseProbeFrame(&path.back());
+      path.pop_back();
+    }
+    if (path.empty()) {
+      root_latch_.RLock();
+      if (root_page_id_ == INVALID_PAGE_ID) {
+        root_latch_.RUnlock();
+        break;
+      }
+      Page *root = FetchPage(root_page_id_);
+      root->RLatch();
+      root_latch_.RUnlock();
+      path.push_back(ProbeFrame{root, false, KeyType(), {}, 0, 0});
+    }
+    while (!reinterpret_cast<BPlusTreePage *>(path.back().page_->GetData())->IsLeafPage()) {
+      ProbeFrame *frame = &path.back();
+      auto internal = reinterpret_cast<InternalPage *>(frame->page_->GetData());
+      ProbeFrame child_frame{nullptr, frame->bounded_, frame->upper_, {}, 0, 0};
+      int child;
+      if (!frame->prefetched_.empty() && frame->prefetched_.front().probe_ == probe) {
+        child = frame->prefetched_.front().index_;
+        child_frame.page_ = frame->prefetched_.front().page_;
+        frame->prefetched_.erase(frame->prefetched_.begin());
+      } else {
+        child = internal->ChildIndex(key, comparator_);
+        child_frame.page_ = FetchPage(internal->ValueAt(child));
+      }
+      if (child + 1 < internal->GetSize()) {
+        child_frame.bounded_ = true;
+        child_frame.upper_ = internal->KeyAt(child + 1);
+      }
+      child_frame.page_->RLatch();
+      // The inner pages near the root stay cached anyway, the leaves are worth the search for the next probes.
+      if (reinterpret_cast<BPlusTreePage *>(child_frame.page_->GetData())->IsLeafPage()) {
+        PrefetchChildren(frame, child, keys, order, probe);
+      }
+      path.push_back(std::move(child_frame));
+    }
+    if (CollectValues(reinterpret_cast<LeafPage *>(path.back().page_->GetData()), key, &(*result)[order[probe]])) {
+      found++;
+    }
+  }
+  while (!path.empty()) {
+    ReleaseProbeFrame(&path.back());
+    path.pop_back();
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PrefetchChildren(ProbeFrame *frame, int child, const std::vector<KeyType> &keys,
+                                      const std::vector<size_t> &order, size_t probe) {
+  auto internal = reinterpret_cast<InternalPage *>(frame->page_->GetData());
+  if (frame->lookahead_ <= probe) {
+    frame->lookahead_ = probe + 1;
+    frame->last_child_ = child;
+  }
+  // The children of a read latched page can be neither deleted nor moved to another parent while pinned ahead.
+  while (frame->lookahead_ < order.size() && static_cast<int>(frame->prefetched_.size()) < PROBE_PREFETCH_DISTANCE) {
+    const KeyType &key = keys[order[frame->lookahead_]];
+    if (frame->bounded_ && comparator_(key, frame->upper_) >= 0) {
+      break;
+    }
+    // Probes that fall into the last child pinned are skipped without searching the page.
+    int next_child = frame->last_child_ + 1;
+    if (next_child >= internal->GetSize() || comparator_(key, internal->KeyAt(next_child)) < 0) {
+      frame->lookahead_++;
+      continue;
+    }
+    frame->last_child_ = internal->ChildIndex(key, comparator_);
+    Page *page = FetchPage(internal->ValueAt(frame->last_child_));
+    // The header, and the first keys a binary search of the page compares with.
+    for (int offset = 0; offset < PAGE_SIZE; offset += PAGE_SIZE / 4) {
+      __builtin_prefetch(page->GetData() + offset);
+    }
+    frame->prefetched_.push_back(PrefetchedChild{frame->lookahead_, frame->last_child_, page});
+    frame->lookahead_++;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseProbeFrame(ProbeFrame *frame) {
+  for (const auto &prefetched : frame->prefetched_) {
+    buffer_pool_manager_->UnpinPage(prefetched.page_->GetPageId(), false);
+  }
+  frame->prefetched_.clear();
+  frame->page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(frame->page_->GetPageId(), false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::GetValuesBLink(const std::vector<KeyType> &keys, const std::vector<size_t> &order,
+                                      std::vector<std::vector<ValueType>> *result) {
+  size_t found = 0;
+  // The inner pages above the current leaf, root level first. They are not latched: pages of a B-link tree are never
+  // deleted and their keys only ever move right, so a page that covered a probe still covers the keys between it and
+  // its high key, and the probes ascend.
+  std::vector<page_id_t> stack;
+  Page *page = nullptr;
+  for (size_t probe = 0; probe < order.size(); probe++) {
+    const KeyType &key = keys[order[probe]];
+    if (page != nullptr && MoveRight(reinterpret_cast<BPlusTreePage *>(page->GetData()), key) != INVALID_PAGE_ID) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = nullptr;
+    }
+    if (page == nullptr) {
+      page_id_t leaf_page_id = INVALID_PAGE_ID;
+      while (!stack.empty() && leaf_page_id == INVALID_PAGE_ID) {
+        page_id_t page_id = stack.back();
+        stack.pop_back();
+        Page *inner_page = FetchPage(page_id);
+        inner_page->RLatch();
+        bool covers = MoveRight(reinterpret_cast<BPlusTreePage *>(inner_page->GetData()), key) == INVALID_PAGE_ID;
+        inner_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        if (covers) {
+          leaf_page_id = DescendBLink(page_id, key, false, false, &stack);
+        }
+      }
+      if (leaf_page_id == INVALID_PAGE_ID) {
+        leaf_page_id = FindLeafPageIdBLink(key, false, false, &stack);
+      }
+      if (leaf_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      page = LatchCoveringPage(leaf_page_id, key, false);
+    }
+    if (CollectValues(reinterpret_cast<LeafPage *>(page->GetData()), key, &(*result)[order[probe]])) {
+      found++;
+    }
+  }
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  return found;
 }
 
 /*****************************************************************************
@@ -52,11 +235,31 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if user try to insert a duplicate key (in a non-unique tree, a
+ * duplicate key & value pair) return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    return InsertBLink(key, value);
+  }
+  Page *page = FindLeafPageOptimistic(key);
+  if (page != nullptr) {
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    LeafChange change = InsertIntoLeafPage(leaf, key, value, IsSafe(leaf, Operation::INSERT));
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), change == LeafChange::CHANGED);
+    if (change != LeafChange::UNSAFE) {
+      return change == LeafChange::CHANGED;
+    }
+  }
+  // The leaf is about to split, or there is no leaf yet.
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    return InsertIntoLeaf(key, value, &local_transaction);
+  }
+  return InsertIntoLeaf(key, value, transaction);
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,19 +267,73 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate the root page of a B+ tree.");
+  }
+  auto root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  UpdateRootPageId(1);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
+ * This is the pessimistic path of Insert: it write latches every page that the split may reach.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  while (true) {
+    root_latch_.WLock();
+    transaction->AddIntoPageSet(nullptr);
+    if (root_page_id_ == INVALID_PAGE_ID) {
+      StartNewTree(key, value);
+      ReleaseLatches(transaction, true);
+      return true;
+    }
+
+    Page *page = FindLeafPagePessimistic(key, Operation::INSERT, transaction);
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    Page *next_page = nullptr;
+    if (leaf->GetSize() + 1 >= leaf->GetMaxSize()) {
+      if (!TryLatchNextLeaf(leaf, &next_page)) {
+        // Start over rather than wait for the right sibling while holding its left one.
+        ReleaseLatches(transaction, false);
+        std::this_thread::yield();
+        continue;
+      }
+      if (next_page != nullptr) {
+        transaction->AddIntoPageSet(next_page);
+      }
+    }
+    if (InsertIntoLeafPage(leaf, key, value, true) == LeafChange::UNCHANGED) {
+      ReleaseLatches(transaction, false);
+      return false;
+    }
+    if (leaf->GetSize() >= leaf->GetMaxSize()) {
+      LeafPage *new_leaf = Split(leaf);
+      new_leaf->SetNextPageId(leaf->GetNextPageId());
+      new_leaf->SetPrevPageId(leaf->GetPageId());
+      leaf->SetNextPageId(new_leaf->GetPageId());
+      if (next_page != nullptr) {
+        reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(new_leaf->GetPageId());
+      }
+      InsertIntoParent(leaf, new_leaf->KeyAt(0), new_leaf, transaction);
+      // Nobody can reach the new leaf before the latches on its left sibling and parent are released.
+      buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+    }
+    ReleaseLatches(transaction, true);
+    return true;
+  }
 }
 
 /*
@@ -89,7 +346,21 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a page to split a B+ tree page into.");
+  }
+  auto new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    node->MoveHalfTo(new_node, comparator_);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    // B-link trees do not keep track of parents.
+    node->MoveHalfTo(new_node, mode_ == BPlusTreeMode::B_LINK ? nullptr : buffer_pool_manager_);
+  }
+  return new_node;
 }
 
 /*
@@ -103,7 +374,37 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a new root page for a B+ tree.");
+    }
+    auto root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    // The old root was unsafe, so root_latch_ is still held.
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(0);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  // The parent is write latched in the page set, since old_node was unsafe.
+  page_id_t parent_page_id = old_node->GetParentPageId();
+  auto parent = reinterpret_cast<InternalPage *>(FetchPage(parent_page_id)->GetData());
+  new_node->SetParentPageId(parent_page_id);
+  parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+  if (parent->GetSize() > parent->GetMaxSize()) {
+    InternalPage *new_parent = Split(parent);
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,7 +417,66 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  // Pair by pair, so that no remove takes more than one pair out of a leaf.
+  while (RemoveEntry(key, nullptr, transaction) && !unique_) {
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  return RemoveEntry(key, &value, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    return RemoveBLink(key, value);
+  }
+  Page *page = FindLeafPageOptimistic(key);
+  if (page == nullptr) {
+    return false;
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  LeafChange change = RemoveFromLeafPage(leaf, key, value, IsSafe(leaf, Operation::REMOVE));
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), change == LeafChange::CHANGED);
+  if (change != LeafChange::UNSAFE) {
+    return change == LeafChange::CHANGED;
+  }
+  // The leaf is about to underflow.
+  if (transaction == nullptr) {
+    Transaction local_transaction(INVALID_TXN_ID);
+    return RemoveFromLeaf(key, value, &local_transaction);
+  }
+  return RemoveFromLeaf(key, value, transaction);
+}
+
+/*
+ * The pessimistic path of Remove: delete the key from its leaf while write latching every page that a merge may
+ * reach, then merge or redistribute.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, const ValueType *value, Transaction *transaction) {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    ReleaseLatches(transaction, false);
+    return false;
+  }
+
+  Page *page = FindLeafPagePessimistic(key, Operation::REMOVE, transaction);
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (RemoveFromLeafPage(leaf, key, value, true) == LeafChange::UNCHANGED) {
+    ReleaseLatches(transaction, false);
+    return false;
+  }
+  if (CoalesceOrRedistribute(leaf, transaction)) {
+    transaction->AddIntoDeletedPageSet(leaf->GetPageId());
+  }
+  ReleaseLatches(transaction, true);
+  return true;
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -128,7 +488,59 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+  if (node->IsRootPage()) {
+    return AdjustRoot(node);
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+
+  // The parent is write latched in the page set, since node was unsafe. The sibling is latched here: it can only be
+  // reached through the parent, or by crabbing right along the leaves, which never waits for a latch while holding one.
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto parent = reinterpret_cast<InternalPage *>(FetchPage(parent_page_id)->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  page_id_t sibling_page_id = parent->ValueAt(index == 0 ? 1 : index - 1);
+  Page *sibling_page = FetchPage(sibling_page_id);
+  sibling_page->WLatch();
+  auto sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  // A leaf splits once it is full, an internal page once it overflows.
+  int merged_size = sibling->GetSize() + node->GetSize();
+  bool fits = node->IsLeafPage() ? merged_size < node->GetMaxSize() : merged_size <= node->GetMaxSize();
+  // Always merge the right page into the left one. Merging leaves relinks the leaf after the right one, and if that
+  // one is busy the node is left underfull instead, for a later remove to merge.
+  bool merge = fits;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    Page *next_page = nullptr;
+    merge = fits && TryLatchNextLeaf(index == 0 ? sibling : node, &next_page);
+    if (merge && next_page != nullptr) {
+      // Let go of it right away: the merge may go on up the tree.
+      reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId((index == 0 ? node : sibling)->GetPageId());
+      next_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page->GetPageId(), true);
+    }
+  }
+  bool node_deleted = false;
+  if (!fits) {
+    Redistribute(sibling, node, index);
+  } else if (merge) {
+    bool parent_deleted;
+    if (index == 0) {
+      parent_deleted = Coalesce(&node, &sibling, &parent, 1, transaction);
+      transaction->AddIntoDeletedPageSet(sibling_page_id);
+    } else {
+      parent_deleted = Coalesce(&sibling, &node, &parent, index, transaction);
+      node_deleted = true;
+    }
+    if (parent_deleted) {
+      transaction->AddIntoDeletedPageSet(parent_page_id);
+    }
+  }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page_id, true);
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+  return node_deleted;
 }
 
 /*
@@ -142,13 +554,21 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
  * @param   parent             parent page of input "node"
  * @return  true means parent node should be deleted, false means no deletion
  * happend
+ * The pages are deleted by the caller once their latches are released; here *node is the right one of the two and
+ * index is its position in the parent.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
                               Transaction *transaction) {
-  return false;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    (*node)->MoveAllTo(*neighbor_node);
+  } else {
+    (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(index), buffer_pool_manager_);
+  }
+  (*parent)->Remove(index);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
@@ -162,7 +582,26 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
+  page_id_t parent_page_id = node->GetParentPageId();
+  auto parent = reinterpret_cast<InternalPage *>(FetchPage(parent_page_id)->GetData());
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveFirstToEndOf(node, comparator_);
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      neighbor_node->MoveLastToFrontOf(node, comparator_);
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), buffer_pool_manager_);
+    }
+    parent->SetKeyAt(index, node->KeyAt(0));
+  }
+  buffer_pool_manager_->UnpinPage(parent_page_id, true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +613,129 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  // The root was unsafe, so root_latch_ is still held.
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    root_page_id_ = INVALID_PAGE_ID;
+    UpdateRootPageId(0);
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  auto old_root = reinterpret_cast<InternalPage *>(old_root_node);
+  root_page_id_ = old_root->RemoveAndReturnOnlyChild();
+  UpdateRootPageId(0);
+  auto new_root = reinterpret_cast<BPlusTreePage *>(FetchPage(root_page_id_)->GetData());
+  new_root->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  return true;
+}
+
+/*****************************************************************************
+ * DUPLICATES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::LeafChange BPLUSTREE_TYPE::InsertIntoLeafPage(LeafPage *leaf, const KeyType &key,
+                                                                      const ValueType &value, bool grow) {
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+    if (!grow) {
+      return LeafChange::UNSAFE;
+    }
+    leaf->InsertAt(index, key, value);
+    return LeafChange::CHANGED;
+  }
+  if (unique_) {
+    return LeafChange::UNCHANGED;
+  }
+  if (PostingList::IsPosting(leaf->ValueAt(index))) {
+    return posting_lists_.Insert(leaf->ValueAt(index), value) ? LeafChange::CHANGED : LeafChange::UNCHANGED;
+  }
+  int end = index + leaf->RunLength(index, comparator_);
+  int position = index;
+  while (position < end && leaf->ValueAt(position).Get() < value.Get()) {
+    position++;
+  }
+  if (position < end && leaf->ValueAt(position) == value) {
+    return LeafChange::UNCHANGED;
+  }
+  if (end - index < max_inline_duplicates_) {
+    if (!grow) {
+      return LeafChange::UNSAFE;
+    }
+    leaf->InsertAt(position, key, value);
+    return LeafChange::CHANGED;
+  }
+  // One value too many to keep inline: a posting list of them all takes the place of their pairs.
+  std::vector<ValueType> values;
+  for (int i = index; i < end; i++) {
+    values.push_back(leaf->ValueAt(i));
+  }
+  values.insert(values.begin() + (position - index), value);
+  leaf->SetValueAt(index, posting_lists_.Create(values));
+  leaf->RemoveAt(index + 1, end - index - 1);
+  return LeafChange::CHANGED;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::LeafChange BPLUSTREE_TYPE::RemoveFromLeafPage(LeafPage *leaf, const KeyType &key,
+                                                                      const ValueType *value, bool shrink) {
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index == leaf->GetSize() || comparator_(leaf->KeyAt(index), key) != 0) {
+    return LeafChange::UNCHANGED;
+  }
+  int position = index;
+  if (value != nullptr) {
+    if (!unique_ && PostingList::IsPosting(leaf->ValueAt(index))) {
+      // A posting list holds two values at least, so it never empties here and the leaf keeps its pair.
+      ValueType reference = leaf->ValueAt(index);
+      if (!posting_lists_.Remove(&reference, *value)) {
+        return LeafChange::UNCHANGED;
+      }
+      ValueType single;
+      if (posting_lists_.GetSingle(reference, &single)) {
+        posting_lists_.Free(reference);
+        reference = single;
+      }
+      leaf->SetValueAt(index, reference);
+      return LeafChange::CHANGED;
+    }
+    int end = index + leaf->RunLength(index, comparator_);
+    while (position < end && !(leaf->ValueAt(position) == *value)) {
+      position++;
+    }
+    if (position == end) {
+      return LeafChange::UNCHANGED;
+    }
+  }
+  if (!shrink) {
+    return LeafChange::UNSAFE;
+  }
+  if (!unique_ && PostingList::IsPosting(leaf->ValueAt(position))) {
+    posting_lists_.Free(leaf->ValueAt(position));
+  }
+  leaf->RemoveAt(position);
+  return LeafChange::CHANGED;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::CollectValues(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result) {
+  int index = leaf->KeyIndex(key, comparator_);
+  int end = index;
+  for (; end < leaf->GetSize() && comparator_(leaf->KeyAt(end), key) == 0; end++) {
+    ValueType value = leaf->ValueAt(end);
+    if (!unique_ && PostingList::IsPosting(value)) {
+      posting_lists_.Read(value, result);
+    } else {
+      result->push_back(value);
+    }
+  }
+  return end > index;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +746,14 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
+  KeyType key{};
+  Page *page = FindLeafPage(key, true);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(this, page, 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +761,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(this, page, index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,16 +778,612 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Find the right most leaf page first, then construct an index iterator on its last pair
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::rbegin() {
+  int index;
+  Page *page = FindLeafPageBefore(nullptr, &index);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(this, page, index, nullptr, true);
+}
+
+/*
+ * Find the leaf page that contains the input key first, then construct an index iterator on the last pair not
+ * greater than it, which may be in a leaf before it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  Page *page = FindLeafPage(key);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key, comparator_);
+  if (index < leaf->GetSize() && comparator_(leaf->KeyAt(index), key) == 0) {
+    index += leaf->RunLength(index, comparator_);
+  }
+  return INDEXITERATOR_TYPE(this, page, index - 1, &key, true);
+}
+
+/*****************************************************************************
+ * B-LINK TREE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::MoveRight(BPlusTreePage *node, const KeyType &key) const {
+  page_id_t next_page_id;
+  KeyType high_key;
+  if (node->IsLeafPage()) {
+    auto leaf = reinterpret_cast<LeafPage *>(node);
+    next_page_id = leaf->GetNextPageId();
+    high_key = leaf->GetHighKey();
+  } else {
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    next_page_id = internal->GetNextPageId();
+    high_key = internal->GetHighKey();
+  }
+  if (next_page_id != INVALID_PAGE_ID && comparator_(key, high_key) >= 0) {
+    return next_page_id;
+  }
+  return INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::LatchCoveringPage(page_id_t page_id, const KeyType &key, bool exclusive) {
+  while (true) {
+    Page *page = FetchPage(page_id);
+    if (exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    page_id_t next_page_id = MoveRight(reinterpret_cast<BPlusTreePage *>(page->GetData()), key);
+    if (next_page_id == INVALID_PAGE_ID) {
+      return page;
+    }
+    // Pages of a B-link tree are never deleted, so the right sibling is still there once this page is released.
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::FindLeafPageIdBLink(const KeyType &key, bool left_most, bool right_most,
+                                               std::vector<page_id_t> *stack) {
+  root_latch_.RLock();
+  page_id_t page_id = root_page_id_;
+  root_latch_.RUnlock();
+  // A stale root is fine: the old root still covers its keys through its right links.
+  return DescendBLink(page_id, key, left_most, right_most, stack);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::DescendBLink(page_id_t page_id, const KeyType &key, bool left_most, bool right_most,
+                                        std::vector<page_id_t> *stack) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = FetchPage(page_id);
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    // Pages are never deleted, so whether a page is a leaf never changes and can be checked before latching it.
+    if (node->IsLeafPage()) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return page_id;
+    }
+    page->RLatch();
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    page_id_t child_page_id;
+    if (left_most) {
+      child_page_id = internal->ValueAt(0);
+    } else if (right_most) {
+      next_page_id = internal->GetNextPageId();
+      child_page_id = internal->ValueAt(internal->GetSize() - 1);
+    } else {
+      next_page_id = MoveRight(node, key);
+      child_page_id = internal->Lookup(key, comparator_);
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (next_page_id != INVALID_PAGE_ID) {
+      page_id = next_page_id;
+      continue;
+    }
+    if (stack != nullptr) {
+      stack->push_back(page_id);
+    }
+    page_id = child_page_id;
+  }
+  return INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value) {
+  std::vector<page_id_t> stack;
+  page_id_t leaf_page_id = FindLeafPageIdBLink(key, false, false, &stack);
+  if (leaf_page_id == INVALID_PAGE_ID) {
+    root_latch_.WLock();
+    bool started = root_page_id_ == INVALID_PAGE_ID;
+    if (started) {
+      StartNewTree(key, value);
+      height_ = 1;
+    }
+    root_latch_.WUnlock();
+    if (started) {
+      return true;
+    }
+    leaf_page_id = FindLeafPageIdBLink(key, false, false, &stack);
+  }
+
+  Page *page = LatchCoveringPage(leaf_page_id, key, true);
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  if (InsertIntoLeafPage(leaf, key, value, true) == LeafChange::UNCHANGED) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  if (leaf->GetSize() < leaf->GetMaxSize()) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+
+  // The new leaf is reachable through the right link as soon as the leaf is released, before the parent knows of it.
+  LeafPage *new_leaf = Split(leaf);
+  KeyType separator = new_leaf->KeyAt(0);
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  new_leaf->SetPrevPageId(leaf->GetPageId());
+  new_leaf->SetHighKey(leaf->GetHighKey());
+  leaf->SetNextPageId(new_leaf->GetPageId());
+  leaf->SetHighKey(separator);
+  page_id_t new_leaf_page_id = new_leaf->GetPageId();
+  if (new_leaf->GetNextPageId() != INVALID_PAGE_ID) {
+    // Leaves of a B-link tree are only ever latched left to right, so the right sibling can be waited for.
+    Page *next_page = FetchPage(new_leaf->GetNextPageId());
+    next_page->WLatch();
+    reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(new_leaf_page_id);
+    next_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(next_page->GetPageId(), true);
+  }
+  leaf_page_id = page->GetPageId();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(leaf_page_id, true);
+  buffer_pool_manager_->UnpinPage(new_leaf_page_id, true);
+  InsertIntoParentBLink(&stack, 0, leaf_page_id, separator, new_leaf_page_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(std::vector<page_id_t> *stack, int level, page_id_t left_page_id,
+                                           KeyType key, page_id_t right_page_id) {
+  while (true) {
+    if (stack->empty()) {
+      root_latch_.WLock();
+      if (root_page_id_ == left_page_id) {
+        // The root split: grow the tree.
+        page_id_t root_page_id;
+        Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+        if (page == nullptr) {
+          root_latch_.WUnlock();
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a new root page for a B+ tree.");
+        }
+        auto root = reinterpret_cast<InternalPage *>(page->GetData());
+        root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+        root->PopulateNewRoot(left_page_id, key, right_page_id);
+        root_page_id_ = root_page_id;
+        height_++;
+        UpdateRootPageId(0);
+        root_latch_.WUnlock();
+        buffer_pool_manager_->UnpinPage(root_page_id, true);
+        return;
+      }
+      if (height_ - 1 == level) {
+        // The page was a right sibling of the root, whose splitter has yet to grow the tree above them.
+        root_latch_.WUnlock();
+        std::this_thread::yield();
+        continue;
+      }
+      // The tree grew above the level of the page after the descent: find the levels above it again.
+      page_id_t page_id = root_page_id_;
+      int levels_above = height_ - 1 - level;
+      root_latch_.WUnlock();
+      for (int i = 0; i < levels_above; i++) {
+        Page *page = LatchCoveringPage(page_id, key, false);
+        stack->push_back(page->GetPageId());
+        page_id = reinterpret_cast<InternalPage *>(page->GetData())->Lookup(key, comparator_);
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(stack->back(), false);
+      }
+    }
+
+    page_id_t parent_page_id = stack->back();
+    stack->pop_back();
+    Page *page = LatchCoveringPage(parent_page_id, key, true);
+    auto parent = reinterpret_cast<InternalPage *>(page->GetData());
+    parent->Insert(key, right_page_id, comparator_);
+    if (parent->GetSize() <= parent->GetMaxSize()) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return;
+    }
+
+    InternalPage *new_parent = Split(parent);
+    KeyType separator = new_parent->KeyAt(0);
+    new_parent->SetNextPageId(parent->GetNextPageId());
+    new_parent->SetHighKey(parent->GetHighKey());
+    parent->SetNextPageId(new_parent->GetPageId());
+    parent->SetHighKey(separator);
+    left_page_id = page->GetPageId();
+    right_page_id = new_parent->GetPageId();
+    key = separator;
+    level++;
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(left_page_id, true);
+    buffer_pool_manager_->UnpinPage(right_page_id, true);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RemoveBLink(const KeyType &key, const ValueType *value) {
+  page_id_t leaf_page_id = FindLeafPageIdBLink(key, false, false, nullptr);
+  if (leaf_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  Page *page = LatchCoveringPage(leaf_page_id, key, true);
+  bool removed =
+      RemoveFromLeafPage(reinterpret_cast<LeafPage *>(page->GetData()), key, value, true) == LeafChange::CHANGED;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+  return removed;
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BeginBulkLoad(BulkLoadState *state, double fill_factor) {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  // A leaf splits as soon as it is full, an internal page only once it overflows.
+  int leaf_capacity = leaf_max_size_ - 1;
+  state->leaf_fill_ = std::clamp(static_cast<int>(fill_factor * leaf_capacity), std::max(leaf_max_size_ / 2, 1),
+                                 leaf_capacity);
+  state->internal_fill_ = std::clamp(static_cast<int>(fill_factor * internal_max_size_),
+                                     (internal_max_size_ + 1) / 2, internal_max_size_);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppend(BulkLoadState *state, const KeyType &key, const ValueType &value) {
+  if (!unique_) {
+    // Collect the values of a key, to store them inline or as a posting list once they are all known.
+    if (!state->run_.empty() && comparator_(state->run_key_, key) != 0) {
+      FlushBulkLoadRun(state);
+    }
+    state->run_key_ = key;
+    state->run_.push_back(value);
+    return;
+  }
+  // Writing a leaf always holds back some pairs, so the last pair read is still pending. Unlike Insert, the load
+  // cannot refuse a pair of the key on its own, the caller has to hear of the conflict.
+  if (!state->pending_.empty() && comparator_(state->pending_.back().first, key) == 0) {
+    throw Exception("Duplicate key in the bulk load of the unique B+ tree " + index_name_ + ".");
+  }
+  state->pending_.emplace_back(key, value);
+  // Hold back enough pairs to fill the last leaves at least half whenever the input ends.
+  if (state->pending_.size() == static_cast<size_t>(state->leaf_fill_ + leaf_max_size_ - 1)) {
+    WriteBulkLoadLeaf(state, state->leaf_fill_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FlushBulkLoadRun(BulkLoadState *state) {
+  auto &run = state->run_;
+  std::sort(run.begin(), run.end(), [](const ValueType &lhs, const ValueType &rhs) { return lhs.Get() < rhs.Get(); });
+  run.erase(std::unique(run.begin(), run.end()), run.end());
+  if (run.size() > static_cast<size_t>(max_inline_duplicates_)) {
+    state->pending_.emplace_back(state->run_key_, posting_lists_.Create(run));
+  } else {
+    for (const auto &value : run) {
+      state->pending_.emplace_back(state->run_key_, value);
+    }
+  }
+  run.clear();
+  while (state->pending_.size() >= static_cast<size_t>(state->leaf_fill_ + leaf_max_size_ - 1)) {
+    WriteBulkLoadLeaf(state, state->leaf_fill_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::WriteBulkLoadLeaf(BulkLoadState *state, int size) {
+  // Leaves are cut between keys, since the pairs of a key all belong to one leaf.
+  while (!unique_ && static_cast<size_t>(size) < state->pending_.size() &&
+         comparator_(state->pending_[size - 1].first, state->pending_[size].first) == 0) {
+    size--;
+  }
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a leaf page to bulk load a B+ tree.");
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->PopulateFrom(state->pending_.data(), size);
+  state->pending_.erase(state->pending_.begin(), state->pending_.begin() + size);
+  if (state->last_leaf_ != nullptr) {
+    auto last_leaf = reinterpret_cast<LeafPage *>(state->last_leaf_->GetData());
+    leaf->SetPrevPageId(state->last_leaf_->GetPageId());
+    last_leaf->SetNextPageId(page_id);
+    last_leaf->SetHighKey(leaf->KeyAt(0));
+    buffer_pool_manager_->UnpinPage(state->last_leaf_->GetPageId(), true);
+  }
+  state->last_leaf_ = page;
+  state->leaves_.emplace_back(leaf->KeyAt(0), page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FinishBulkLoad(BulkLoadState *state) {
+  if (!state->run_.empty()) {
+    FlushBulkLoadRun(state);
+  }
+  while (!state->pending_.empty()) {
+    WriteBulkLoadLeaf(state, BulkLoadPageSize(state->pending_.size(), state->leaf_fill_, leaf_max_size_ - 1));
+  }
+  if (state->last_leaf_ == nullptr) {
+    root_latch_.WUnlock();
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(state->last_leaf_->GetPageId(), true);
+  state->last_leaf_ = nullptr;
+
+  std::vector<std::pair<KeyType, page_id_t>> level = std::move(state->leaves_);
+  int height = 1;
+  while (level.size() > 1) {
+    level = BuildInternalLevel(level, state->internal_fill_);
+    height++;
+  }
+  root_page_id_ = level[0].second;
+  height_ = height;
+  UpdateRootPageId(1);
+  root_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::AbortBulkLoad(BulkLoadState *state) {
+  // The pages written so far are unreachable, which is all a failed load can promise.
+  if (state->last_leaf_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(state->last_leaf_->GetPageId(), true);
+    state->last_leaf_ = nullptr;
+  }
+  root_page_id_ = INVALID_PAGE_ID;
+  root_latch_.WUnlock();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<std::pair<KeyType, page_id_t>> BPLUSTREE_TYPE::BuildInternalLevel(
+    const std::vector<std::pair<KeyType, page_id_t>> &children, int fill) {
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  // B-link trees do not keep track of parents.
+  BufferPoolManager *adopter = mode_ == BPlusTreeMode::B_LINK ? nullptr : buffer_pool_manager_;
+  Page *last_page = nullptr;
+  for (size_t start = 0; start < children.size();) {
+    int size = BulkLoadPageSize(children.size() - start, fill, internal_max_size_);
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      if (last_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate an internal page to bulk load a B+ tree.");
+    }
+    auto internal = reinterpret_cast<InternalPage *>(page->GetData());
+    internal->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    internal->PopulateFrom(children.data() + start, size, adopter);
+    if (last_page != nullptr) {
+      auto last_internal = reinterpret_cast<InternalPage *>(last_page->GetData());
+      last_internal->SetNextPageId(page_id);
+      last_internal->SetHighKey(children[start].first);
+      buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+    }
+    level.emplace_back(children[start].first, page_id);
+    last_page = page;
+    start += size;
+  }
+  buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+  return level;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::BulkLoadPageSize(size_t remaining, int fill, int capacity) {
+  if (remaining >= static_cast<size_t>(fill + capacity)) {
+    return fill;
+  }
+  if (remaining > static_cast<size_t>(capacity)) {
+    // Both halves are at least half full, since more than a full page remains.
+    return static_cast<int>(remaining - remaining / 2);
+  }
+  return static_cast<int>(remaining);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * Crabs down with read latches; the leaf is returned pinned and read latched.
  */
 INDEX_TEMPLATE_ARGUMENTS
-Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost, bool rightMost) {
+  if (mode_ == BPlusTreeMode::B_LINK) {
+    page_id_t leaf_page_id = FindLeafPageIdBLink(key, leftMost, rightMost, nullptr);
+    if (leaf_page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    if (leftMost || rightMost) {
+      Page *page = FetchPage(leaf_page_id);
+      page->RLatch();
+      // The right most leaf may have split since its parent was read.
+      while (rightMost && reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId() != INVALID_PAGE_ID) {
+        Page *next_page = FetchPage(reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId());
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        next_page->RLatch();
+        page = next_page;
+      }
+      return page;
+    }
+    return LatchCoveringPage(leaf_page_id, key, false);
+  }
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = internal->Lookup(key, comparator_);
+    if (leftMost || rightMost) {
+      child_page_id = internal->ValueAt(leftMost ? 0 : internal->GetSize() - 1);
+    }
+    Page *child_page = FetchPage(child_page_id);
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBefore(const KeyType *key, int *index) {
+  Page *page = key == nullptr ? FindLeafPage(KeyType{}, false, true) : FindLeafPage(*key);
+  if (page != nullptr) {
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    *index = (key == nullptr ? leaf->GetSize() : leaf->KeyIndex(*key, comparator_)) - 1;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::TryLatchNextLeaf(LeafPage *leaf, Page **page) {
+  *page = nullptr;
+  if (leaf->GetNextPageId() == INVALID_PAGE_ID) {
+    return true;
+  }
+  Page *next_page = FetchPage(leaf->GetNextPageId());
+  if (!next_page->TryWLatch()) {
+    buffer_pool_manager_->UnpinPage(next_page->GetPageId(), false);
+    return false;
+  }
+  *page = next_page;
+  return true;
+}
+
+/*
+ * Optimistic descent of writers. Whether a page is a leaf never changes while it is in the tree, and the latch on its
+ * parent (or on the root page id) keeps it there, so the type of the child can be read before latching it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistic(const KeyType &key) {
+  auto latch = [](Page *page) {
+    if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+  };
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchPage(root_page_id_);
+  latch(page);
+  root_latch_.RUnlock();
+  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    Page *child_page = FetchPage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+    latch(child_page);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPagePessimistic(const KeyType &key, Operation op, Transaction *transaction) {
+  Page *page = FetchPage(root_page_id_);
+  while (true) {
+    page->WLatch();
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op)) {
+      ReleaseLatches(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page = FetchPage(reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const {
+  if (op == Operation::INSERT) {
+    // A leaf splits once it is full, an internal page once it holds more children than its max size.
+    return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize() : node->GetSize() < node->GetMaxSize();
+  }
+  if (node->IsRootPage()) {
+    // The root goes away once it has no key (as a leaf) or a single child (as an internal page) left.
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  }
+  return node->GetSize() > node->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatches(Transaction *transaction, bool dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+    } else {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+    }
+  }
+  page_set->clear();
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    // Fails if someone still has the page pinned, e.g. an iterator about to find it empty; the page then leaks.
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a B+ tree page.");
+  }
+  return page;
 }
 
 /*
@@ -226,13 +1397,18 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
   HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  // The header page is shared by all indexes.
+  header_page->WLatch();
   if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
+    // create a new record<index_name + root_page_id> in header_page, unless the tree had one before it was emptied
+    if (!header_page->InsertRecord(index_name_, root_page_id_)) {
+      header_page->UpdateRecord(index_name_, root_page_id_);
+    }
   } else {
     // update root_page_id in header_page
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
+  header_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
@@ -399,4 +1575,13 @@ template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTree<IntegerKey<int32_t>, RID, IntegerComparator<int32_t>>;
+template class BPlusTree<IntegerKey<int64_t>, RID, IntegerComparator<int64_t>>;
+
 }  // namespace bustub
@@ -11,6 +11,8 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include "storage/index/external_sort.h"
+
 namespace bustub {
 /*
  * Constructor
@@ -18,14 +20,32 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
+      buffer_pool_manager_(buffer_pool_manager),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE - 1,
+                 BPlusTreeMode::LATCH_CRABBING, metadata->IsUnique()) {
+  if (metadata->GetIncludeAttrs().empty()) {
+    return;
+  }
+  if (!IsGenericKey<KeyType>::value) {
+    throw NotImplementedException("Only generic keys can include columns: " + metadata->GetName());
+  }
+  // A non-unique tree keeps a single copy of a key whose duplicates it moves to a posting list, which would drop
+  // the included columns of all but one of its entries.
+  if (!metadata->IsUnique()) {
+    throw NotImplementedException("Only unique indexes can include columns: " + metadata->GetName());
+  }
+  if (metadata->GetEntrySchema()->GetNullBitmapOffset() > sizeof(KeyType)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Included columns do not fit the key size: " + metadata->GetName());
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  CheckEntryFits(key);
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,20 +54,140 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                                    Transaction *transaction) {
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i], *GetKeySchema());
+  }
+  container_.GetValues(index_keys, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                     bool high_inclusive, ScanDirection direction, size_t limit,
+                                     std::vector<RID> *result, Transaction *transaction) {
+  VisitRange(low_key, low_inclusive, high_key, high_inclusive, direction, limit,
+             [&](const KeyType &key, const RID &rid) { result->push_back(rid); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanEntries(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                       bool high_inclusive, ScanDirection direction, size_t limit,
+                                       std::vector<Tuple> *result, Transaction *transaction) {
+  if constexpr (IsGenericKey<KeyType>::value) {
+    Schema *entry_schema = GetEntrySchema();
+    std::vector<Value> values;
+    VisitRange(low_key, low_inclusive, high_key, high_inclusive, direction, limit,
+               [&](const KeyType &key, const RID &rid) {
+                 values.clear();
+                 for (uint32_t i = 0; i < entry_schema->GetColumnCount(); i++) {
+                   values.push_back(key.ToValue(entry_schema, i));
+                 }
+                 result->emplace_back(values, entry_schema);
+                 result->back().SetRid(rid);
+               });
+  } else {
+    throw NotImplementedException("Only generic keys can be read back from the index: " + GetName());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename Visitor>
+void BPLUSTREE_INDEX_TYPE::VisitRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                      bool high_inclusive, ScanDirection direction, size_t limit, Visitor visit) {
+  KeyType low;
+  if (low_key != nullptr) {
+    low.SetFromKey(*low_key, *GetKeySchema());
+  }
+  KeyType high;
+  if (high_key != nullptr) {
+    high.SetFromKey(*high_key, *GetKeySchema());
+  }
+  // Whether a key is past the bound the scan stops at.
+  auto past_low = [&](const KeyType &key) {
+    int order = comparator_(key, low);
+    return low_key != nullptr && (order < 0 || (order == 0 && !low_inclusive));
+  };
+  auto past_high = [&](const KeyType &key) {
+    int order = comparator_(key, high);
+    return high_key != nullptr && (order > 0 || (order == 0 && !high_inclusive));
+  };
+
+  size_t scanned = 0;
+  if (direction == ScanDirection::FORWARD) {
+    auto iterator = low_key == nullptr ? container_.begin() : container_.Begin(low);
+    for (; !iterator.isEnd() && scanned < limit; ++iterator) {
+      if (past_low((*iterator).first)) {
+        continue;
+      }
+      if (past_high((*iterator).first)) {
+        break;
+      }
+      visit((*iterator).first, (*iterator).second);
+      scanned++;
+    }
+    return;
+  }
+  auto iterator = high_key == nullptr ? container_.rbegin() : container_.RBegin(high);
+  for (; !iterator.isEnd() && scanned < limit; --iterator) {
+    if (past_high((*iterator).first)) {
+      continue;
+    }
+    if (past_low((*iterator).first)) {
+      break;
+    }
+    visit((*iterator).first, (*iterator).second);
+    scanned++;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::CheckEntryFits(const Tuple &entry) const {
+  if (GetMetadata()->GetIncludeAttrs().empty()) {
+    return;
+  }
+  // The null bitmap may be cut off like in any key, variable-length data may not.
+  Schema *entry_schema = GetEntrySchema();
+  uint32_t size = entry_schema->IsInlined() ? entry_schema->GetNullBitmapOffset() : entry.GetLength();
+  if (size > sizeof(KeyType)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Index entry does not fit the key size: " + GetName());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::BulkLoad(TableHeap *table_heap, const Schema &tuple_schema, Transaction *transaction) {
+  ExternalSort<KeyType, ValueType, KeyComparator> sort(buffer_pool_manager_, comparator_, SORT_MEMORY_PAGES);
+  KeyType index_key;
+  for (auto iterator = table_heap->Begin(transaction); iterator != table_heap->End(); ++iterator) {
+    // Keys may be on columns the table stores out of line.
+    Tuple tuple = *iterator;
+    if (!table_heap->Detoast(&tuple, transaction)) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't read a value stored out of line to index: " + GetName());
+    }
+    Tuple entry = tuple.KeyFromTuple(tuple_schema, *GetEntrySchema(), GetEntryAttrs());
+    CheckEntryFits(entry);
+    index_key.SetFromKey(entry, *GetKeySchema());
+    sort.Add(index_key, iterator->GetRid());
+  }
+  container_.BulkLoad(sort.begin(), sort.end());
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
@@ -57,10 +197,25 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() { return container_.rbegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) { return container_.RBegin(key); }
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTreeIndex<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeIndex<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTreeIndex<IntegerKey<int32_t>, RID, IntegerComparator<int32_t>>;
+template class BPlusTreeIndex<IntegerKey<int64_t>, RID, IntegerComparator<int64_t>>;
+
 }  // namespace bustub
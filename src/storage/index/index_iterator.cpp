@@ -3,28 +3,192 @@
  */
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *leaf, int index,
+                                  const KeyType *bound, bool backward)
+    : tree_(tree), buffer_pool_manager_(tree->buffer_pool_manager_) {
+  if (bound != nullptr) {
+    bound_ = *bound;
+    has_bound_ = true;
+  }
+  Acquire(leaf, index);
+  if (index_ < 0) {
+    SkipExhaustedLeavesBackward();
+  } else {
+    SkipExhaustedLeaves();
+  }
+  LoadPosting(backward || index < 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : tree_(other.tree_),
+      buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      page_id_(other.page_id_),
+      index_(other.index_),
+      bound_(other.bound_),
+      has_bound_(other.has_bound_),
+      posting_(std::move(other.posting_)),
+      posting_index_(other.posting_index_),
+      current_(other.current_) {
+  other.page_ = nullptr;
+  other.page_id_ = INVALID_PAGE_ID;
+  other.index_ = 0;
+  other.posting_index_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    tree_ = other.tree_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    page_id_ = other.page_id_;
+    index_ = other.index_;
+    bound_ = other.bound_;
+    has_bound_ = other.has_bound_;
+    posting_ = std::move(other.posting_);
+    posting_index_ = other.posting_index_;
+    current_ = other.current_;
+    other.page_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+    other.index_ = 0;
+    other.posting_index_ = 0;
+  }
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() { Release(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::isEnd() { return page_ == nullptr; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(page_ != nullptr);
+  if (!posting_.empty()) {
+    return current_;
+  }
+  return GetLeaf()->GetItem(index_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  if (posting_index_ + 1 < static_cast<int>(posting_.size())) {
+    current_.second = posting_[++posting_index_];
+    return *this;
+  }
+  index_++;
+  SkipExhaustedLeaves();
+  LoadPosting(false);
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { throw std::runtime_error("unimplemented"); }
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator--() {
+  assert(page_ != nullptr);
+  if (posting_index_ > 0) {
+    current_.second = posting_[--posting_index_];
+    return *this;
+  }
+  index_--;
+  SkipExhaustedLeavesBackward();
+  LoadPosting(true);
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= GetLeaf()->GetSize()) {
+    auto next_page_id = GetLeaf()->GetNextPageId();
+    // Pin the next leaf before letting go of this one, so that it cannot be deleted in between.
+    Page *next_page = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    Release();
+    if (next_page == nullptr) {
+      return;
+    }
+    next_page->RLatch();
+    Acquire(next_page, 0);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SkipExhaustedLeavesBackward() {
+  while (page_ != nullptr && index_ < 0) {
+    if (GetLeaf()->GetSize() > 0) {
+      bound_ = GetLeaf()->KeyAt(0);
+      has_bound_ = true;
+    }
+    page_id_t page_id = page_id_;
+    page_id_t prev_page_id = GetLeaf()->GetPrevPageId();
+    // Pin the previous leaf before letting go of this one. It cannot be merged away in between, since unlinking it
+    // needs a write latch on this leaf.
+    Page *prev_page = prev_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(prev_page_id);
+    Release();
+    if (prev_page == nullptr) {
+      return;
+    }
+    prev_page->RLatch();
+    auto prev = reinterpret_cast<LeafPage *>(prev_page->GetData());
+    if (prev->GetNextPageId() == page_id) {
+      Acquire(prev_page, prev->GetSize() - 1);
+      continue;
+    }
+    // The previous leaf split, or one of the two was merged into the other, while neither was latched.
+    prev_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    int index;
+    Page *leaf = tree_->FindLeafPageBefore(has_bound_ ? &bound_ : nullptr, &index);
+    if (leaf == nullptr) {
+      return;
+    }
+    Acquire(leaf, index);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::LoadPosting(bool backward) {
+  posting_.clear();
+  posting_index_ = 0;
+  if (page_ == nullptr || tree_->unique_ || !PostingList::IsPosting(GetLeaf()->ValueAt(index_))) {
+    return;
+  }
+  // The posting list is protected by the latch on the leaf, which the iterator holds.
+  tree_->posting_lists_.Read(GetLeaf()->ValueAt(index_), &posting_);
+  posting_index_ = backward ? static_cast<int>(posting_.size()) - 1 : 0;
+  current_ = MappingType(GetLeaf()->KeyAt(index_), posting_[posting_index_]);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Acquire(Page *leaf, int index) {
+  page_ = leaf;
+  page_id_ = leaf->GetPageId();
+  index_ = index;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+    page_ = nullptr;
+  }
+  page_id_ = INVALID_PAGE_ID;
+  index_ = 0;
+  posting_.clear();
+  posting_index_ = 0;
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +200,18 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+
+template class IndexIterator<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class IndexIterator<IntegerKey<int32_t>, RID, IntegerComparator<int32_t>>;
+
+template class IndexIterator<IntegerKey<int64_t>, RID, IntegerComparator<int64_t>>;
+
 }  // namespace bustub
@@ -0,0 +1,351 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.cpp
+//
+// Identification: src/storage/index/posting_list.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/posting_list.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the number of bytes of the LEB128 varint of value */
+uint32_t VarintSize(uint64_t value) {
+  uint32_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+/** Write value as a LEB128 varint. @return the position past it */
+char *PutVarint(char *out, uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<char>(value);
+  return out;
+}
+
+/** Read a LEB128 varint into value. @return the position past it */
+const char *GetVarint(const char *in, uint64_t *value) {
+  uint64_t result = 0;
+  int shift = 0;
+  uint8_t byte;
+  do {
+    byte = static_cast<uint8_t>(*in++);
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    shift += 7;
+  } while ((byte & 0x80) != 0);
+  *value = result;
+  return in;
+}
+
+}  // namespace
+
+RID PostingList::Create(const std::vector<RID> &rids) {
+  BUSTUB_ASSERT(!rids.empty(), "A posting list holds at least one RID.");
+  std::vector<int64_t> values;
+  values.reserve(rids.size());
+  for (const auto &rid : rids) {
+    values.push_back(rid.Get());
+  }
+  PostingPage *first_page = nullptr;
+  PostingPage *prev_page = nullptr;
+  size_t begin = 0;
+  try {
+    while (begin < values.size()) {
+      // Fill the page greedily.
+      uint32_t size = sizeof(int64_t);
+      size_t end = begin + 1;
+      while (end < values.size() && size + VarintSize(values[end] - values[end - 1]) <= PostingPage::CAPACITY) {
+        size += VarintSize(values[end] - values[end - 1]);
+        end++;
+      }
+      auto page = NewPage();
+      Encode(page, values, begin, end);
+      if (prev_page == nullptr) {
+        first_page = page;
+      } else {
+        prev_page->SetNextPageId(page->GetPageId());
+        if (prev_page != first_page) {
+          buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+        }
+      }
+      prev_page = page;
+      begin = end;
+    }
+  } catch (Exception &) {
+    // Out of frames: give back what was written so far.
+    if (first_page != nullptr) {
+      if (prev_page != first_page) {
+        buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+      }
+      auto first_page_id = first_page->GetPageId();
+      buffer_pool_manager_->UnpinPage(first_page_id, true);
+      Free(MakeReference(first_page_id));
+    }
+    throw;
+  }
+  first_page->SetLastPageId(prev_page->GetPageId());
+  if (prev_page != first_page) {
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  }
+  auto first_page_id = first_page->GetPageId();
+  buffer_pool_manager_->UnpinPage(first_page_id, true);
+  return MakeReference(first_page_id);
+}
+
+void PostingList::Read(const RID &reference, std::vector<RID> *result) {
+  std::vector<int64_t> values;
+  auto page_id = reference.GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = FetchPage(page_id);
+    values.clear();
+    Decode(page, &values);
+    for (auto value : values) {
+      result->emplace_back(value);
+    }
+    auto next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+bool PostingList::Insert(const RID &reference, const RID &rid) {
+  auto value = rid.Get();
+  auto first_page_id = reference.GetPageId();
+  std::vector<int64_t> values;
+
+  // RIDs mostly come in ascending order, as tables fill up: append them to the last page without walking the list.
+  auto first_page = FetchPage(first_page_id);
+  auto last_page_id = first_page->GetLastPageId();
+  buffer_pool_manager_->UnpinPage(first_page_id, false);
+  auto last_page = FetchPage(last_page_id);
+  Decode(last_page, &values);
+  if (value > values.back()) {
+    auto delta = static_cast<uint64_t>(value - values.back());
+    if (last_page->GetDataSize() + VarintSize(delta) <= PostingPage::CAPACITY) {
+      PutVarint(last_page->GetEncodedRids() + last_page->GetDataSize(), delta);
+      last_page->SetDataSize(last_page->GetDataSize() + VarintSize(delta));
+      last_page->SetCount(last_page->GetCount() + 1);
+      buffer_pool_manager_->UnpinPage(last_page_id, true);
+      return true;
+    }
+    PostingPage *new_page;
+    try {
+      new_page = NewPage();
+    } catch (Exception &) {
+      buffer_pool_manager_->UnpinPage(last_page_id, false);
+      throw;
+    }
+    Encode(new_page, {value}, 0, 1);
+    last_page->SetNextPageId(new_page->GetPageId());
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    first_page = FetchPage(first_page_id);
+    first_page->SetLastPageId(new_page->GetPageId());
+    buffer_pool_manager_->UnpinPage(first_page_id, true);
+    buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(last_page_id, false);
+
+  page_id_t prev_page_id;
+  auto page = FindPage(first_page_id, value, &prev_page_id);
+  auto page_id = page->GetPageId();
+  values.clear();
+  Decode(page, &values);
+  auto it = std::lower_bound(values.begin(), values.end(), value);
+  if (it != values.end() && *it == value) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  values.insert(it, value);
+  if (EncodedSize(values, 0, values.size()) <= PostingPage::CAPACITY) {
+    Encode(page, values, 0, values.size());
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return true;
+  }
+
+  // Split the page in half. The first half stays, so the list still starts on the same page.
+  PostingPage *new_page;
+  try {
+    new_page = NewPage();
+  } catch (Exception &) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    throw;
+  }
+  auto middle = values.size() / 2;
+  Encode(new_page, values, middle, values.size());
+  new_page->SetNextPageId(page->GetNextPageId());
+  Encode(page, values, 0, middle);
+  page->SetNextPageId(new_page->GetPageId());
+  if (new_page->GetNextPageId() == INVALID_PAGE_ID) {
+    if (page_id == first_page_id) {
+      page->SetLastPageId(new_page->GetPageId());
+    } else {
+      first_page = FetchPage(first_page_id);
+      first_page->SetLastPageId(new_page->GetPageId());
+      buffer_pool_manager_->UnpinPage(first_page_id, true);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  return true;
+}
+
+bool PostingList::Remove(RID *reference, const RID &rid) {
+  auto value = rid.Get();
+  auto first_page_id = reference->GetPageId();
+  page_id_t prev_page_id;
+  auto page = FindPage(first_page_id, value, &prev_page_id);
+  auto page_id = page->GetPageId();
+  std::vector<int64_t> values;
+  Decode(page, &values);
+  auto it = std::lower_bound(values.begin(), values.end(), value);
+  if (it == values.end() || *it != value) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+  values.erase(it);
+  if (!values.empty()) {
+    Encode(page, values, 0, values.size());
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return true;
+  }
+
+  // The page is empty: unlink it.
+  auto next_page_id = page->GetNextPageId();
+  if (prev_page_id == INVALID_PAGE_ID) {
+    BUSTUB_ASSERT(next_page_id != INVALID_PAGE_ID, "A posting list keeps at least one RID.");
+    auto next_page = FetchPage(next_page_id);
+    next_page->SetLastPageId(page->GetLastPageId());
+    buffer_pool_manager_->UnpinPage(next_page_id, true);
+    *reference = MakeReference(next_page_id);
+  } else {
+    auto prev_page = FetchPage(prev_page_id);
+    prev_page->SetNextPageId(next_page_id);
+    buffer_pool_manager_->UnpinPage(prev_page_id, true);
+    if (next_page_id == INVALID_PAGE_ID) {
+      auto first_page = FetchPage(first_page_id);
+      first_page->SetLastPageId(prev_page_id);
+      buffer_pool_manager_->UnpinPage(first_page_id, true);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  buffer_pool_manager_->DeletePage(page_id);
+  return true;
+}
+
+bool PostingList::GetSingle(const RID &reference, RID *rid) {
+  auto page_id = reference.GetPageId();
+  auto page = FetchPage(page_id);
+  bool single = page->GetCount() == 1 && page->GetNextPageId() == INVALID_PAGE_ID;
+  if (single) {
+    *rid = RID(FirstRid(page));
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return single;
+}
+
+void PostingList::Free(const RID &reference) {
+  auto page_id = reference.GetPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<PostingPage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a posting page to free it.");
+    auto next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+PostingPage *PostingList::FetchPage(page_id_t page_id) {
+  auto page = reinterpret_cast<PostingPage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a posting page.");
+  }
+  return page;
+}
+
+PostingPage *PostingList::NewPage() {
+  page_id_t page_id;
+  auto page = reinterpret_cast<PostingPage *>(buffer_pool_manager_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a posting page.");
+  }
+  page->Init(page_id);
+  return page;
+}
+
+int64_t PostingList::FirstRid(PostingPage *page) {
+  int64_t value;
+  memcpy(&value, page->GetEncodedRids(), sizeof(int64_t));
+  return value;
+}
+
+void PostingList::Decode(PostingPage *page, std::vector<int64_t> *result) {
+  auto count = page->GetCount();
+  if (count == 0) {
+    return;
+  }
+  int64_t value = FirstRid(page);
+  result->push_back(value);
+  const char *in = page->GetEncodedRids() + sizeof(int64_t);
+  for (uint32_t i = 1; i < count; i++) {
+    uint64_t delta;
+    in = GetVarint(in, &delta);
+    value += static_cast<int64_t>(delta);
+    result->push_back(value);
+  }
+}
+
+uint32_t PostingList::EncodedSize(const std::vector<int64_t> &rids, size_t begin, size_t end) {
+  uint32_t size = sizeof(int64_t);
+  for (size_t i = begin + 1; i < end; i++) {
+    size += VarintSize(rids[i] - rids[i - 1]);
+  }
+  return size;
+}
+
+void PostingList::Encode(PostingPage *page, const std::vector<int64_t> &rids, size_t begin, size_t end) {
+  char *out = page->GetEncodedRids();
+  memcpy(out, &rids[begin], sizeof(int64_t));
+  out += sizeof(int64_t);
+  for (size_t i = begin + 1; i < end; i++) {
+    out = PutVarint(out, rids[i] - rids[i - 1]);
+  }
+  page->SetCount(static_cast<uint32_t>(end - begin));
+  page->SetDataSize(static_cast<uint32_t>(out - page->GetEncodedRids()));
+}
+
+PostingPage *PostingList::FindPage(page_id_t first_page_id, int64_t rid, page_id_t *prev_page_id) {
+  *prev_page_id = INVALID_PAGE_ID;
+  auto page = FetchPage(first_page_id);
+  while (page->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page = FetchPage(page->GetNextPageId());
+    if (FirstRid(next_page) > rid) {
+      buffer_pool_manager_->UnpinPage(next_page->GetPageId(), false);
+      break;
+    }
+    *prev_page_id = page->GetPageId();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+  }
+  return page;
+}
+
+}  // namespace bustub
@@ -0,0 +1,361 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree.cpp
+//
+// Identification: src/storage/index/varlen_b_plus_tree.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "storage/index/varlen_b_plus_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+VarlenBPlusTree::VarlenBPlusTree(std::string name, BufferPoolManager *buffer_pool_manager)
+    : index_name_(std::move(name)), buffer_pool_manager_(buffer_pool_manager) {}
+
+bool VarlenBPlusTree::IsEmpty() const {
+  root_latch_.RLock();
+  bool empty = root_page_id_ == INVALID_PAGE_ID;
+  root_latch_.RUnlock();
+  return empty;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+
+bool VarlenBPlusTree::GetValue(std::string_view key, std::vector<RID> *result) {
+  Page *page = FindLeafPage(key, false, false);
+  if (page == nullptr) {
+    return false;
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool found = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+  if (found) {
+    result->push_back(leaf->ValueAt(index));
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
+}
+
+/*
+ * Pages never change their type, so whether the next page is a leaf can be read before latching it.
+ */
+Page *VarlenBPlusTree::FindLeafPage(std::string_view key, bool left_most, bool exclusive) {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a B+ tree page.");
+  }
+  auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (exclusive && node->IsLeafPage()) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!node->IsLeafPage()) {
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = internal->ValueAt(left_most ? 0 : internal->ChildIndex(key));
+    Page *child = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a B+ tree page.");
+    }
+    auto child_node = reinterpret_cast<BPlusTreePage *>(child->GetData());
+    if (exclusive && child_node->IsLeafPage()) {
+      child->WLatch();
+    } else {
+      child->RLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    node = child_node;
+  }
+  return page;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+
+bool VarlenBPlusTree::Insert(std::string_view key, const RID &value) {
+  if (key.size() > MAX_KEY_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Key too long for the B+ tree: " + index_name_);
+  }
+  Page *page = FindLeafPage(key, false, true);
+  if (page != nullptr) {
+    auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int index = leaf->KeyIndex(key);
+    bool exists = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+    bool fits = !exists && leaf->HasRoom(key.size());
+    if (fits) {
+      leaf->InsertAt(index, key, value);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), fits);
+    if (exists || fits) {
+      return fits;
+    }
+  }
+  // The leaf is about to split, or there is no leaf yet.
+  return InsertPessimistic(key, value);
+}
+
+bool VarlenBPlusTree::InsertPessimistic(std::string_view key, const RID &value) {
+  root_latch_.WLock();
+  bool root_locked = true;
+  // The latched pages from the first one that cannot split on, and the pages split on the way back up.
+  std::vector<Page *> path;
+  std::vector<Page *> split;
+  try {
+    if (root_page_id_ == INVALID_PAGE_ID) {
+      Page *page = NewPage(IndexPageType::LEAF_PAGE);
+      reinterpret_cast<LeafPage *>(page->GetData())->InsertAt(0, key, value);
+      root_page_id_ = page->GetPageId();
+      UpdateRootPageId(1);
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      root_latch_.WUnlock();
+      return true;
+    }
+
+    page_id_t page_id = root_page_id_;
+    while (true) {
+      Page *page = FetchPage(page_id);
+      page->WLatch();
+      auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      bool safe = node->IsLeafPage() ? reinterpret_cast<LeafPage *>(node)->HasRoom(key.size())
+                                     : reinterpret_cast<InternalPage *>(node)->HasRoom(MAX_KEY_SIZE);
+      if (safe) {
+        ReleasePages(&path, false);
+        if (root_locked) {
+          root_latch_.WUnlock();
+          root_locked = false;
+        }
+      }
+      path.push_back(page);
+      if (node->IsLeafPage()) {
+        break;
+      }
+      auto internal = reinterpret_cast<InternalPage *>(node);
+      page_id = internal->ValueAt(internal->ChildIndex(key));
+    }
+
+    Page *leaf_page = path.back();
+    auto leaf = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    int index = leaf->KeyIndex(key);
+    if (index < leaf->GetSize() && leaf->KeyAt(index) == key) {
+      ReleasePages(&path, false);
+      if (root_locked) {
+        root_latch_.WUnlock();
+      }
+      return false;
+    }
+    if (leaf->HasRoom(key.size())) {
+      leaf->InsertAt(index, key, value);
+      ReleasePages(&path, true);
+      if (root_locked) {
+        root_latch_.WUnlock();
+      }
+      return true;
+    }
+
+    // Split the leaf, then post separators up the latched pages for as long as they split too.
+    path.pop_back();
+    split.push_back(leaf_page);
+    Page *right_page = NewPage(IndexPageType::LEAF_PAGE);
+    right_page->WLatch();
+    split.push_back(right_page);
+    auto right = reinterpret_cast<LeafPage *>(right_page->GetData());
+    int split_index = leaf->SplitIndex();
+    for (int i = split_index; i < leaf->GetSize(); i++) {
+      right->InsertAt(i - split_index, leaf->KeyAt(i), leaf->ValueAt(i));
+    }
+    leaf->Truncate(split_index);
+    right->SetNextPageId(leaf->GetNextPageId());
+    leaf->SetNextPageId(right_page->GetPageId());
+    LeafPage *target = key < right->KeyAt(0) ? leaf : right;
+    target->InsertAt(target->KeyIndex(key), key, value);
+
+    std::string separator = ShortestSeparator(leaf->KeyAt(leaf->GetSize() - 1), right->KeyAt(0));
+    page_id_t left_page_id = leaf_page->GetPageId();
+    page_id_t right_page_id = right_page->GetPageId();
+    while (true) {
+      if (path.empty()) {
+        // The root split, and no page above it was safe, so root_latch_ is still held.
+        BUSTUB_ASSERT(root_locked, "The root split without root_latch_.");
+        Page *root_page = NewPage(IndexPageType::INTERNAL_PAGE);
+        auto root = reinterpret_cast<InternalPage *>(root_page->GetData());
+        root->InsertAt(0, std::string_view(), left_page_id);
+        root->InsertAt(1, separator, right_page_id);
+        root_page_id_ = root_page->GetPageId();
+        UpdateRootPageId(0);
+        buffer_pool_manager_->UnpinPage(root_page->GetPageId(), true);
+        break;
+      }
+      auto parent = reinterpret_cast<InternalPage *>(path.back()->GetData());
+      if (parent->HasRoom(separator.size())) {
+        parent->InsertAt(parent->ValueIndex(left_page_id) + 1, separator, right_page_id);
+        break;
+      }
+      std::string middle_key;
+      Page *sibling_page = SplitInternal(parent, &middle_key);
+      split.push_back(path.back());
+      split.push_back(sibling_page);
+      path.pop_back();
+      auto into = separator < middle_key ? parent : reinterpret_cast<InternalPage *>(sibling_page->GetData());
+      into->InsertAt(into->ValueIndex(left_page_id) + 1, separator, right_page_id);
+      separator = std::move(middle_key);
+      left_page_id = parent->GetPageId();
+      right_page_id = sibling_page->GetPageId();
+    }
+  } catch (...) {
+    ReleasePages(&path, true);
+    ReleasePages(&split, true);
+    if (root_locked) {
+      root_latch_.WUnlock();
+    }
+    throw;
+  }
+  ReleasePages(&path, true);
+  ReleasePages(&split, true);
+  if (root_locked) {
+    root_latch_.WUnlock();
+  }
+  return true;
+}
+
+Page *VarlenBPlusTree::SplitInternal(InternalPage *node, std::string *middle_key) {
+  Page *sibling_page = NewPage(IndexPageType::INTERNAL_PAGE);
+  sibling_page->WLatch();
+  auto sibling = reinterpret_cast<InternalPage *>(sibling_page->GetData());
+  int split_index = node->SplitIndex();
+  *middle_key = std::string(node->KeyAt(split_index));
+  sibling->InsertAt(0, std::string_view(), node->ValueAt(split_index));
+  for (int i = split_index + 1; i < node->GetSize(); i++) {
+    sibling->InsertAt(i - split_index, node->KeyAt(i), node->ValueAt(i));
+  }
+  node->Truncate(split_index);
+  return sibling_page;
+}
+
+std::string VarlenBPlusTree::ShortestSeparator(std::string_view left, std::string_view right) {
+  size_t prefix = 0;
+  while (prefix < left.size() && left[prefix] == right[prefix]) {
+    prefix++;
+  }
+  return std::string(right.substr(0, prefix + 1));
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+
+bool VarlenBPlusTree::Remove(std::string_view key) {
+  Page *page = FindLeafPage(key, false, true);
+  if (page == nullptr) {
+    return false;
+  }
+  auto leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = leaf->KeyIndex(key);
+  bool found = index < leaf->GetSize() && leaf->KeyAt(index) == key;
+  if (found) {
+    leaf->RemoveAt(index);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), found);
+  return found;
+}
+
+/*****************************************************************************
+ * INDEX ITERATOR
+ *****************************************************************************/
+
+VarlenIndexIterator VarlenBPlusTree::begin() {
+  Page *page = FindLeafPage(std::string_view(), true, false);
+  if (page == nullptr) {
+    return end();
+  }
+  return VarlenIndexIterator(buffer_pool_manager_, page, 0);
+}
+
+VarlenIndexIterator VarlenBPlusTree::Begin(std::string_view key) {
+  Page *page = FindLeafPage(key, false, false);
+  if (page == nullptr) {
+    return end();
+  }
+  int index = reinterpret_cast<LeafPage *>(page->GetData())->KeyIndex(key);
+  return VarlenIndexIterator(buffer_pool_manager_, page, index);
+}
+
+VarlenIndexIterator VarlenBPlusTree::end() { return VarlenIndexIterator(); }
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+
+Page *VarlenBPlusTree::NewPage(IndexPageType page_type) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't allocate a B+ tree page.");
+  }
+  if (page_type == IndexPageType::LEAF_PAGE) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, page_type);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, page_type);
+  }
+  return page;
+}
+
+Page *VarlenBPlusTree::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't fetch a B+ tree page.");
+  }
+  return page;
+}
+
+void VarlenBPlusTree::ReleasePages(std::vector<Page *> *pages, bool dirty) {
+  for (Page *page : *pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+  }
+  pages->clear();
+}
+
+/*
+ * Update/Insert root page id in header page, see BPlusTree::UpdateRootPageId.
+ */
+void VarlenBPlusTree::UpdateRootPageId(int insert_record) {
+  auto header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
+  header_page->WLatch();
+  if (insert_record != 0) {
+    header_page->InsertRecord(index_name_, root_page_id_);
+  } else {
+    header_page->UpdateRecord(index_name_, root_page_id_);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+}  // namespace bustub
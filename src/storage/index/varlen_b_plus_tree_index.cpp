@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_b_plus_tree_index.cpp
+//
+// Identification: src/storage/index/varlen_b_plus_tree_index.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <utility>
+
+#include "storage/index/normalized_key.h"
+#include "storage/index/varlen_b_plus_tree_index.h"
+
+namespace bustub {
+
+VarlenBPlusTreeIndex::VarlenBPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+    : Index(metadata), container_(metadata->GetName(), buffer_pool_manager) {
+  if (!metadata->GetIncludeAttrs().empty()) {
+    throw NotImplementedException("Variable-length key indexes cannot include columns: " + metadata->GetName());
+  }
+}
+
+void VarlenBPlusTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(EntryKey(key, rid), rid);
+}
+
+void VarlenBPlusTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(EntryKey(key, rid));
+}
+
+void VarlenBPlusTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  std::string index_key = EncodeKey(key);
+  if (GetMetadata()->IsUnique()) {
+    container_.GetValue(index_key, result);
+    return;
+  }
+  for (auto iterator = container_.Begin(index_key); !iterator.isEnd() && KeyPart((*iterator).first) == index_key;
+       ++iterator) {
+    result->push_back((*iterator).second);
+  }
+}
+
+/*
+ * The tree only iterates forwards, so a backward scan collects the range forwards and reverses it.
+ */
+void VarlenBPlusTreeIndex::ScanRange(const Tuple *low_key, bool low_inclusive, const Tuple *high_key,
+                                     bool high_inclusive, ScanDirection direction, size_t limit,
+                                     std::vector<RID> *result, Transaction *transaction) {
+  std::string low = low_key == nullptr ? std::string() : EncodeKey(*low_key);
+  std::string high = high_key == nullptr ? std::string() : EncodeKey(*high_key);
+  size_t forward_limit = direction == ScanDirection::FORWARD ? limit : SIZE_MAX;
+  std::vector<RID> scanned;
+  for (auto iterator = container_.Begin(low); !iterator.isEnd() && scanned.size() < forward_limit; ++iterator) {
+    std::string_view key = KeyPart((*iterator).first);
+    if (low_key != nullptr && !low_inclusive && key == low) {
+      continue;
+    }
+    if (high_key != nullptr && (key > high || (key == high && !high_inclusive))) {
+      break;
+    }
+    scanned.push_back((*iterator).second);
+  }
+  if (direction == ScanDirection::BACKWARD) {
+    std::reverse(scanned.begin(), scanned.end());
+    scanned.resize(std::min(scanned.size(), limit));
+  }
+  result->insert(result->end(), scanned.begin(), scanned.end());
+}
+
+void VarlenBPlusTreeIndex::BulkLoad(TableHeap *table_heap, const Schema &tuple_schema, Transaction *transaction) {
+  std::vector<std::pair<std::string, RID>> entries;
+  for (auto iterator = table_heap->Begin(transaction); iterator != table_heap->End(); ++iterator) {
+    // Long keys are likely on columns the table stores out of line.
+    Tuple tuple = *iterator;
+    if (!table_heap->Detoast(&tuple, transaction)) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Couldn't read a value stored out of line to index: " + GetName());
+    }
+    Tuple key = tuple.KeyFromTuple(tuple_schema, *GetKeySchema(), GetKeyAttrs());
+    entries.emplace_back(EntryKey(key, iterator->GetRid()), iterator->GetRid());
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+  // The keys of a non-unique index end with the RID, so only rows of a unique index can share a key.
+  if (std::adjacent_find(entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.first == rhs.first;
+      }) != entries.end()) {
+    throw Exception("Duplicate key in the bulk load of the unique index " + GetName() + ".");
+  }
+  for (const auto &[index_key, rid] : entries) {
+    container_.Insert(index_key, rid);
+  }
+}
+
+std::string VarlenBPlusTreeIndex::EncodeKey(const Tuple &key) const {
+  std::string index_key;
+  auto put = [&index_key](uint8_t byte) {
+    index_key.push_back(static_cast<char>(byte));
+    return true;
+  };
+  for (uint32_t i = 0; i < GetKeySchema()->GetColumnCount(); i++) {
+    KeyNormalizer::Append(key.GetValue(GetKeySchema(), i), put);
+  }
+  return index_key;
+}
+
+std::string VarlenBPlusTreeIndex::EntryKey(const Tuple &key, RID rid) const {
+  std::string index_key = EncodeKey(key);
+  if (!GetMetadata()->IsUnique()) {
+    auto put = [&index_key](uint8_t byte) {
+      index_key.push_back(static_cast<char>(byte));
+      return true;
+    };
+    KeyNormalizer::AppendUnsigned(static_cast<uint32_t>(rid.GetPageId()), put);
+    KeyNormalizer::AppendUnsigned(rid.GetSlotNum(), put);
+  }
+  return index_key;
+}
+
+std::string_view VarlenBPlusTreeIndex::KeyPart(std::string_view entry_key) const {
+  if (GetMetadata()->IsUnique()) {
+    return entry_key;
+  }
+  return entry_key.substr(0, entry_key.size() - RID_SUFFIX_SIZE);
+}
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+/**
+ * varlen_index_iterator.cpp
+ */
+#include <cassert>
+
+#include "storage/index/varlen_index_iterator.h"
+
+namespace bustub {
+
+VarlenIndexIterator::VarlenIndexIterator(BufferPoolManager *buffer_pool_manager, Page *leaf, int index)
+    : buffer_pool_manager_(buffer_pool_manager), page_(leaf), page_id_(leaf->GetPageId()), index_(index) {
+  SkipExhaustedLeaves();
+}
+
+VarlenIndexIterator::VarlenIndexIterator(VarlenIndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page_(other.page_),
+      page_id_(other.page_id_),
+      index_(other.index_) {
+  other.page_ = nullptr;
+  other.page_id_ = INVALID_PAGE_ID;
+  other.index_ = 0;
+}
+
+VarlenIndexIterator &VarlenIndexIterator::operator=(VarlenIndexIterator &&other) noexcept {
+  if (this != &other) {
+    Release();
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    page_ = other.page_;
+    page_id_ = other.page_id_;
+    index_ = other.index_;
+    other.page_ = nullptr;
+    other.page_id_ = INVALID_PAGE_ID;
+    other.index_ = 0;
+  }
+  return *this;
+}
+
+VarlenIndexIterator::~VarlenIndexIterator() { Release(); }
+
+std::pair<std::string_view, RID> VarlenIndexIterator::operator*() const {
+  assert(page_ != nullptr);
+  return {GetLeaf()->KeyAt(index_), GetLeaf()->ValueAt(index_)};
+}
+
+VarlenIndexIterator &VarlenIndexIterator::operator++() {
+  index_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+void VarlenIndexIterator::SkipExhaustedLeaves() {
+  while (page_ != nullptr && index_ >= GetLeaf()->GetSize()) {
+    auto next_page_id = GetLeaf()->GetNextPageId();
+    // Pin the next leaf before letting go of this one.
+    Page *next_page = next_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(next_page_id);
+    Release();
+    if (next_page == nullptr) {
+      return;
+    }
+    next_page->RLatch();
+    page_ = next_page;
+    page_id_ = next_page_id;
+    index_ = 0;
+  }
+}
+
+void VarlenIndexIterator::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id_, false);
+  }
+  page_ = nullptr;
+  page_id_ = INVALID_PAGE_ID;
+  index_ = 0;
+}
+
+}  // namespace bustub
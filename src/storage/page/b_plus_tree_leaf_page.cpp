@@ -9,10 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/simd_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -24,46 +26,125 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  SetMaxSize(max_size);
+}
 
 /**
  * Helper methods to set/get next page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return INVALID_PAGE_ID; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+/**
+ * Helper methods to set/get prev page id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+/**
+ * Helper methods to set/get the high key, only meaningful if there is a next page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  int left = 0;
+  int right = GetSize();
+  if constexpr (IsIntegerComparator<KeyComparator>::value) {
+    // Narrow the search down to a few cache lines, then count the keys less than key in them all at once.
+    while (right - left > SIMD_SEARCH_WINDOW) {
+      int mid = left + (right - left) / 2;
+      if (array[mid].first.value_ < key.value_) {
+        left = mid + 1;
+      } else {
+        right = mid;
+      }
+    }
+    return left + SimdCountLess(reinterpret_cast<const char *>(&array[left].first.value_), sizeof(MappingType),
+                                right - left, key.value_);
+  }
+  if constexpr (IsBytewiseComparator<KeyComparator>::value) {
+    if (right > 1) {
+      // The keys are sorted, so they all share the prefix of the first and the last one. The search key is compared
+      // with that prefix once, and the probes only compare the bytes after it.
+      size_t prefix = comparator.CommonPrefixLength(array[0].first, array[right - 1].first);
+      int result = comparator.ComparePrefix(key, array[0].first, prefix);
+      if (result != 0) {
+        return result < 0 ? 0 : right;
+      }
+      while (left < right) {
+        int mid = left + (right - left) / 2;
+        if (comparator.CompareFrom(array[mid].first, key, prefix) < 0) {
+          left = mid + 1;
+        } else {
+          right = mid;
+        }
+      }
+      return left;
+    }
+  }
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (comparator(array[mid].first, key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return array[index].first; }
 
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array[0];
+const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) { return array[index]; }
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const { return array[index].second; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array[index].second = value; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RunLength(int index, const KeyComparator &comparator) const {
+  int end = index;
+  while (end < GetSize() && comparator(array[end].first, array[index].first) == 0) {
+    end++;
+  }
+  return end - index;
 }
 
 /*****************************************************************************
@@ -75,7 +156,25 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(array[index].first, key) == 0) {
+    return GetSize();
+  }
+  memmove(static_cast<void *>(array + index + 1), static_cast<void *>(array + index),
+          (GetSize() - index) * sizeof(MappingType));
+  array[index].first = key;
+  array[index].second = value;
+  IncreaseSize(1);
+  return GetSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAt(int index, const KeyType &key, const ValueType &value) {
+  memmove(static_cast<void *>(array + index + 1), static_cast<void *>(array + index),
+          (GetSize() - index) * sizeof(MappingType));
+  array[index].first = key;
+  array[index].second = value;
+  IncreaseSize(1);
 }
 
 /*****************************************************************************
@@ -83,15 +182,44 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  *****************************************************************************/
 /*
  * Remove half of key & value pairs from this page to "recipient" page
+ * The pairs of a key stay together: the page is split between the two keys nearest its middle.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient, const KeyComparator &comparator) {
+  int middle = GetSize() / 2;
+  int keep = middle;
+  for (int distance = 0; distance < GetSize(); distance++) {
+    if (middle - distance > 0 && comparator(array[middle - distance - 1].first, array[middle - distance].first) != 0) {
+      keep = middle - distance;
+      break;
+    }
+    if (middle + distance < GetSize() &&
+        comparator(array[middle + distance - 1].first, array[middle + distance].first) != 0) {
+      keep = middle + distance;
+      break;
+    }
+  }
+  recipient->CopyNFrom(array + keep, GetSize() - keep);
+  SetSize(keep);
+}
 
 /*
  * Copy starting from items, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
+  memcpy(static_cast<void *>(array + GetSize()), static_cast<void *>(items), size * sizeof(MappingType));
+  IncreaseSize(size);
+}
+
+/*
+ * Fill an empty page with {size} entries starting from {items}, which must be sorted by key, for bulk loading.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::PopulateFrom(const MappingType *items, int size) {
+  memcpy(static_cast<void *>(array), static_cast<const void *>(items), size * sizeof(MappingType));
+  SetSize(size);
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -103,7 +231,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  return false;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array[index].first, key) != 0) {
+    return false;
+  }
+  *value = array[index].second;
+  return true;
 }
 
 /*****************************************************************************
@@ -116,7 +249,23 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  * @return   page size after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array[index].first, key) != 0) {
+    return GetSize();
+  }
+  memmove(static_cast<void *>(array + index), static_cast<void *>(array + index + 1),
+          (GetSize() - index - 1) * sizeof(MappingType));
+  IncreaseSize(-1);
+  return GetSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index, int count) {
+  memmove(static_cast<void *>(array + index), static_cast<void *>(array + index + count),
+          (GetSize() - index - count) * sizeof(MappingType));
+  IncreaseSize(-count);
+}
 
 /*****************************************************************************
  * MERGE
@@ -126,38 +275,62 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  * to update the next_page id in the sibling page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  recipient->CopyNFrom(array, GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
  *****************************************************************************/
 /*
  * Remove the first key & value pair from this page to "recipient" page.
+ * In a non-unique tree, all the pairs of the first key.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
-
-/*
- * Copy the item into the end of my item list. (Append item to my array)
- */
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient, const KeyComparator &comparator) {
+  int count = RunLength(0, comparator);
+  recipient->CopyNFrom(array, count);
+  RemoveAt(0, count);
+}
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
+ * In a non-unique tree, all the pairs of the last key.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient, const KeyComparator &comparator) {
+  int start = GetSize() - 1;
+  while (start > 0 && comparator(array[start - 1].first, array[GetSize() - 1].first) == 0) {
+    start--;
+  }
+  recipient->CopyFirstNFrom(array + start, GetSize() - start);
+  SetSize(start);
+}
 
 /*
- * Insert item at the front of my items. Move items accordingly.
+ * Insert {size} items at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstNFrom(MappingType *items, int size) {
+  memmove(static_cast<void *>(array + size), static_cast<void *>(array), GetSize() * sizeof(MappingType));
+  memcpy(static_cast<void *>(array), static_cast<void *>(items), size * sizeof(MappingType));
+  IncreaseSize(size);
+}
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<NormalizedKey<4>, RID, NormalizedComparator<4>>;
+template class BPlusTreeLeafPage<NormalizedKey<8>, RID, NormalizedComparator<8>>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+template class BPlusTreeLeafPage<IntegerKey<int32_t>, RID, IntegerComparator<int32_t>>;
+template class BPlusTreeLeafPage<IntegerKey<int64_t>, RID, IntegerComparator<int64_t>>;
 }  // namespace bustub
@@ -0,0 +1,207 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_slotted_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_slotted_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_slotted_page.h"
+
+namespace bustub {
+
+static_assert(PAGE_SIZE <= UINT16_MAX, "Key offsets of slotted B+ tree pages are 16 bits.");
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new slotted page
+ * Including set page type, set current size to zero, set page id, set next page id and empty the key heap
+ */
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::Init(page_id_t page_id, IndexPageType page_type) {
+  SetPageType(page_type);
+  SetSize(0);
+  SetMaxSize(0);
+  SetPageId(page_id);
+  SetParentPageId(INVALID_PAGE_ID);
+  SetNextPageId(INVALID_PAGE_ID);
+  heap_offset_ = PAGE_SIZE;
+}
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_SLOTTED_PAGE_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename ValueType>
+std::string_view B_PLUS_TREE_SLOTTED_PAGE_TYPE::KeyAt(int index) const {
+  const Slot &slot = GetSlots()[index];
+  return std::string_view(reinterpret_cast<const char *>(this) + slot.key_offset_, slot.key_length_);
+}
+
+template <typename ValueType>
+ValueType B_PLUS_TREE_SLOTTED_PAGE_TYPE::ValueAt(int index) const {
+  return GetSlots()[index].value_;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  GetSlots()[index].value_ = value;
+}
+
+template <typename ValueType>
+uint32_t B_PLUS_TREE_SLOTTED_PAGE_TYPE::GetFreeSpace() const {
+  return heap_offset_ - HEADER_SIZE - GetSize() * sizeof(Slot);
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+
+/**
+ * Binary search for the first slot whose key is not less than key. std::string_view compares like memcmp.
+ */
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::KeyIndex(std::string_view key) const {
+  int left = 0;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (KeyAt(mid) < key) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+/**
+ * Binary search for the last slot whose key is not greater than key, skipping the empty key of the first slot.
+ */
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::ChildIndex(std::string_view key) const {
+  int left = 1;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (KeyAt(mid) <= key) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left - 1;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  const Slot *slots = GetSlots();
+  for (int i = 0; i < GetSize(); i++) {
+    if (slots[i].value_ == value) {
+      return i;
+    }
+  }
+  return GetSize();
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::InsertAt(int index, std::string_view key, const ValueType &value) {
+  BUSTUB_ASSERT(HasRoom(key.size()), "No room for the key in the slotted page.");
+  heap_offset_ -= key.size();
+  memcpy(reinterpret_cast<char *>(this) + heap_offset_, key.data(), key.size());
+  Slot *slots = GetSlots();
+  memmove(static_cast<void *>(slots + index + 1), static_cast<void *>(slots + index),
+          (GetSize() - index) * sizeof(Slot));
+  slots[index].key_offset_ = static_cast<uint16_t>(heap_offset_);
+  slots[index].key_length_ = static_cast<uint16_t>(key.size());
+  slots[index].value_ = value;
+  IncreaseSize(1);
+}
+
+/**
+ * The keys stored below the removed one move up by its length, so that the heap stays compact.
+ */
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::RemoveAt(int index) {
+  Slot *slots = GetSlots();
+  uint32_t offset = slots[index].key_offset_;
+  uint32_t length = slots[index].key_length_;
+  char *data = reinterpret_cast<char *>(this);
+  if (length > 0) {
+    memmove(data + heap_offset_ + length, data + heap_offset_, offset - heap_offset_);
+    for (int i = 0; i < GetSize(); i++) {
+      if (slots[i].key_length_ > 0 && slots[i].key_offset_ < offset) {
+        slots[i].key_offset_ += length;
+      }
+    }
+    heap_offset_ += length;
+  }
+  memmove(static_cast<void *>(slots + index), static_cast<void *>(slots + index + 1),
+          (GetSize() - index - 1) * sizeof(Slot));
+  IncreaseSize(-1);
+}
+
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+
+template <typename ValueType>
+int B_PLUS_TREE_SLOTTED_PAGE_TYPE::SplitIndex() const {
+  const Slot *slots = GetSlots();
+  uint32_t half = GetUsedSpace() / 2;
+  uint32_t left = 0;
+  int index = 0;
+  while (index < GetSize() - 1 && left < half) {
+    left += GetRequiredSpace(slots[index].key_length_);
+    index++;
+  }
+  return index > 0 ? index : 1;
+}
+
+/**
+ * The keys to keep are copied out and written back from the end of the page, in slot order.
+ */
+template <typename ValueType>
+void B_PLUS_TREE_SLOTTED_PAGE_TYPE::Truncate(int size) {
+  char keys[PAGE_SIZE];
+  char *data = reinterpret_cast<char *>(this);
+  Slot *slots = GetSlots();
+  uint32_t keys_size = 0;
+  for (int i = 0; i < size; i++) {
+    memcpy(keys + keys_size, data + slots[i].key_offset_, slots[i].key_length_);
+    keys_size += slots[i].key_length_;
+  }
+  heap_offset_ = PAGE_SIZE - keys_size;
+  memcpy(data + heap_offset_, keys, keys_size);
+  uint32_t offset = heap_offset_;
+  for (int i = 0; i < size; i++) {
+    slots[i].key_offset_ = static_cast<uint16_t>(offset);
+    offset += slots[i].key_length_;
+  }
+  SetSize(size);
+}
+
+template class BPlusTreeSlottedPage<RID>;
+template class BPlusTreeSlottedPage<page_id_t>;
+
+}  // namespace bustub
@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  // Set the page ID.
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetNextPageId(INVALID_PAGE_ID);
+  SetEntryCount(0);
+}
+
+uint32_t FreeSpaceMapPage::Append(page_id_t table_page_id, uint8_t category) {
+  BUSTUB_ASSERT(!IsFull(), "Cannot append to a full free space map page.");
+  uint32_t slot_num = GetEntryCount();
+  memcpy(GetData() + OFFSET_ENTRIES + sizeof(page_id_t) * slot_num, &table_page_id, sizeof(page_id_t));
+  SetCategory(slot_num, category);
+  SetEntryCount(slot_num + 1);
+  return slot_num;
+}
+
+uint32_t FreeSpaceMapPage::FindSlot(uint32_t required_space) {
+  uint32_t entry_count = GetEntryCount();
+  // Round up: only a category at least this large guarantees enough space.
+  uint32_t min_category = (required_space + CATEGORY_SIZE - 1) / CATEGORY_SIZE;
+  if (min_category > UINT8_MAX) {
+    return entry_count;
+  }
+  auto categories = reinterpret_cast<const uint8_t *>(GetData() + OFFSET_CATEGORIES);
+  for (uint32_t i = 0; i < entry_count; i++) {
+    if (categories[i] >= min_category) {
+      return i;
+    }
+  }
+  return entry_count;
+}
+
+}  // namespace bustub
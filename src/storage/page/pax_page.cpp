@@ -0,0 +1,360 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pax_page.cpp
+//
+// Identification: src/storage/page/pax_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/pax_page.h"
+
+#include <vector>
+
+namespace bustub {
+
+uint32_t PaxPage::ComputeLayout(const Schema &schema, std::vector<PaxColumn> *columns, uint32_t *capacity) {
+  // The null bitmap of the tuples gets a minipage of its own behind the ones of the columns.
+  uint32_t bitmap_size = schema.GetNullBitmapSize();
+  BUSTUB_ASSERT(bitmap_size <= UINT8_MAX, "The schema has too many columns for a PAX page.");
+  uint32_t column_count = schema.GetColumnCount() + (bitmap_size > 0 ? 1 : 0);
+  // Every row takes its state, one entry in every minipage and the estimated data of its VARCHAR values.
+  uint32_t row_size = sizeof(uint8_t) + bitmap_size;
+  for (const auto &col : schema.GetColumns()) {
+    row_size += col.IsInlined() ? col.GetFixedLength() : sizeof(uint32_t) + sizeof(uint32_t) + VARCHAR_ESTIMATE;
+  }
+  size_t header_size = OFFSET_COLUMNS + sizeof(PaxColumn) * column_count;
+  // Leave room for aligning every minipage.
+  size_t reserved = header_size + MINIPAGE_ALIGNMENT * column_count;
+  BUSTUB_ASSERT(reserved + row_size <= PAGE_SIZE, "The schema has too many columns for a PAX page.");
+  *capacity = static_cast<uint32_t>((PAGE_SIZE - reserved) / row_size);
+
+  // The row states come first, then the minipages in column order.
+  size_t offset = header_size + *capacity;
+  for (uint32_t i = 0; i < column_count; i++) {
+    offset = (offset + MINIPAGE_ALIGNMENT - 1) / MINIPAGE_ALIGNMENT * MINIPAGE_ALIGNMENT;
+    PaxColumn column;
+    if (i < schema.GetColumnCount()) {
+      const auto &col = schema.GetColumn(i);
+      auto width = static_cast<uint8_t>(col.IsInlined() ? col.GetFixedLength() : sizeof(uint32_t));
+      column = PaxColumn{static_cast<uint32_t>(offset), static_cast<uint16_t>(col.GetOffset()), width,
+                         static_cast<uint8_t>(col.GetType())};
+    } else {
+      // The bitmap is copied in and out like a fixed-length column of an invalid type.
+      column = PaxColumn{static_cast<uint32_t>(offset), static_cast<uint16_t>(schema.GetNullBitmapOffset()),
+                         static_cast<uint8_t>(bitmap_size), static_cast<uint8_t>(TypeId::INVALID)};
+    }
+    if (columns != nullptr) {
+      columns->push_back(column);
+    }
+    offset += column.width_ * *capacity;
+  }
+  return static_cast<uint32_t>(offset);
+}
+
+uint32_t PaxPage::GetMaxTupleSize(const Schema &schema) {
+  uint32_t capacity;
+  uint32_t minipages_end = ComputeLayout(schema, nullptr, &capacity);
+  return schema.GetLength() + (PAGE_SIZE - minipages_end);
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_page_id, const Schema &schema, LogManager *log_manager,
+                   Transaction *txn) {
+  // Set the page ID.
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  // Log that we are creating a new page.
+  if (enable_logging) {
+    LogRecord log_record =
+        LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::NEWPAGE, prev_page_id, page_id);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  // Set the previous and next page IDs.
+  SetPrevPageId(prev_page_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetFreeSpacePointer(PAGE_SIZE);
+  SetTupleCount(0);
+  SetFsmLocation(INVALID_PAGE_ID, 0);
+  uint32_t layout_tag = LAYOUT_TAG;
+  memcpy(GetData() + OFFSET_LAYOUT_TAG, &layout_tag, sizeof(uint32_t));
+
+  // Lay out the minipages.
+  std::vector<PaxColumn> columns;
+  uint32_t capacity;
+  ComputeLayout(schema, &columns, &capacity);
+  auto column_count = static_cast<uint32_t>(columns.size());
+  uint32_t inlined_length = schema.GetLength();
+  memcpy(GetData() + OFFSET_CAPACITY, &capacity, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_INLINED_LENGTH, &inlined_length, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_COLUMNS, columns.data(), sizeof(PaxColumn) * column_count);
+}
+
+uint32_t PaxPage::GetMinipagesEnd() {
+  auto last_column = GetColumn(GetColumnCount() - 1);
+  return last_column->minipage_offset_ + last_column->width_ * GetCapacity();
+}
+
+bool PaxPage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
+                          LogManager *log_manager) {
+  return InsertTuples(&tuple, 1, rid, txn, lock_manager, log_manager) == 1;
+}
+
+uint32_t PaxPage::InsertTuples(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn,
+                               LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t inserted = 0;
+  while (inserted < count && PlaceTuple(tuples[inserted], &rids[inserted])) {
+    inserted++;
+  }
+
+  // Write one log record for the whole batch; a single tuple gets the usual insert record.
+  if (enable_logging && inserted > 0) {
+    for (uint32_t i = 0; i < inserted; i++) {
+      BUSTUB_ASSERT(!txn->IsSharedLocked(rids[i]) && !txn->IsExclusiveLocked(rids[i]),
+                    "A new tuple should not be locked.");
+      bool locked = lock_manager->LockExclusive(txn, rids[i]);
+      BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    }
+    LogRecord log_record =
+        inserted == 1
+            ? LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, rids[0], tuples[0])
+            : LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BULKINSERT,
+                        std::vector<RID>(rids, rids + inserted), std::vector<Tuple>(tuples, tuples + inserted));
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return inserted;
+}
+
+bool PaxPage::PlaceTuple(const Tuple &tuple, RID *rid) {
+  BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
+  uint32_t slot_num = GetTupleCount();
+  if (slot_num == GetCapacity()) {
+    return false;
+  }
+
+  // The VARCHAR values have to fit into the free space.
+  uint32_t column_count = GetColumnCount();
+  uint32_t varlen_size = 0;
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto column = GetColumn(i);
+    if (static_cast<TypeId>(column->type_) == TypeId::VARCHAR) {
+      auto varlen_offset = *reinterpret_cast<const uint32_t *>(tuple.data_ + column->tuple_offset_);
+      varlen_size += GetVarlenSize(tuple.data_ + varlen_offset);
+    }
+  }
+  if (GetFreeSpacePointer() - GetMinipagesEnd() < varlen_size) {
+    return false;
+  }
+
+  // Scatter the columns into their minipages.
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto column = GetColumn(i);
+    char *entry = GetData() + column->minipage_offset_ + column->width_ * slot_num;
+    if (static_cast<TypeId>(column->type_) == TypeId::VARCHAR) {
+      auto varlen = tuple.data_ + *reinterpret_cast<const uint32_t *>(tuple.data_ + column->tuple_offset_);
+      uint32_t size = GetVarlenSize(varlen);
+      SetFreeSpacePointer(GetFreeSpacePointer() - size);
+      memcpy(GetData() + GetFreeSpacePointer(), varlen, size);
+      uint32_t offset = GetFreeSpacePointer();
+      memcpy(entry, &offset, sizeof(uint32_t));
+    } else {
+      memcpy(entry, tuple.data_ + column->tuple_offset_, column->width_);
+    }
+  }
+  SetRowState(slot_num, ROW_LIVE);
+  SetTupleCount(slot_num + 1);
+  rid->Set(GetTablePageId(), slot_num);
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the tuple does not exist or is already deleted, abort the transaction.
+  if (!IsLive(slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  if (enable_logging) {
+    // Acquire an exclusive lock, upgrading from a shared lock if necessary.
+    if (txn->IsSharedLocked(rid)) {
+      if (!lock_manager->LockUpgrade(txn, rid)) {
+        return false;
+      }
+    } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
+      return false;
+    }
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::MARKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  SetRowState(slot_num, ROW_DELETED);
+  return true;
+}
+
+bool PaxPage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
+                          LockManager *lock_manager, LogManager *log_manager) {
+  return false;
+}
+
+void PaxPage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
+    // We need to copy out the deleted tuple for undo purposes.
+    Tuple delete_tuple;
+    CopyTuple(slot_num, &delete_tuple);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::APPLYDELETE, rid, delete_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  SetRowState(slot_num, ROW_EMPTY);
+}
+
+void PaxPage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+  // Log the rollback.
+  if (enable_logging) {
+    BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own an exclusive lock on the RID.");
+    Tuple dummy_tuple;
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ROLLBACKDELETE, rid, dummy_tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "We can't have more slots than tuples.");
+  if (GetRowState(slot_num) == ROW_DELETED) {
+    SetRowState(slot_num, ROW_LIVE);
+  }
+}
+
+bool PaxPage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+  uint32_t slot_num = rid.GetSlotNum();
+  // If the tuple does not exist or is deleted, abort the transaction.
+  if (!IsLive(slot_num)) {
+    if (enable_logging) {
+      txn->SetState(TransactionState::ABORTED);
+    }
+    return false;
+  }
+
+  // Otherwise we have a valid tuple, try to acquire at least a shared lock.
+  if (enable_logging) {
+    if (!txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) && !lock_manager->LockShared(txn, rid)) {
+      return false;
+    }
+  }
+
+  CopyTuple(slot_num, tuple);
+  return true;
+}
+
+void PaxPage::CopyTuple(uint32_t slot_num, Tuple *tuple) {
+  // Size the tuple: the inlined part, then the VARCHAR values in column order.
+  uint32_t column_count = GetColumnCount();
+  uint32_t tuple_size = GetInlinedLength();
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto column = GetColumn(i);
+    if (static_cast<TypeId>(column->type_) == TypeId::VARCHAR) {
+      auto offset = *reinterpret_cast<uint32_t *>(GetData() + column->minipage_offset_ + column->width_ * slot_num);
+      tuple_size += GetVarlenSize(GetData() + offset);
+    }
+  }
+
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->size_ = tuple_size;
+  tuple->data_ = new char[tuple_size];
+  memset(tuple->data_, 0, tuple_size);
+  tuple->rid_.Set(GetTablePageId(), slot_num);
+  tuple->allocated_ = true;
+
+  // Gather the columns from their minipages.
+  uint32_t varlen_offset = GetInlinedLength();
+  for (uint32_t i = 0; i < column_count; i++) {
+    auto column = GetColumn(i);
+    const char *entry = GetData() + column->minipage_offset_ + column->width_ * slot_num;
+    if (static_cast<TypeId>(column->type_) == TypeId::VARCHAR) {
+      const char *varlen = GetData() + *reinterpret_cast<const uint32_t *>(entry);
+      uint32_t size = GetVarlenSize(varlen);
+      memcpy(tuple->data_ + column->tuple_offset_, &varlen_offset, sizeof(uint32_t));
+      memcpy(tuple->data_ + varlen_offset, varlen, size);
+      varlen_offset += size;
+    } else {
+      memcpy(tuple->data_ + column->tuple_offset_, entry, column->width_);
+    }
+  }
+}
+
+Value PaxPage::GetValue(uint32_t slot_num, uint32_t column_idx) {
+  BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
+  auto column = GetColumn(column_idx);
+  auto type = static_cast<TypeId>(column->type_);
+  const char *entry = GetData() + column->minipage_offset_ + column->width_ * slot_num;
+  if (type == TypeId::VARCHAR) {
+    return Value::DeserializeFrom(GetData() + *reinterpret_cast<const uint32_t *>(entry), type);
+  }
+  return Value::DeserializeFrom(entry, type);
+}
+
+void PaxPage::GetValues(uint32_t column_idx, const std::vector<RID> &rids, std::vector<Value> *values) {
+  auto column = GetColumn(column_idx);
+  auto type = static_cast<TypeId>(column->type_);
+  const char *minipage = GetData() + column->minipage_offset_;
+  values->reserve(values->size() + rids.size());
+  if (type == TypeId::VARCHAR) {
+    for (const auto &rid : rids) {
+      auto offset = *reinterpret_cast<const uint32_t *>(minipage + sizeof(uint32_t) * rid.GetSlotNum());
+      values->push_back(Value::DeserializeFrom(GetData() + offset, type));
+    }
+    return;
+  }
+  for (const auto &rid : rids) {
+    values->push_back(Value::DeserializeFrom(minipage + column->width_ * rid.GetSlotNum(), type));
+  }
+}
+
+bool PaxPage::GetFirstTupleRid(RID *first_rid) {
+  // Find and return the first valid tuple.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    if (GetRowState(i) == ROW_LIVE) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) {
+  BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  // Find and return the first valid tuple after our current slot number.
+  for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
+    if (GetRowState(i) == ROW_LIVE) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  // Otherwise return false as there are no more tuples.
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+}  // namespace bustub
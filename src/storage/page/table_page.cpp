@@ -13,9 +13,26 @@
 #include "storage/page/table_page.h"
 
 #include <cassert>
+#include <utility>
+#include <vector>
+
+#include "storage/table/overflow_store.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return the number of bytes a VARCHAR value takes in a tuple when stored as it is */
+uint32_t GetStoredVarlenSize(const char *varlen) {
+  if (OverflowStore::IsExternal(varlen)) {
+    return OverflowStore::EXTERNAL_POINTER_SIZE;
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+  return sizeof(uint32_t) + (len == BUSTUB_VALUE_NULL ? 0 : len);
+}
+
+}  // namespace
+
 void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_id, LogManager *log_manager,
                      Transaction *txn) {
   // Set the page ID.
@@ -33,19 +50,111 @@ void TablePage::Init(page_id_t page_id, uint32_t page_size, page_id_t prev_page_
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(page_size);
   SetTupleCount(0);
+  SetFsmLocation(INVALID_PAGE_ID, 0);
+  uint32_t dictionary_offset = 0;
+  memcpy(GetData() + OFFSET_DICTIONARY, &dictionary_offset, sizeof(uint32_t));
+}
+
+void TablePage::InitDictionary(uint32_t inlined_length, const std::vector<uint32_t> &column_offsets) {
+  BUSTUB_ASSERT(GetTupleCount() == 0, "The dictionary has to be set up before any tuple is inserted.");
+  auto column_count = static_cast<uint32_t>(column_offsets.size());
+  uint32_t entry_count = 0;
+  // The column list takes the end of the page, the tuples grow down from its start.
+  uint32_t dictionary_offset = GetFreeSpacePointer() - GetDictionarySize(column_count);
+  memcpy(GetData() + OFFSET_DICTIONARY, &dictionary_offset, sizeof(uint32_t));
+  SetFreeSpacePointer(dictionary_offset);
+  char *dictionary = GetData() + dictionary_offset;
+  memcpy(dictionary + OFFSET_DICTIONARY_INLINED_LENGTH, &inlined_length, sizeof(uint32_t));
+  memcpy(dictionary + OFFSET_DICTIONARY_ENTRY_COUNT, &entry_count, sizeof(uint32_t));
+  memcpy(dictionary + OFFSET_DICTIONARY_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+  memcpy(dictionary + OFFSET_DICTIONARY_COLUMNS, column_offsets.data(), sizeof(uint32_t) * column_count);
 }
 
 bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) {
+  uint32_t slot_hint = 0;
+  if (!PlaceTuple(tuple, &slot_hint, rid)) {
+    return false;
+  }
+
+  // Write the log record.
+  if (enable_logging) {
+    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
+    // Acquire an exclusive lock on the new tuple.
+    bool locked = lock_manager->LockExclusive(txn, *rid);
+    BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return true;
+}
+
+uint32_t TablePage::InsertTuples(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn,
+                                 LockManager *lock_manager, LogManager *log_manager) {
+  // Slots below the hint are known to be in use, so each empty slot is found with one pass over the slot array.
+  uint32_t slot_hint = 0;
+  uint32_t inserted = 0;
+  while (inserted < count && PlaceTuple(tuples[inserted], &slot_hint, &rids[inserted])) {
+    inserted++;
+  }
+
+  // Write one log record for the whole batch; a single tuple gets the usual insert record.
+  if (enable_logging && inserted > 0) {
+    for (uint32_t i = 0; i < inserted; i++) {
+      BUSTUB_ASSERT(!txn->IsSharedLocked(rids[i]) && !txn->IsExclusiveLocked(rids[i]),
+                    "A new tuple should not be locked.");
+      bool locked = lock_manager->LockExclusive(txn, rids[i]);
+      BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
+    }
+    LogRecord log_record =
+        inserted == 1
+            ? LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, rids[0], tuples[0])
+            : LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BULKINSERT,
+                        std::vector<RID>(rids, rids + inserted), std::vector<Tuple>(tuples, tuples + inserted));
+    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
+    SetLSN(lsn);
+    txn->SetPrevLSN(lsn);
+  }
+  return inserted;
+}
+
+bool TablePage::PlaceTuple(const Tuple &tuple, uint32_t *slot_hint, RID *rid) {
   BUSTUB_ASSERT(tuple.size_ > 0, "Cannot have empty tuples.");
-  // If there is not enough space, then return false.
-  if (GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
+  if (HasDictionary()) {
+    // Encode with new dictionary entries if there is room for them, with only the existing ones otherwise.
+    Tuple encoded;
+    bool with_entries = EncodeTuple(tuple, true, &encoded);
+    if (!with_entries) {
+      EncodeTuple(tuple, false, &encoded);
+    }
+    uint32_t slot_num = PlaceData(encoded.data_, encoded.size_, encoded.size_, slot_hint);
+    if (slot_num == GetTupleCount()) {
+      BUSTUB_ASSERT(!with_entries, "The room for the tuple was checked when adding entries.");
+      ReleaseReferences(encoded.data_);
+      return false;
+    }
+    rid->Set(GetTablePageId(), slot_num);
+    return true;
+  }
+  uint32_t slot_num = PlaceData(tuple.data_, tuple.size_, tuple.size_, slot_hint);
+  if (slot_num == GetTupleCount()) {
     return false;
   }
+  rid->Set(GetTablePageId(), slot_num);
+  return true;
+}
+
+uint32_t TablePage::PlaceData(const char *data, uint32_t size, uint32_t slot_size, uint32_t *slot_hint) {
+  // If there is not enough space even when reusing a slot, then give up.
+  if (GetFreeSpaceRemaining() < size) {
+    return GetTupleCount();
+  }
 
   // Try to find a free slot to reuse.
   uint32_t i;
-  for (i = 0; i < GetTupleCount(); i++) {
+  for (i = *slot_hint; i < GetTupleCount(); i++) {
     // If the slot is empty, i.e. its tuple has size 0,
     if (GetTupleSize(i) == 0) {
       // Then we break out of the loop at index i.
@@ -54,37 +163,205 @@ bool TablePage::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, Lock
   }
 
   // If there was no free slot left, and we cannot claim it from the free space, then we give up.
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < tuple.size_ + SIZE_TUPLE) {
-    return false;
+  if (i == GetTupleCount() && GetFreeSpaceRemaining() < size + SIZE_TUPLE) {
+    return GetTupleCount();
   }
 
   // Otherwise we claim available free space..
-  SetFreeSpacePointer(GetFreeSpacePointer() - tuple.size_);
-  memcpy(GetData() + GetFreeSpacePointer(), tuple.data_, tuple.size_);
+  SetFreeSpacePointer(GetFreeSpacePointer() - size);
+  memcpy(GetData() + GetFreeSpacePointer(), data, size);
 
-  // Set the tuple.
+  // Set the slot.
   SetTupleOffsetAtSlot(i, GetFreeSpacePointer());
-  SetTupleSize(i, tuple.size_);
+  SetTupleSize(i, slot_size);
 
-  rid->Set(GetTablePageId(), i);
   if (i == GetTupleCount()) {
     SetTupleCount(GetTupleCount() + 1);
   }
+  *slot_hint = i + 1;
+  return i;
+}
+
+void TablePage::RemoveData(uint32_t slot_num, uint32_t size) {
+  uint32_t offset = GetTupleOffsetAtSlot(slot_num);
+  uint32_t free_space_pointer = GetFreeSpacePointer();
+  BUSTUB_ASSERT(offset >= free_space_pointer, "Free space appears before tuples.");
+
+  memmove(GetData() + free_space_pointer + size, GetData() + free_space_pointer, offset - free_space_pointer);
+  SetFreeSpacePointer(free_space_pointer + size);
+  SetTupleSize(slot_num, 0);
+  SetTupleOffsetAtSlot(slot_num, 0);
+
+  // Update all tuple offsets.
+  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
+    uint32_t offset_i = GetTupleOffsetAtSlot(i);
+    if (GetTupleSize(i) != 0 && offset_i < offset) {
+      SetTupleOffsetAtSlot(i, offset_i + size);
+    }
+  }
+}
 
-  // Write the log record.
-  if (enable_logging) {
-    BUSTUB_ASSERT(!txn->IsSharedLocked(*rid) && !txn->IsExclusiveLocked(*rid), "A new tuple should not be locked.");
-    // Acquire an exclusive lock on the new tuple.
-    bool locked = lock_manager->LockExclusive(txn, *rid);
-    BUSTUB_ASSERT(locked, "Locking a new tuple should always work.");
-    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::INSERT, *rid, tuple);
-    lsn_t lsn = log_manager->AppendLogRecord(&log_record);
-    SetLSN(lsn);
-    txn->SetPrevLSN(lsn);
+uint32_t TablePage::FindEntry(const char *data, uint32_t len) {
+  uint32_t entry_count = GetDictionaryEntryCount();
+  uint32_t seen = 0;
+  for (uint32_t i = 0; i < GetTupleCount() && seen < entry_count; i++) {
+    if (!IsDictionaryEntry(GetTupleSize(i))) {
+      continue;
+    }
+    seen++;
+    const char *entry = GetEntry(i);
+    if (*reinterpret_cast<const uint32_t *>(entry + sizeof(uint32_t)) == len &&
+        memcmp(entry + SIZE_DICTIONARY_ENTRY_HEADER, data, len) == 0) {
+      return i;
+    }
   }
+  return NO_CODE;
+}
+
+uint32_t TablePage::AddEntry(const char *data, uint32_t len) {
+  if (GetDictionaryEntryCount() == DICTIONARY_CAPACITY) {
+    return NO_CODE;
+  }
+  uint32_t size = SIZE_DICTIONARY_ENTRY_HEADER + len;
+  std::vector<char> entry(size);
+  uint32_t references = 0;
+  memcpy(entry.data(), &references, sizeof(uint32_t));
+  memcpy(entry.data() + sizeof(uint32_t), &len, sizeof(uint32_t));
+  memcpy(entry.data() + SIZE_DICTIONARY_ENTRY_HEADER, data, len);
+  uint32_t slot_hint = 0;
+  uint32_t code = PlaceData(entry.data(), size, size | DICTIONARY_ENTRY_MASK, &slot_hint);
+  if (code == GetTupleCount()) {
+    return NO_CODE;
+  }
+  SetDictionaryEntryCount(GetDictionaryEntryCount() + 1);
+  return code;
+}
+
+bool TablePage::EncodeTuple(const Tuple &tuple, bool add_entries, Tuple *encoded) {
+  uint32_t inlined_length = GetDictionaryField(OFFSET_DICTIONARY_INLINED_LENGTH);
+  uint32_t column_count = GetDictionaryField(OFFSET_DICTIONARY_COLUMN_COUNT);
+  auto varlen_at = [&](uint32_t column) {
+    uint32_t column_offset = GetDictionaryField(OFFSET_DICTIONARY_COLUMNS + sizeof(uint32_t) * column);
+    return tuple.data_ + *reinterpret_cast<const uint32_t *>(tuple.data_ + column_offset);
+  };
+  auto is_encodable = [](const char *varlen) {
+    uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+    return len != BUSTUB_VALUE_NULL && !OverflowStore::IsExternal(varlen);
+  };
+
+  // Find the codes of the values without changing the page, and check that the new entries would fit.
+  std::vector<uint32_t> codes(column_count);
+  uint32_t new_entries = 0;
+  uint32_t new_entries_size = 0;
+  uint32_t encoded_size = inlined_length;
+  for (uint32_t i = 0; i < column_count; i++) {
+    const char *varlen = varlen_at(i);
+    uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+    codes[i] = is_encodable(varlen) ? FindEntry(varlen + sizeof(uint32_t), len) : NO_CODE;
+    if (codes[i] == NO_CODE && add_entries && is_encodable(varlen)) {
+      new_entries++;
+      new_entries_size += SIZE_DICTIONARY_ENTRY_HEADER + len + SIZE_TUPLE;
+    }
+    encoded_size += codes[i] != NO_CODE || (add_entries && is_encodable(varlen)) ? sizeof(uint32_t)
+                                                                                : GetStoredVarlenSize(varlen);
+  }
+  if (add_entries && (GetDictionaryEntryCount() + new_entries > DICTIONARY_CAPACITY ||
+                      GetFreeSpaceRemaining() < new_entries_size + encoded_size + SIZE_TUPLE)) {
+    return false;
+  }
+
+  // Add the new entries; a string that occurs twice in the tuple is found the second time.
+  for (uint32_t i = 0; i < column_count; i++) {
+    const char *varlen = varlen_at(i);
+    if (codes[i] == NO_CODE && add_entries && is_encodable(varlen)) {
+      uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+      codes[i] = FindEntry(varlen + sizeof(uint32_t), len);
+      if (codes[i] == NO_CODE) {
+        codes[i] = AddEntry(varlen + sizeof(uint32_t), len);
+        BUSTUB_ASSERT(codes[i] != NO_CODE, "The room for the entry was checked.");
+      }
+    }
+  }
+
+  // Write the encoded tuple: the fixed-size part as it is, then the values in column order.
+  if (encoded->allocated_) {
+    delete[] encoded->data_;
+  }
+  encoded->size_ = encoded_size;
+  encoded->data_ = new char[encoded_size];
+  encoded->allocated_ = true;
+  encoded->rid_ = tuple.rid_;
+  memcpy(encoded->data_, tuple.data_, inlined_length);
+  uint32_t offset = inlined_length;
+  for (uint32_t i = 0; i < column_count; i++) {
+    uint32_t column_offset = GetDictionaryField(OFFSET_DICTIONARY_COLUMNS + sizeof(uint32_t) * i);
+    memcpy(encoded->data_ + column_offset, &offset, sizeof(uint32_t));
+    if (codes[i] != NO_CODE) {
+      uint32_t reference = DICTIONARY_REFERENCE | codes[i];
+      memcpy(encoded->data_ + offset, &reference, sizeof(uint32_t));
+      offset += sizeof(uint32_t);
+      (*reinterpret_cast<uint32_t *>(GetEntry(codes[i])))++;
+    } else {
+      const char *varlen = varlen_at(i);
+      memcpy(encoded->data_ + offset, varlen, GetStoredVarlenSize(varlen));
+      offset += GetStoredVarlenSize(varlen);
+    }
+  }
+  BUSTUB_ASSERT(offset == encoded_size, "The encoded tuple was sized wrong.");
   return true;
 }
 
+void TablePage::DecodeTuple(const char *data, uint32_t size, const RID &rid, Tuple *tuple) {
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  uint32_t inlined_length = GetDictionaryField(OFFSET_DICTIONARY_INLINED_LENGTH);
+  uint32_t column_count = GetDictionaryField(OFFSET_DICTIONARY_COLUMN_COUNT);
+  // Resolve the references to the serialized strings they stand for.
+  std::vector<const char *> varlens(column_count);
+  uint32_t tuple_size = inlined_length;
+  for (uint32_t i = 0; i < column_count; i++) {
+    uint32_t column_offset = GetDictionaryField(OFFSET_DICTIONARY_COLUMNS + sizeof(uint32_t) * i);
+    varlens[i] = data + *reinterpret_cast<const uint32_t *>(data + column_offset);
+    uint32_t len = *reinterpret_cast<const uint32_t *>(varlens[i]);
+    if (IsReference(len)) {
+      varlens[i] = GetEntry(len & ~DICTIONARY_REFERENCE) + sizeof(uint32_t);
+    }
+    tuple_size += GetStoredVarlenSize(varlens[i]);
+  }
+
+  tuple->size_ = tuple_size;
+  tuple->data_ = new char[tuple_size];
+  memcpy(tuple->data_, data, inlined_length);
+  uint32_t offset = inlined_length;
+  for (uint32_t i = 0; i < column_count; i++) {
+    uint32_t column_offset = GetDictionaryField(OFFSET_DICTIONARY_COLUMNS + sizeof(uint32_t) * i);
+    memcpy(tuple->data_ + column_offset, &offset, sizeof(uint32_t));
+    memcpy(tuple->data_ + offset, varlens[i], GetStoredVarlenSize(varlens[i]));
+    offset += GetStoredVarlenSize(varlens[i]);
+  }
+}
+
+void TablePage::ReleaseReferences(const char *data) {
+  uint32_t column_count = GetDictionaryField(OFFSET_DICTIONARY_COLUMN_COUNT);
+  for (uint32_t i = 0; i < column_count; i++) {
+    uint32_t column_offset = GetDictionaryField(OFFSET_DICTIONARY_COLUMNS + sizeof(uint32_t) * i);
+    uint32_t varlen_offset = *reinterpret_cast<const uint32_t *>(data + column_offset);
+    uint32_t len = *reinterpret_cast<const uint32_t *>(data + varlen_offset);
+    if (!IsReference(len)) {
+      continue;
+    }
+    uint32_t code = len & ~DICTIONARY_REFERENCE;
+    auto references = reinterpret_cast<uint32_t *>(GetEntry(code));
+    if (--(*references) == 0) {
+      RemoveData(code, GetTupleSize(code) & ~DICTIONARY_ENTRY_MASK);
+      SetDictionaryEntryCount(GetDictionaryEntryCount() - 1);
+    }
+  }
+}
+
 bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
@@ -130,6 +407,38 @@ bool TablePage::MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_m
 bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
                             LockManager *lock_manager, LogManager *log_manager) {
   BUSTUB_ASSERT(new_tuple.size_ > 0, "Cannot have empty tuples.");
+  if (!HasDictionary()) {
+    return ReplaceData(new_tuple.data_, new_tuple.size_, new_tuple.size_, new_tuple, old_tuple, rid, txn, lock_manager,
+                       log_manager);
+  }
+  // Encode the new value first, adding dictionary entries moves the free space but not the tuples.
+  Tuple encoded;
+  if (!EncodeTuple(new_tuple, true, &encoded)) {
+    EncodeTuple(new_tuple, false, &encoded);
+  }
+  if (!ReplaceData(encoded.data_, encoded.size_, encoded.size_, new_tuple, old_tuple, rid, txn, lock_manager,
+                   log_manager)) {
+    ReleaseReferences(encoded.data_);
+    return false;
+  }
+  return true;
+}
+
+bool TablePage::ForwardTuple(const RID &rid, const RID &new_rid, Tuple *old_tuple, Transaction *txn,
+                             LockManager *lock_manager, LogManager *log_manager) {
+  char stub[SIZE_FORWARDING_STUB];
+  page_id_t page_id = new_rid.GetPageId();
+  uint32_t slot_num = new_rid.GetSlotNum();
+  memcpy(stub, &page_id, sizeof(page_id_t));
+  memcpy(stub + sizeof(page_id_t), &slot_num, sizeof(uint32_t));
+  // The log record only says where the new value went, it is not logged itself.
+  return ReplaceData(stub, SIZE_FORWARDING_STUB, SIZE_FORWARDING_STUB | FORWARD_MASK, Tuple(new_rid), old_tuple, rid,
+                     txn, lock_manager, log_manager);
+}
+
+bool TablePage::ReplaceData(const char *data, uint32_t size, uint32_t slot_size, const Tuple &logged_tuple,
+                            Tuple *old_tuple, const RID &rid, Transaction *txn, LockManager *lock_manager,
+                            LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort the transaction.
   if (slot_num >= GetTupleCount()) {
@@ -146,21 +455,29 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
     }
     return false;
   }
+  bool is_stub = IsForwardingStub(tuple_size);
+  tuple_size &= SIZE_MASK;
   // If there is not enuogh space to update, we need to update via delete followed by an insert (not enough space).
-  if (GetFreeSpaceRemaining() + tuple_size < new_tuple.size_) {
+  if (GetFreeSpaceRemaining() + tuple_size < size) {
     return false;
   }
 
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  old_tuple->size_ = tuple_size;
-  if (old_tuple->allocated_) {
-    delete[] old_tuple->data_;
+  Tuple stored_old_tuple;
+  stored_old_tuple.size_ = tuple_size;
+  stored_old_tuple.data_ = new char[stored_old_tuple.size_];
+  memcpy(stored_old_tuple.data_, GetData() + tuple_offset, stored_old_tuple.size_);
+  stored_old_tuple.rid_ = rid;
+  stored_old_tuple.allocated_ = true;
+  if (is_stub) {
+    // The old value is at the page the stub points to.
+    *old_tuple = Tuple();
+  } else if (HasDictionary()) {
+    DecodeTuple(stored_old_tuple.data_, stored_old_tuple.size_, rid, old_tuple);
+  } else {
+    *old_tuple = stored_old_tuple;
   }
-  old_tuple->data_ = new char[old_tuple->size_];
-  memcpy(old_tuple->data_, GetData() + tuple_offset, old_tuple->size_);
-  old_tuple->rid_ = rid;
-  old_tuple->allocated_ = true;
 
   if (enable_logging) {
     // Acquire an exclusive lock, upgrading from shared if necessary.
@@ -171,7 +488,8 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
     } else if (!txn->IsExclusiveLocked(rid) && !lock_manager->LockExclusive(txn, rid)) {
       return false;
     }
-    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple, new_tuple);
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::UPDATE, rid, *old_tuple,
+                         logged_tuple);
     lsn_t lsn = log_manager->AppendLogRecord(&log_record);
     SetLSN(lsn);
     txn->SetPrevLSN(lsn);
@@ -181,23 +499,79 @@ bool TablePage::UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID
   uint32_t free_space_pointer = GetFreeSpacePointer();
   BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
 
-  memmove(GetData() + free_space_pointer + tuple_size - new_tuple.size_, GetData() + free_space_pointer,
+  memmove(GetData() + free_space_pointer + tuple_size - size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - new_tuple.size_);
-  memcpy(GetData() + tuple_offset + tuple_size - new_tuple.size_, new_tuple.data_, new_tuple.size_);
-  SetTupleSize(slot_num, new_tuple.size_);
+  SetFreeSpacePointer(free_space_pointer + tuple_size - size);
+  memcpy(GetData() + tuple_offset + tuple_size - size, data, size);
+  SetTupleSize(slot_num, slot_size);
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_tuple.size_);
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - size);
     }
   }
+
+  // The old value no longer refers to its dictionary entries.
+  if (HasDictionary() && !is_stub) {
+    ReleaseReferences(stored_old_tuple.data_);
+  }
+  return true;
+}
+
+bool TablePage::GetForwardRid(const RID &rid, RID *forward_rid) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || !IsForwardingStub(GetTupleSize(slot_num))) {
+    return false;
+  }
+  const char *stub = GetData() + GetTupleOffsetAtSlot(slot_num);
+  forward_rid->Set(*reinterpret_cast<const page_id_t *>(stub),
+                   *reinterpret_cast<const uint32_t *>(stub + sizeof(page_id_t)));
+  return true;
+}
+
+bool TablePage::InsertMovedTuple(const Tuple &tuple, RID *rid) {
+  uint32_t slot_hint = 0;
+  if (!PlaceTuple(tuple, &slot_hint, rid)) {
+    return false;
+  }
+  SetTupleSize(rid->GetSlotNum(), GetTupleSize(rid->GetSlotNum()) | MOVED_MASK);
   return true;
 }
 
-void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
+bool TablePage::GetMovedTuple(const RID &rid, Tuple *tuple) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || !IsMovedTuple(GetTupleSize(slot_num))) {
+    return false;
+  }
+  const char *data = GetData() + GetTupleOffsetAtSlot(slot_num);
+  uint32_t size = GetTupleSize(slot_num) & SIZE_MASK;
+  if (HasDictionary()) {
+    DecodeTuple(data, size, rid, tuple);
+  } else {
+    *tuple = TupleView(data, size, rid).Materialize();
+  }
+  return true;
+}
+
+void TablePage::RemoveMovedTuple(const RID &rid, Tuple *removed_tuple) {
+  uint32_t slot_num = rid.GetSlotNum();
+  BUSTUB_ASSERT(slot_num < GetTupleCount() && IsMovedTuple(GetTupleSize(slot_num)), "There is no moved tuple there.");
+  uint32_t size = GetTupleSize(slot_num) & SIZE_MASK;
+  std::vector<char> stored(GetData() + GetTupleOffsetAtSlot(slot_num),
+                           GetData() + GetTupleOffsetAtSlot(slot_num) + size);
+  if (removed_tuple != nullptr) {
+    GetMovedTuple(rid, removed_tuple);
+  }
+  RemoveData(slot_num, size);
+  if (HasDictionary()) {
+    ReleaseReferences(stored.data());
+  }
+  TrimSlots();
+}
+
+void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager, Tuple *deleted_tuple) {
   uint32_t slot_num = rid.GetSlotNum();
   BUSTUB_ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
@@ -208,14 +582,25 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
     tuple_size = UnsetDeletedFlag(tuple_size);
   }
   // Otherwise we are rolling back an insert.
+  // The stub of a moved tuple goes away here, the caller removes the tuple from the page the stub points to.
+  bool is_stub = IsForwardingStub(tuple_size);
+  tuple_size &= SIZE_MASK;
 
   // We need to copy out the deleted tuple for undo purposes.
+  Tuple stored_tuple;
+  stored_tuple.size_ = tuple_size;
+  stored_tuple.data_ = new char[stored_tuple.size_];
+  memcpy(stored_tuple.data_, GetData() + tuple_offset, stored_tuple.size_);
+  stored_tuple.rid_ = rid;
+  stored_tuple.allocated_ = true;
   Tuple delete_tuple;
-  delete_tuple.size_ = tuple_size;
-  delete_tuple.data_ = new char[delete_tuple.size_];
-  memcpy(delete_tuple.data_, GetData() + tuple_offset, delete_tuple.size_);
-  delete_tuple.rid_ = rid;
-  delete_tuple.allocated_ = true;
+  if (is_stub) {
+    delete_tuple = Tuple();
+  } else if (HasDictionary()) {
+    DecodeTuple(stored_tuple.data_, stored_tuple.size_, rid, &delete_tuple);
+  } else {
+    delete_tuple = stored_tuple;
+  }
 
   if (enable_logging) {
     BUSTUB_ASSERT(txn->IsExclusiveLocked(rid), "We must own the exclusive lock!");
@@ -226,22 +611,24 @@ void TablePage::ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_ma
     txn->SetPrevLSN(lsn);
   }
 
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  BUSTUB_ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
+  RemoveData(slot_num, tuple_size);
+  if (HasDictionary() && !is_stub) {
+    ReleaseReferences(stored_tuple.data_);
+  }
+  // The tuple data is dense again; also give the trailing empty slots back to the free space.
+  TrimSlots();
 
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
-  SetTupleSize(slot_num, 0);
-  SetTupleOffsetAtSlot(slot_num, 0);
+  if (deleted_tuple != nullptr) {
+    *deleted_tuple = std::move(delete_tuple);
+  }
+}
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
-    }
+void TablePage::TrimSlots() {
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
   }
+  SetTupleCount(tuple_count);
 }
 
 void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager) {
@@ -265,7 +652,44 @@ void TablePage::RollbackDelete(const RID &rid, Transaction *txn, LogManager *log
   }
 }
 
-bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) {
+bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager,
+                         RID *forward_rid) {
+  if (!CheckTuple(rid, txn, lock_manager)) {
+    return false;
+  }
+  // A moved tuple is read from the page its stub points to.
+  RID moved_rid;
+  if (GetForwardRid(rid, &moved_rid)) {
+    if (forward_rid != nullptr) {
+      *forward_rid = moved_rid;
+    }
+    return forward_rid != nullptr;
+  }
+  if (forward_rid != nullptr) {
+    *forward_rid = RID();
+  }
+  // Copy the tuple data into our result.
+  const char *data = GetData() + GetTupleOffsetAtSlot(rid.GetSlotNum());
+  uint32_t size = GetTupleSize(rid.GetSlotNum());
+  if (HasDictionary()) {
+    DecodeTuple(data, size, rid, tuple);
+  } else {
+    *tuple = TupleView(data, size, rid).Materialize();
+  }
+  return true;
+}
+
+bool TablePage::GetTupleView(const RID &rid, TupleView *view, Transaction *txn, LockManager *lock_manager) {
+  if (!CheckTuple(rid, txn, lock_manager) || IsForwardingStub(GetTupleSize(rid.GetSlotNum()))) {
+    return false;
+  }
+  // At this point, we have at least a shared lock on the RID. Point the view at the tuple data.
+  uint32_t slot_num = rid.GetSlotNum();
+  *view = TupleView(GetData() + GetTupleOffsetAtSlot(slot_num), GetTupleSize(slot_num), rid);
+  return true;
+}
+
+bool TablePage::CheckTuple(const RID &rid, Transaction *txn, LockManager *lock_manager) {
   // Get the current slot number.
   uint32_t slot_num = rid.GetSlotNum();
   // If somehow we have more slots than tuples, abort the transaction.
@@ -291,18 +715,45 @@ bool TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
       return false;
     }
   }
+  return true;
+}
 
-  // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
-  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  tuple->size_ = tuple_size;
-  if (tuple->allocated_) {
-    delete[] tuple->data_;
+void TablePage::FindEqual(uint32_t column_offset, const char *data, uint32_t len, std::vector<RID> *rids,
+                          std::vector<RID> *external_rids, Transaction *txn, LockManager *lock_manager) {
+  // Compare the string against the dictionary once; a page without the string in it can only match inline values.
+  uint32_t code = HasDictionary() ? FindEntry(data, len) : NO_CODE;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size)) {
+      continue;
+    }
+    RID rid(GetTablePageId(), i);
+    // A moved tuple is not here; its value is compared by the caller, like a value stored out of line.
+    if (IsForwardingStub(tuple_size)) {
+      external_rids->push_back(rid);
+      continue;
+    }
+    const char *tuple = GetData() + GetTupleOffsetAtSlot(i);
+    const char *varlen = tuple + *reinterpret_cast<const uint32_t *>(tuple + column_offset);
+    uint32_t stored_len = *reinterpret_cast<const uint32_t *>(varlen);
+    std::vector<RID> *out = nullptr;
+    if (IsReference(stored_len)) {
+      out = (stored_len & ~DICTIONARY_REFERENCE) == code ? rids : nullptr;
+    } else if (OverflowStore::IsExternal(varlen)) {
+      out = OverflowStore::GetExternalLength(varlen) == len ? external_rids : nullptr;
+    } else if (stored_len == len && memcmp(varlen + sizeof(uint32_t), data, len) == 0) {
+      out = rids;
+    }
+    if (out == nullptr) {
+      continue;
+    }
+    // Take the same shared lock as reading the tuple would.
+    if (enable_logging && !txn->IsSharedLocked(rid) && !txn->IsExclusiveLocked(rid) &&
+        !lock_manager->LockShared(txn, rid)) {
+      continue;
+    }
+    out->push_back(rid);
   }
-  tuple->data_ = new char[tuple->size_];
-  memcpy(tuple->data_, GetData() + tuple_offset, tuple->size_);
-  tuple->rid_ = rid;
-  tuple->allocated_ = true;
-  return true;
 }
 
 bool TablePage::GetFirstTupleRid(RID *first_rid) {
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// column_iterator.cpp
+//
+// Identification: src/storage/table/column_iterator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/column_iterator.h"
+
+#include <utility>
+#include <vector>
+
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+ColumnIterator::ColumnIterator(TableHeap *table_heap, const Schema *schema, std::vector<uint32_t> column_ids,
+                               Transaction *txn)
+    : table_heap_(table_heap),
+      schema_(schema),
+      column_ids_(std::move(column_ids)),
+      txn_(txn),
+      next_page_id_(table_heap->GetFirstPageId()),
+      columns_(column_ids_.size()) {}
+
+bool ColumnIterator::Next(std::vector<Value> *values, RID *rid) {
+  while (position_ == rids_.size()) {
+    if (next_page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    LoadPage();
+  }
+  values->clear();
+  values->reserve(columns_.size());
+  for (const auto &column : columns_) {
+    values->push_back(column[position_]);
+  }
+  *rid = rids_[position_++];
+  return true;
+}
+
+bool ColumnIterator::NextBatch(std::vector<std::vector<Value>> *columns, std::vector<RID> *rids) {
+  while (position_ == rids_.size()) {
+    if (next_page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    LoadPage();
+  }
+  BUSTUB_ASSERT(position_ == 0, "NextBatch cannot be mixed with Next.");
+  // Hand the buffers over; LoadPage clears whatever it gets back.
+  columns->resize(columns_.size());
+  for (size_t i = 0; i < columns_.size(); i++) {
+    std::swap((*columns)[i], columns_[i]);
+  }
+  std::swap(*rids, rids_);
+  rids_.clear();
+  return true;
+}
+
+void ColumnIterator::LoadPage() {
+  rids_.clear();
+  for (auto &column : columns_) {
+    column.clear();
+  }
+  position_ = 0;
+
+  auto page_id = next_page_id_;
+  auto page = table_heap_->buffer_pool_manager_->FetchPage(page_id);
+  BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+  page->RLatch();
+  table_heap_->ForLayout(page, [this](auto *table_page) {
+    LoadTuples(table_page);
+    next_page_id_ = table_page->GetNextPageId();
+  });
+  page->RUnlatch();
+  table_heap_->buffer_pool_manager_->UnpinPage(page_id, false);
+
+  // Tuples moved to other pages by updates are read once the page is released, one page latch at a time.
+  for (const auto &rid : forwarded_rids_) {
+    Tuple tuple;
+    if (table_heap_->GetTuple(rid, &tuple, txn_)) {
+      AppendTuple(tuple, rid);
+    }
+  }
+  forwarded_rids_.clear();
+}
+
+void ColumnIterator::LoadTuples(TablePage *page) {
+  RID rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    Tuple tuple;
+    RID forward_rid;
+    if (!page->GetTuple(rid, &tuple, txn_, table_heap_->lock_manager_, &forward_rid)) {
+      continue;
+    }
+    if (forward_rid.GetPageId() != INVALID_PAGE_ID) {
+      forwarded_rids_.push_back(rid);
+      continue;
+    }
+    AppendTuple(tuple, rid);
+  }
+}
+
+void ColumnIterator::AppendTuple(const Tuple &tuple, const RID &rid) {
+  rids_.push_back(rid);
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    columns_[i].push_back(tuple.GetValue(schema_, column_ids_[i]));
+  }
+}
+
+void ColumnIterator::LoadTuples(PaxPage *page) {
+  RID rid;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    // Take the same shared lock as reading the whole tuple would.
+    if (enable_logging && !txn_->IsSharedLocked(rid) && !txn_->IsExclusiveLocked(rid) &&
+        !table_heap_->lock_manager_->LockShared(txn_, rid)) {
+      continue;
+    }
+    rids_.push_back(rid);
+  }
+  // Read column by column, each from its own minipage.
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    page->GetValues(column_ids_[i], rids_, &columns_[i]);
+  }
+}
+
+}  // namespace bustub
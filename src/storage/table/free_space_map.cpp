@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager) : buffer_pool_manager_(buffer_pool_manager) {
+  auto root_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&root_page_id_));
+  BUSTUB_ASSERT(root_page != nullptr, "Couldn't create a page for the free space map.");
+  root_page->WLatch();
+  root_page->Init(root_page_id_);
+  root_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  last_map_page_id_ = root_page_id_;
+  map_page_ids_.push_back(root_page_id_);
+}
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t root_page_id)
+    : buffer_pool_manager_(buffer_pool_manager), root_page_id_(root_page_id) {
+  // Walk to the last map page, it holds the entry of the last table page.
+  auto page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(map_page != nullptr, "Couldn't fetch a free space map page.");
+    map_page->RLatch();
+    auto next_page_id = map_page->GetNextPageId();
+    if (map_page->GetEntryCount() > 0) {
+      last_table_page_id_ = map_page->GetTablePageId(map_page->GetEntryCount() - 1);
+    }
+    table_page_count_ += map_page->GetEntryCount();
+    map_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    last_map_page_id_ = page_id;
+    map_page_ids_.push_back(page_id);
+    page_id = next_page_id;
+  }
+}
+
+bool FreeSpaceMap::AddPage(TablePage *table_page) {
+  page_id_t map_page_id;
+  uint32_t slot_num;
+  if (!AddPage(table_page->GetTablePageId(), table_page->GetFreeSpaceRemaining(), &map_page_id, &slot_num)) {
+    return false;
+  }
+  table_page->SetFsmLocation(map_page_id, slot_num);
+  return true;
+}
+
+bool FreeSpaceMap::AddPage(page_id_t table_page_id, uint32_t free_space, page_id_t *map_page_id,
+                           uint32_t *slot_num) {
+  auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(last_map_page_id_));
+  if (map_page == nullptr) {
+    return false;
+  }
+  map_page->WLatch();
+  if (map_page->IsFull()) {
+    // Chain a new map page after the full one.
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(&new_page_id));
+    if (new_page == nullptr) {
+      map_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(last_map_page_id_, false);
+      return false;
+    }
+    new_page->WLatch();
+    new_page->Init(new_page_id);
+    map_page->SetNextPageId(new_page_id);
+    map_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_map_page_id_, true);
+    map_page = new_page;
+    last_map_page_id_ = new_page_id;
+    std::lock_guard<std::mutex> guard(latch_);
+    map_page_ids_.push_back(new_page_id);
+  }
+  uint32_t slot = map_page->Append(table_page_id, FreeSpaceMapPage::ToCategory(free_space));
+  {
+    // Counted while the map page is latched, so that the entries of a snapshot are all in their map pages.
+    std::lock_guard<std::mutex> guard(latch_);
+    table_page_count_++;
+  }
+  map_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_map_page_id_, true);
+  if (map_page_id != nullptr) {
+    *map_page_id = last_map_page_id_;
+  }
+  if (slot_num != nullptr) {
+    *slot_num = slot;
+  }
+  last_table_page_id_ = table_page_id;
+  return true;
+}
+
+void FreeSpaceMap::Update(TablePage *table_page) {
+  auto map_page_id = table_page->GetFsmPageId();
+  if (map_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+  if (map_page == nullptr) {
+    return;
+  }
+  auto slot_num = table_page->GetFsmSlot();
+  auto category = FreeSpaceMapPage::ToCategory(table_page->GetFreeSpaceRemaining());
+  map_page->WLatch();
+  bool changed = map_page->GetCategory(slot_num) != category;
+  if (changed) {
+    map_page->SetCategory(slot_num, category);
+  }
+  map_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(map_page_id, changed);
+}
+
+uint32_t FreeSpaceMap::GetMapPageIds(std::vector<page_id_t> *map_page_ids) {
+  std::lock_guard<std::mutex> guard(latch_);
+  *map_page_ids = map_page_ids_;
+  return table_page_count_;
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t required_space) {
+  auto page_id = root_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (map_page == nullptr) {
+      return INVALID_PAGE_ID;
+    }
+    map_page->RLatch();
+    auto slot_num = map_page->FindSlot(required_space);
+    auto found = slot_num < map_page->GetEntryCount() ? map_page->GetTablePageId(slot_num) : INVALID_PAGE_ID;
+    auto next_page_id = map_page->GetNextPageId();
+    map_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (found != INVALID_PAGE_ID) {
+      return found;
+    }
+    page_id = next_page_id;
+  }
+  return INVALID_PAGE_ID;
+}
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// overflow_store.cpp
+//
+// Identification: src/storage/table/overflow_store.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/overflow_store.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+bool OverflowStore::Write(const char *data, uint32_t size, page_id_t *first_page_id) {
+  *first_page_id = INVALID_PAGE_ID;
+  OverflowPage *prev_page = nullptr;
+  uint32_t written = 0;
+  do {
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(&page_id));
+    if (page == nullptr) {
+      // Out of frames: unlink what was written so far and give it back.
+      if (prev_page != nullptr) {
+        prev_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+      }
+      Free(*first_page_id);
+      *first_page_id = INVALID_PAGE_ID;
+      return false;
+    }
+    page->WLatch();
+    page->Init(page_id);
+    uint32_t chunk_size = std::min(size - written, OverflowPage::CAPACITY);
+    memcpy(page->GetChunk(), data + written, chunk_size);
+    page->SetDataSize(chunk_size);
+    written += chunk_size;
+    if (prev_page == nullptr) {
+      *first_page_id = page_id;
+    } else {
+      prev_page->SetNextPageId(page_id);
+      prev_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+    }
+    prev_page = page;
+  } while (written < size);
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  return true;
+}
+
+bool OverflowStore::Read(page_id_t first_page_id, uint32_t size, char *out) {
+  uint32_t read = 0;
+  auto page_id = first_page_id;
+  while (read < size) {
+    BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "The overflow chain is shorter than the value.");
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    page->RLatch();
+    uint32_t chunk_size = std::min(size - read, page->GetDataSize());
+    memcpy(out + read, page->GetChunk(), chunk_size);
+    read += chunk_size;
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return true;
+}
+
+void OverflowStore::Free(page_id_t first_page_id) {
+  auto page_id = first_page_id;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch an overflow page to free it.");
+    auto next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+}  // namespace bustub
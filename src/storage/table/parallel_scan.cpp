@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_scan.cpp
+//
+// Identification: src/storage/table/parallel_scan.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/parallel_scan.h"
+
+#include <algorithm>
+
+#include "storage/page/free_space_map_page.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+ParallelScan::ParallelScan(TableHeap *table_heap, uint32_t worker_count)
+    : table_heap_(table_heap), buffer_pool_manager_(table_heap->buffer_pool_manager_) {
+  page_count_ = table_heap_->GetFreeSpaceMap()->GetMapPageIds(&map_page_ids_);
+  uint32_t morsel_count = std::max(worker_count, 1U) * MORSELS_PER_WORKER;
+  morsel_size_ = std::clamp((page_count_ + morsel_count - 1) / morsel_count, 1U, MAX_MORSEL_SIZE);
+}
+
+TupleViewIterator ParallelScan::CreateWorker(Transaction *txn) { return TupleViewIterator(table_heap_, this, txn); }
+
+bool ParallelScan::NextMorsel(std::vector<page_id_t> *page_ids) {
+  page_ids->clear();
+  // Never let the cursor run past the end, so that it cannot overflow however often it is polled.
+  uint32_t begin = cursor_.load();
+  do {
+    if (begin >= page_count_) {
+      return false;
+    }
+  } while (!cursor_.compare_exchange_weak(begin, std::min(begin + morsel_size_, page_count_)));
+  uint32_t end = std::min(begin + morsel_size_, page_count_);
+
+  // A morsel may straddle two map pages.
+  for (uint32_t page_number = begin; page_number < end;) {
+    uint32_t map_index = page_number / FreeSpaceMapPage::CAPACITY;
+    auto map_page_id = map_page_ids_[map_index];
+    auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id));
+    BUSTUB_ASSERT(map_page != nullptr, "Couldn't fetch a free space map page.");
+    map_page->RLatch();
+    uint32_t map_end = std::min(end, (map_index + 1) * FreeSpaceMapPage::CAPACITY);
+    for (; page_number < map_end; page_number++) {
+      page_ids->push_back(map_page->GetTablePageId(page_number % FreeSpaceMapPage::CAPACITY));
+    }
+    map_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -10,90 +10,297 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return the number of bytes of a serialized VARCHAR in a tuple, which may be an external pointer */
+uint32_t GetStoredVarlenSize(const char *varlen) {
+  if (OverflowStore::IsExternal(varlen)) {
+    return OverflowStore::EXTERNAL_POINTER_SIZE;
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+  return sizeof(uint32_t) + (len == BUSTUB_VALUE_NULL ? 0 : len);
+}
+
+}  // namespace
+
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      page_id_t first_page_id)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id) {
+  OpenFirstPage();
+  BUSTUB_ASSERT(layout_ == TableLayout::ROW, "Opening a PAX table needs its schema.");
+}
+
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+                     page_id_t first_page_id, const Schema &schema, bool dictionary_encoding)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      first_page_id_(first_page_id),
+      schema_(std::make_unique<Schema>(schema)) {
+  OpenFirstPage();
+  InitTupleFormat(dictionary_encoding);
+}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
     : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+  CreateFirstPage(txn);
+}
+
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
+                     Transaction *txn, const Schema &schema, TableLayout layout, bool dictionary_encoding)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      layout_(layout),
+      schema_(std::make_unique<Schema>(schema)) {
+  InitTupleFormat(dictionary_encoding);
+  CreateFirstPage(txn);
+}
+
+void TableHeap::OpenFirstPage() {
+  // The entry of the first page is the first entry of the free space map.
+  auto first_page = buffer_pool_manager_->FetchPage(first_page_id_);
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  first_page->RLatch();
+  layout_ = PaxPage::IsPaxPage(first_page) ? TableLayout::PAX : TableLayout::ROW;
+  auto fsm_page_id = ForLayout(first_page, [](auto *page) { return page->GetFsmPageId(); });
+  first_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, false);
+  free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_, fsm_page_id);
+}
+
+void TableHeap::InitTupleFormat(bool dictionary_encoding) {
+  if (layout_ == TableLayout::PAX) {
+    max_tuple_size_ = PaxPage::GetMaxTupleSize(*schema_);
+  }
+  if (layout_ == TableLayout::ROW && dictionary_encoding) {
+    for (auto col_idx : schema_->GetUnlinedColumns()) {
+      dictionary_columns_.push_back(schema_->GetColumn(col_idx).GetOffset());
+    }
+    // The list of encoded columns takes room from every page.
+    max_tuple_size_ -= TablePage::GetDictionarySize(static_cast<uint32_t>(dictionary_columns_.size()));
+  }
+}
+
+void TableHeap::CreateFirstPage(Transaction *txn) {
+  free_space_map_ = std::make_unique<FreeSpaceMap>(buffer_pool_manager_);
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = buffer_pool_manager_->NewPage(&first_page_id_);
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
-  first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
+  bool added = ForLayout(first_page, [&](auto *page) {
+    InitPage(page, first_page_id_, INVALID_LSN, txn);
+    return TrackPage(page);
+  });
+  BUSTUB_ASSERT(added, "Couldn't track the first page of the table heap.");
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  if (!NeedsToast(tuple)) {
+    return InsertToastedTuple(tuple, rid, txn);
+  }
+  Tuple toasted;
+  if (!ToastTuple(tuple, &toasted)) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  if (!InsertToastedTuple(toasted, rid, txn)) {
+    FreeExternalValues(toasted);
+    return false;
+  }
+  return true;
+}
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+bool TableHeap::InsertToastedTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+  if (tuple.size_ > max_tuple_size_) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // PAX tables only ever append to their last page.
+  if (layout_ == TableLayout::PAX) {
+    return InsertIntoNewPage<PaxPage>(&tuple, 1, rid, txn) == 1;
+  }
 
-  cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+  // Try the pages that the free space map says have enough room. The map may be stale, in which case the failed
+  // attempt corrects it and we ask again.
+  uint32_t required_space = TablePage::GetRequiredSpace(tuple.size_);
+  for (auto page_id = free_space_map_->FindPage(required_space); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map_->FindPage(required_space)) {
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+    bool inserted = cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    free_space_map_->Update(cur_page);
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      // Update the transaction's write set.
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+  }
+  // No page has room, so the table has to grow.
+  return InsertIntoNewPage<TablePage>(&tuple, 1, rid, txn) == 1;
+}
+
+bool TableHeap::InsertTuples(const std::vector<Tuple> &input_tuples, std::vector<RID> *rids, Transaction *txn) {
+  // Only copy the batch if some of its tuples need values moved out of line.
+  std::vector<Tuple> toasted;
+  if (std::any_of(input_tuples.begin(), input_tuples.end(), [&](const Tuple &tuple) { return NeedsToast(tuple); })) {
+    toasted.resize(input_tuples.size());
+    for (size_t i = 0; i < input_tuples.size(); i++) {
+      if (!NeedsToast(input_tuples[i])) {
+        toasted[i] = input_tuples[i];
+      } else if (!ToastTuple(input_tuples[i], &toasted[i])) {
+        toasted.resize(i);
+        std::for_each(toasted.begin(), toasted.end(), [&](const Tuple &tuple) { FreeExternalValues(tuple); });
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+    }
+  }
+  const std::vector<Tuple> &tuples = toasted.empty() ? input_tuples : toasted;
+  // Give back the overflow pages of the tuples that did not make it into the table.
+  auto free_from = [&](size_t first) {
+    for (size_t i = first; i < toasted.size(); i++) {
+      FreeExternalValues(toasted[i]);
+    }
+  };
+
+  for (const auto &tuple : tuples) {
+    if (tuple.size_ > max_tuple_size_) {  // larger than one page size
+      free_from(0);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+
+  auto first_rid = rids->size();
+  rids->resize(first_rid + tuples.size());
+  uint32_t num_inserted = 0;
+  while (num_inserted < tuples.size()) {
+    const Tuple *batch = tuples.data() + num_inserted;
+    RID *batch_rids = rids->data() + first_rid + num_inserted;
+    auto batch_size = static_cast<uint32_t>(tuples.size() - num_inserted);
+    // Fill the next page with room for the first remaining tuple, under a single latch acquisition.
+    auto page_id = layout_ == TableLayout::ROW ? free_space_map_->FindPage(TablePage::GetRequiredSpace(batch->size_))
+                                               : INVALID_PAGE_ID;
+    if (page_id == INVALID_PAGE_ID) {
+      auto inserted = layout_ == TableLayout::PAX ? InsertIntoNewPage<PaxPage>(batch, batch_size, batch_rids, txn)
+                                                  : InsertIntoNewPage<TablePage>(batch, batch_size, batch_rids, txn);
+      if (inserted == 0) {
+        rids->resize(first_rid + num_inserted);
+        free_from(num_inserted);
+        return false;
+      }
+      num_inserted += inserted;
+      continue;
+    }
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr) {
+      rids->resize(first_rid + num_inserted);
+      free_from(num_inserted);
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+    auto inserted = cur_page->InsertTuples(batch, batch_size, batch_rids, txn, lock_manager_, log_manager_);
+    free_space_map_->Update(cur_page);
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted > 0);
+    // Update the transaction's write set.
+    for (uint32_t i = 0; i < inserted; i++) {
+      txn->GetWriteSet()->emplace_back(batch_rids[i], WType::INSERT, Tuple{}, this);
+    }
+    num_inserted += inserted;
+  }
+  return true;
+}
+
+template <class PageType>
+uint32_t TableHeap::InsertIntoNewPage(const Tuple *tuples, uint32_t count, RID *rids, Transaction *txn) {
+  auto inserted = InsertIntoLastPage<PageType>(
+      [&](PageType *page) { return page->InsertTuples(tuples, count, rids, txn, lock_manager_, log_manager_); }, txn);
+  // Update the transaction's write set.
+  for (uint32_t i = 0; i < inserted; i++) {
+    txn->GetWriteSet()->emplace_back(rids[i], WType::INSERT, Tuple{}, this);
+  }
+  return inserted;
+}
+
+template <class PageType, class InsertFunc>
+uint32_t TableHeap::InsertIntoLastPage(InsertFunc &&insert, Transaction *txn) {
+  std::scoped_lock extend_lock{extend_latch_};
+  // Another insert may have grown the table while we were waiting, so try the last page first.
+  auto cur_page = reinterpret_cast<PageType *>(buffer_pool_manager_->FetchPage(free_space_map_->GetLastPageId()));
+  if (cur_page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return 0;
+  }
+  cur_page->WLatch();
+  uint32_t inserted = insert(cur_page);
+  if (inserted == 0) {
+    page_id_t next_page_id;
+    auto new_page = reinterpret_cast<PageType *>(buffer_pool_manager_->NewPage(&next_page_id));
+    // If we could not create a new page,
+    if (new_page == nullptr) {
+      // Then life sucks and we abort the transaction.
+      cur_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+      txn->SetState(TransactionState::ABORTED);
+      return 0;
+    }
+    // Otherwise we were able to create a new page. We initialize it and start tracking it before linking it in.
+    new_page->WLatch();
+    InitPage(new_page, next_page_id, cur_page->GetTablePageId(), txn);
+    if (!TrackPage(new_page)) {
+      new_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      buffer_pool_manager_->DeletePage(next_page_id);
       cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+      txn->SetState(TransactionState::ABORTED);
+      return 0;
     }
+    cur_page->SetNextPageId(next_page_id);
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+    cur_page = new_page;
+    inserted = insert(cur_page);
+    BUSTUB_ASSERT(inserted > 0, "A tuple that is not too large should fit into an empty page.");
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
+  UpdateFreeSpace(cur_page);
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
-  return true;
+  return inserted;
 }
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
@@ -101,94 +308,429 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  ForLayout(page, [&](auto *table_page) { table_page->MarkDelete(rid, txn, lock_manager_, log_manager_); });
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  // Every version of a tuple owns its overflow pages: the old version keeps them until the update commits (see
+  // ApplyUpdate), the new one gets pages of its own even if it was read from this table.
+  Tuple detoasted;
+  bool has_external = HasExternalValues(tuple);
+  if (has_external) {
+    detoasted = tuple;
+    if (!Detoast(&detoasted, txn)) {
+      return false;
+    }
+  }
+  const Tuple &value = has_external ? detoasted : tuple;
+  // Move the large values of the new tuple out of line first.
+  Tuple toasted;
+  bool needs_toast = NeedsToast(value);
+  if (needs_toast && !ToastTuple(value, &toasted)) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  Tuple old_tuple;
+  if (!ReplaceTuple(needs_toast ? toasted : value, rid, &old_tuple, txn)) {
+    FreeExternalValues(toasted);
+    return false;
+  }
+  if (old_tuple.data_ == nullptr) {
+    return false;
+  }
+  // Update the transaction's write set.
+  if (txn->GetState() != TransactionState::ABORTED) {
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  }
+  return true;
+}
+
+void TableHeap::ApplyUpdate(const Tuple &old_tuple) {
+  // The old version is gone for good, and so are its values stored out of line.
+  FreeExternalValues(old_tuple);
+}
+
+void TableHeap::RollbackUpdate(const RID &rid, const Tuple &old_tuple, Transaction *txn) {
+  // The old version is put back as it was, external pointers included, and the new version is gone for good.
+  Tuple new_tuple;
+  bool is_updated = ReplaceTuple(old_tuple, rid, &new_tuple, txn);
+  BUSTUB_ASSERT(is_updated, "Couldn't roll back an update.");
+  FreeExternalValues(new_tuple);
+}
+
+bool TableHeap::ReplaceTuple(const Tuple &new_tuple, const RID &rid, Tuple *old_tuple, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Update the tuple; but first save the old value for rollbacks.
-  Tuple old_tuple;
+  // Update the tuple; but first save the old value for rollbacks. A moved tuple's old value is at the page its stub
+  // points to, it is read once the tuple has a new place.
+  Tuple replaced_stub;
+  RID forward_rid;
+  bool forwarded = false;
+  // Rollbacks run in aborted transactions, only an update that aborts its transaction gives up on moving the tuple.
+  bool rollback = txn->GetState() == TransactionState::ABORTED;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  bool is_updated;
+  if (layout_ == TableLayout::PAX) {
+    is_updated = reinterpret_cast<PaxPage *>(page)->UpdateTuple(new_tuple, old_tuple, rid, txn, lock_manager_,
+                                                                log_manager_);
+  } else {
+    auto table_page = reinterpret_cast<TablePage *>(page);
+    forwarded = table_page->GetForwardRid(rid, &forward_rid);
+    is_updated = table_page->UpdateTuple(new_tuple, forwarded ? &replaced_stub : old_tuple, rid, txn, lock_manager_,
+                                         log_manager_);
+    if (is_updated) {
+      UpdateFreeSpace(table_page);
+    }
+  }
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
-  // Update the transaction's write set.
-  if (is_updated && txn->GetState() != TransactionState::ABORTED) {
-    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), is_updated);
+
+  // The new tuple does not fit into the page: move it to another one and leave a stub in its place.
+  if (!is_updated && layout_ == TableLayout::ROW && (rollback || txn->GetState() != TransactionState::ABORTED)) {
+    RID moved_rid;
+    if (InsertMovedTuple(new_tuple, &moved_rid, txn)) {
+      page = buffer_pool_manager_->FetchPage(rid.GetPageId());
+      BUSTUB_ASSERT(page != nullptr, "The page of the tuple was just fetched.");
+      page->WLatch();
+      auto table_page = reinterpret_cast<TablePage *>(page);
+      is_updated = table_page->ForwardTuple(rid, moved_rid, forwarded ? &replaced_stub : old_tuple, txn,
+                                            lock_manager_, log_manager_);
+      if (is_updated) {
+        UpdateFreeSpace(table_page);
+      }
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(rid.GetPageId(), is_updated);
+      if (!is_updated) {
+        RemoveMovedTuple(moved_rid);
+      }
+    }
+  }
+  if (!is_updated) {
+    return false;
+  }
+
+  // A stub now points elsewhere or the tuple is back in its page, either way the previous place is no longer needed.
+  if (forwarded) {
+    bool read_old = GetMovedTuple(forward_rid, rid, old_tuple, txn);
+    RemoveMovedTuple(forward_rid);
+    if (!read_old) {
+      *old_tuple = Tuple();
+    }
+  }
+  return true;
+}
+
+bool TableHeap::InsertMovedTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+  // Like InsertTuple, but without locking, logging or a write set entry: the stub is what the update changes.
+  if (tuple.size_ > max_tuple_size_) {  // larger than one page size
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  uint32_t required_space = TablePage::GetRequiredSpace(tuple.size_);
+  for (auto page_id = free_space_map_->FindPage(required_space); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map_->FindPage(required_space)) {
+    auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (cur_page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+    bool inserted = cur_page->InsertMovedTuple(tuple, rid);
+    free_space_map_->Update(cur_page);
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      return true;
+    }
+  }
+  return InsertIntoLastPage<TablePage>([&](TablePage *page) { return page->InsertMovedTuple(tuple, rid) ? 1 : 0; },
+                                       txn) == 1;
+}
+
+bool TableHeap::GetMovedTuple(const RID &moved_rid, const RID &rid, Tuple *tuple, Transaction *txn) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(moved_rid.GetPageId()));
+  if (page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
   }
-  return is_updated;
+  // rid may be the rid of the tuple itself, which reading the tuple overwrites.
+  RID stub_rid = rid;
+  page->RLatch();
+  bool res = page->GetMovedTuple(moved_rid, tuple);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(moved_rid.GetPageId(), false);
+  tuple->rid_ = stub_rid;
+  return res;
+}
+
+void TableHeap::RemoveMovedTuple(const RID &moved_rid, Tuple *removed_tuple) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(moved_rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find the page of a moved tuple.");
+  page->WLatch();
+  page->RemoveMovedTuple(moved_rid, removed_tuple);
+  UpdateFreeSpace(page);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(moved_rid.GetPageId(), true);
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
+  Tuple deleted_tuple;
+  RID forward_rid;
+  bool forwarded = false;
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
+  if (layout_ == TableLayout::PAX) {
+    auto table_page = reinterpret_cast<PaxPage *>(page);
+    table_page->ApplyDelete(rid, txn, log_manager_);
+  } else {
+    auto table_page = reinterpret_cast<TablePage *>(page);
+    forwarded = table_page->GetForwardRid(rid, &forward_rid);
+    table_page->ApplyDelete(rid, txn, log_manager_, &deleted_tuple);
+    UpdateFreeSpace(table_page);
+  }
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  // Only the stub of a moved tuple was in the page.
+  if (forwarded) {
+    RemoveMovedTuple(forward_rid, &deleted_tuple);
+  }
+  // The tuple is gone for good, and so are its values stored out of line.
+  if (deleted_tuple.data_ != nullptr) {
+    FreeExternalValues(deleted_tuple);
+  }
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  ForLayout(page, [&](auto *table_page) { table_page->RollbackDelete(rid, txn, log_manager_); });
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
 }
 
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   // Find the page which contains the tuple.
-  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  auto page = buffer_pool_manager_->FetchPage(rid.GetPageId());
   // If the page could not be found, then abort the transaction.
   if (page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
   // Read the tuple from the page.
+  RID forward_rid;
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res = layout_ == TableLayout::PAX
+                 ? reinterpret_cast<PaxPage *>(page)->GetTuple(rid, tuple, txn, lock_manager_)
+                 : reinterpret_cast<TablePage *>(page)->GetTuple(rid, tuple, txn, lock_manager_, &forward_rid);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  // A tuple moved by an update is read from where its stub points, one page latch at a time.
+  if (res && forward_rid.GetPageId() != INVALID_PAGE_ID) {
+    return GetMovedTuple(forward_rid, rid, tuple, txn);
+  }
   return res;
 }
 
+bool TableHeap::GetValue(const Tuple &tuple, uint32_t column_idx, Value *value, Transaction *txn) {
+  BUSTUB_ASSERT(schema_ != nullptr, "Reading values needs the schema of the table.");
+  const Schema *schema = schema_.get();
+  const char *varlen = schema->GetColumnLayout(column_idx).inlined_ ? nullptr : tuple.GetDataPtr(schema, column_idx);
+  if (varlen == nullptr || !OverflowStore::IsExternal(varlen)) {
+    *value = tuple.GetValue(schema, column_idx);
+    return true;
+  }
+  uint32_t len = OverflowStore::GetExternalLength(varlen);
+  std::unique_ptr<char[]> data(new char[len]);
+  if (!overflow_store_.Read(OverflowStore::GetExternalPageId(varlen), len, data.get())) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  *value = ValueFactory::GetVarcharValue(data.get(), len, true);
+  return true;
+}
+
+bool TableHeap::Detoast(Tuple *tuple, Transaction *txn) {
+  BUSTUB_ASSERT(schema_ != nullptr, "Reading values needs the schema of the table.");
+  if (!HasExternalValues(*tuple)) {
+    return true;
+  }
+  const Schema *schema = schema_.get();
+  std::vector<Value> values(schema->GetColumnCount());
+  for (uint32_t i = 0; i < values.size(); i++) {
+    if (!GetValue(*tuple, i, &values[i], txn)) {
+      return false;
+    }
+  }
+  RID rid = tuple->rid_;
+  *tuple = Tuple(values, schema);
+  tuple->rid_ = rid;
+  return true;
+}
+
+bool TableHeap::ToastTuple(const Tuple &tuple, Tuple *toasted) {
+  const Schema *schema = schema_.get();
+  // Pick the values to move out, largest first, until the tuple is small enough.
+  std::vector<std::pair<uint32_t, uint32_t>> candidates;
+  for (auto col_idx : schema->GetUnlinedColumns()) {
+    uint32_t size = GetStoredVarlenSize(tuple.GetDataPtr(schema, col_idx));
+    if (size > OverflowStore::EXTERNAL_POINTER_SIZE && !OverflowStore::IsExternal(tuple.GetDataPtr(schema, col_idx))) {
+      candidates.emplace_back(size, col_idx);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), std::greater<>());
+  std::vector<bool> external(schema->GetColumnCount(), false);
+  uint32_t toasted_size = tuple.size_;
+  for (const auto &[size, col_idx] : candidates) {
+    if (toasted_size <= TOAST_THRESHOLD) {
+      break;
+    }
+    external[col_idx] = true;
+    toasted_size -= size - OverflowStore::EXTERNAL_POINTER_SIZE;
+  }
+
+  // The fixed-size part and the null bitmap stay as they are; the payload is rebuilt with pointers in place of the
+  // moved values.
+  if (toasted->allocated_) {
+    delete[] toasted->data_;
+  }
+  toasted->size_ = toasted_size;
+  toasted->data_ = new char[toasted_size];
+  toasted->allocated_ = true;
+  toasted->rid_ = tuple.rid_;
+  memcpy(toasted->data_, tuple.data_, schema->GetLength());
+  uint32_t offset = schema->GetLength();
+  std::vector<page_id_t> chains;
+  for (auto col_idx : schema->GetUnlinedColumns()) {
+    const char *varlen = tuple.GetDataPtr(schema, col_idx);
+    memcpy(toasted->data_ + schema->GetColumnLayout(col_idx).offset_, &offset, sizeof(uint32_t));
+    if (external[col_idx]) {
+      uint32_t len = *reinterpret_cast<const uint32_t *>(varlen);
+      page_id_t first_page_id;
+      if (!overflow_store_.Write(varlen + sizeof(uint32_t), len, &first_page_id)) {
+        std::for_each(chains.begin(), chains.end(), [&](page_id_t page_id) { overflow_store_.Free(page_id); });
+        return false;
+      }
+      chains.push_back(first_page_id);
+      OverflowStore::SetExternal(toasted->data_ + offset, len, first_page_id);
+      offset += OverflowStore::EXTERNAL_POINTER_SIZE;
+    } else {
+      uint32_t size = GetStoredVarlenSize(varlen);
+      memcpy(toasted->data_ + offset, varlen, size);
+      offset += size;
+    }
+  }
+  return true;
+}
+
+bool TableHeap::HasExternalValues(const Tuple &tuple) const {
+  if (tuple.data_ == nullptr || schema_ == nullptr || layout_ != TableLayout::ROW) {
+    return false;
+  }
+  const Schema *schema = schema_.get();
+  const auto &columns = schema->GetUnlinedColumns();
+  return std::any_of(columns.begin(), columns.end(), [&](uint32_t col_idx) {
+    return OverflowStore::IsExternal(tuple.GetDataPtr(schema, col_idx));
+  });
+}
+
+void TableHeap::FreeExternalValues(const Tuple &tuple) {
+  if (tuple.data_ == nullptr || schema_ == nullptr || layout_ != TableLayout::ROW) {
+    return;
+  }
+  const Schema *schema = schema_.get();
+  for (auto col_idx : schema->GetUnlinedColumns()) {
+    const char *varlen = tuple.GetDataPtr(schema, col_idx);
+    if (OverflowStore::IsExternal(varlen)) {
+      overflow_store_.Free(OverflowStore::GetExternalPageId(varlen));
+    }
+  }
+}
+
+bool TableHeap::ScanEquals(uint32_t column_idx, const Value &value, std::vector<RID> *rids, Transaction *txn) {
+  BUSTUB_ASSERT(schema_ != nullptr && layout_ == TableLayout::ROW, "Only row tables with a schema can be scanned.");
+  const auto &column = schema_->GetColumn(column_idx);
+  BUSTUB_ASSERT(column.GetType() == TypeId::VARCHAR, "Only VARCHAR columns can be scanned.");
+  if (value.IsNull()) {
+    return true;
+  }
+  std::vector<RID> external_rids;
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->RLatch();
+    page->FindEqual(column.GetOffset(), value.GetData(), value.GetLength(), rids, &external_rids, txn, lock_manager_);
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  // Values stored out of line are compared once the page latches are released, reading them latches other pages.
+  for (const auto &rid : external_rids) {
+    Tuple tuple;
+    Value stored;
+    if (!GetTuple(rid, &tuple, txn) || !GetValue(tuple, column_idx, &stored, txn)) {
+      return false;
+    }
+    if (stored.CompareEquals(value) == CmpBool::CmpTrue) {
+      rids->push_back(rid);
+    }
+  }
+  return true;
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = buffer_pool_manager_->FetchPage(page_id);
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = ForLayout(page, [&](auto *table_page) { return table_page->GetFirstTupleRid(&rid); });
+    auto next_page_id = ForLayout(page, [](auto *table_page) { return table_page->GetNextPageId(); });
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = next_page_id;
   }
   return TableIterator(this, rid, txn);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
+ColumnIterator TableHeap::ScanColumns(const Schema *schema, std::vector<uint32_t> column_ids, Transaction *txn) {
+  return ColumnIterator(this, schema, std::move(column_ids), txn);
+}
+
+TupleViewIterator TableHeap::ScanViews(Transaction *txn) { return TupleViewIterator(this, txn); }
+
+std::unique_ptr<ParallelScan> TableHeap::CreateParallelScan(uint32_t worker_count) {
+  return std::make_unique<ParallelScan>(this, worker_count);
+}
+
 }  // namespace bustub
@@ -35,32 +35,35 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  auto cur_page = buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId());
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
 
   RID next_tuple_rid;
-  if (!cur_page->GetNextTupleRid(tuple_->rid_,
-                                 &next_tuple_rid)) {  // end of this page
-    while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+  auto get_next_page_id = [](auto *page) { return page->GetNextPageId(); };
+  if (!table_heap_->ForLayout(cur_page, [&](auto *page) {
+        return page->GetNextTupleRid(tuple_->rid_, &next_tuple_rid);
+      })) {  // end of this page
+    page_id_t next_page_id;
+    while ((next_page_id = table_heap_->ForLayout(cur_page, get_next_page_id)) != INVALID_PAGE_ID) {
+      auto next_page = buffer_pool_manager->FetchPage(next_page_id);
       cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+      buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
       cur_page = next_page;
       cur_page->RLatch();
-      if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
+      if (table_heap_->ForLayout(cur_page, [&](auto *page) { return page->GetFirstTupleRid(&next_tuple_rid); })) {
         break;
       }
     }
   }
   tuple_->rid_ = next_tuple_rid;
+  cur_page->RUnlatch();
+  buffer_pool_manager->UnpinPage(cur_page->GetPageId(), false);
 
+  // Read the tuple with the page released, a tuple moved by an update is read from another page.
   if (*this != table_heap_->End()) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
   return *this;
 }
 
@@ -16,23 +16,42 @@
 #include <string>
 #include <vector>
 
+#include "common/exception.h"
+#include "storage/table/overflow_store.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
-// TODO(Amadou): It does not look like nulls are supported. Add a null bitmap?
-Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true) {
+namespace {
+
+/** Throws if a serialized value is an external pointer, whose length would read as a value of about 2 GB. */
+void CheckNotExternal(const char *data_ptr, TypeId type) {
+  if (type == TypeId::VARCHAR && OverflowStore::IsExternal(data_ptr)) {
+    throw Exception(ExceptionType::INVALID,
+                    "VARCHAR value stored out of line, read it through TableHeap::GetValue or TableHeap::Detoast.");
+  }
+}
+
+/** @return the number of bytes a variable-length value takes in the tuple payload, a NULL only stores its length */
+uint32_t GetSerializedVarlenSize(const Value &value) {
+  return sizeof(uint32_t) + (value.IsNull() ? 0 : value.GetLength());
+}
+
+}  // namespace
+
+Tuple::Tuple(std::vector<Value> values, const Schema *schema, AbstractPool *pool) : allocated_(pool == nullptr) {
   assert(values.size() == schema->GetColumnCount());
 
   // 1. Calculate the size of the tuple.
   uint32_t tuple_size = schema->GetLength();
   for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    tuple_size += GetSerializedVarlenSize(values[i]);
   }
 
   // 2. Allocate memory.
   size_ = tuple_size;
-  data_ = new char[size_];
+  data_ = allocated_ ? new char[size_] : static_cast<char *>(pool->Allocate(size_));
   std::memset(data_, 0, size_);
 
   // 3. Serialize each attribute based on the input value.
@@ -46,10 +65,13 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
       *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
       values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      offset += GetSerializedVarlenSize(values[i]);
     } else {
       values[i].SerializeTo(data_ + col.GetOffset());
     }
+    if (values[i].IsNull()) {
+      data_[schema->GetNullBitmapOffset() + i / 8] |= static_cast<char>(1U << (i % 8));
+    }
   }
 }
 
@@ -87,15 +109,58 @@ Tuple &Tuple::operator=(const Tuple &other) {
   return *this;
 }
 
-Value Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const {
+Tuple::Tuple(Tuple &&other) noexcept
+    : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), data_(other.data_) {
+  other.allocated_ = false;
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+Tuple &Tuple::operator=(Tuple &&other) noexcept {
+  if (this != &other) {
+    if (allocated_) {
+      delete[] data_;
+    }
+    allocated_ = other.allocated_;
+    rid_ = other.rid_;
+    size_ = other.size_;
+    data_ = other.data_;
+    other.allocated_ = false;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+Value Tuple::GetValue(const char *data, const Schema *schema, const uint32_t column_idx) {
   assert(schema);
-  assert(data_);
-  const TypeId column_type = schema->GetColumn(column_idx).GetType();
-  const char *data_ptr = GetDataPtr(schema, column_idx);
+  assert(data);
+  const TypeId column_type = schema->GetColumnLayout(column_idx).type_;
+  if (IsNull(data, schema, column_idx)) {
+    return ValueFactory::GetNullValueByType(column_type);
+  }
+  const char *data_ptr = GetDataPtr(data, schema, column_idx);
+  CheckNotExternal(data_ptr, column_type);
   // the third parameter "is_inlined" is unused
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
+Value Tuple::GetValue(const Schema *schema, const uint32_t column_idx, AbstractPool *pool) const {
+  assert(schema);
+  assert(data_);
+  const TypeId column_type = schema->GetColumnLayout(column_idx).type_;
+  if (IsNull(schema, column_idx)) {
+    return ValueFactory::GetNullValueByType(column_type);
+  }
+  const char *data_ptr = GetDataPtr(schema, column_idx);
+  CheckNotExternal(data_ptr, column_type);
+  if (column_type != TypeId::VARCHAR || pool == nullptr) {
+    return Value::DeserializeFrom(data_ptr, column_type);
+  }
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data_ptr);
+  return ValueFactory::GetVarcharValue(data_ptr + sizeof(uint32_t), len, false, pool);
+}
+
 Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
   std::vector<Value> values;
   values.reserve(key_attrs.size());
@@ -105,19 +170,18 @@ Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const
   return Tuple(values, &key_schema);
 }
 
-const char *Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const {
+const char *Tuple::GetDataPtr(const char *data, const Schema *schema, const uint32_t column_idx) {
   assert(schema);
-  assert(data_);
-  const auto &col = schema->GetColumn(column_idx);
-  bool is_inlined = col.IsInlined();
+  assert(data);
+  const auto &layout = schema->GetColumnLayout(column_idx);
   // For inline type, data is stored where it is.
-  if (is_inlined) {
-    return (data_ + col.GetOffset());
+  if (layout.inlined_) {
+    return (data + layout.offset_);
   }
   // We read the relative offset from the tuple data.
-  int32_t offset = *reinterpret_cast<int32_t *>(data_ + col.GetOffset());
+  int32_t offset = *reinterpret_cast<const int32_t *>(data + layout.offset_);
   // And return the beginning address of the real data for the VARCHAR type.
-  return (data_ + offset);
+  return (data + offset);
 }
 
 std::string Tuple::ToString(const Schema *schema) const {
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view.cpp
+//
+// Identification: src/storage/table/tuple_view.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tuple_view.h"
+
+#include <cstring>
+#include <string>
+
+namespace bustub {
+
+Value TupleView::GetValue(const Schema *schema, const uint32_t column_idx) const {
+  return Tuple::GetValue(data_, schema, column_idx);
+}
+
+Tuple TupleView::Materialize() const {
+  Tuple tuple(rid_);
+  tuple.size_ = size_;
+  tuple.data_ = new char[size_];
+  memcpy(tuple.data_, data_, size_);
+  tuple.allocated_ = true;
+  return tuple;
+}
+
+std::string TupleView::ToString(const Schema *schema) const {
+  // A shallow tuple aliases our data without copying it.
+  Tuple alias;
+  alias.data_ = const_cast<char *>(data_);
+  alias.size_ = size_;
+  alias.rid_ = rid_;
+  return alias.ToString(schema);
+}
+
+}  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view_iterator.cpp
+//
+// Identification: src/storage/table/tuple_view_iterator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tuple_view_iterator.h"
+
+#include "storage/table/parallel_scan.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+TupleViewIterator::TupleViewIterator(TableHeap *table_heap, Transaction *txn)
+    : table_heap_(table_heap), txn_(txn), next_page_id_(table_heap->GetFirstPageId()) {}
+
+TupleViewIterator::TupleViewIterator(TableHeap *table_heap, ParallelScan *parallel_scan, Transaction *txn)
+    : table_heap_(table_heap), txn_(txn), next_page_id_(INVALID_PAGE_ID), parallel_scan_(parallel_scan) {}
+
+bool TupleViewIterator::Next(TupleView *view) {
+  while (true) {
+    bool found;
+    if (!page_.IsValid()) {
+      // Between pages, produce the tuples of the previous page that were moved to other pages by updates.
+      if (!forwarded_rids_.empty()) {
+        RID rid = forwarded_rids_.back();
+        forwarded_rids_.pop_back();
+        if (table_heap_->GetTuple(rid, &buffer_, txn_)) {
+          *view = TupleView(buffer_);
+          return true;
+        }
+        continue;
+      }
+      if (next_page_id_ == INVALID_PAGE_ID && !ClaimPage()) {
+        return false;
+      }
+      page_ = PageGuard(table_heap_->buffer_pool_manager_, next_page_id_);
+      BUSTUB_ASSERT(page_.IsValid(), "Couldn't fetch a page of the table heap.");
+      page_.GetPage()->RLatch();
+      found = table_heap_->ForLayout(page_.GetPage(),
+                                     [this](auto *table_page) { return table_page->GetFirstTupleRid(&rid_); });
+    } else {
+      page_.GetPage()->RLatch();
+      found = table_heap_->ForLayout(page_.GetPage(),
+                                     [this](auto *table_page) { return table_page->GetNextTupleRid(rid_, &rid_); });
+    }
+
+    if (!found) {
+      // The page is exhausted, move on to the next one. A parallel scan claims it once the moved tuples are read.
+      next_page_id_ = INVALID_PAGE_ID;
+      if (parallel_scan_ == nullptr) {
+        next_page_id_ =
+            table_heap_->ForLayout(page_.GetPage(), [](auto *table_page) { return table_page->GetNextPageId(); });
+      }
+      page_.GetPage()->RUnlatch();
+      page_.Release();
+      continue;
+    }
+    page_.GetPage()->RUnlatch();
+
+    // Lock the tuple before reading it, without the latch: the lock may wait for a writer, which needs the latch to
+    // commit or roll back. The tuple is then read as the writer left it.
+    if (!LockTuple()) {
+      continue;
+    }
+    page_.GetPage()->RLatch();
+    auto read = [this, view](auto *table_page) { return ReadTuple(table_page, view); };
+    bool is_read = table_heap_->ForLayout(page_.GetPage(), read);
+    page_.GetPage()->RUnlatch();
+    if (is_read) {
+      return true;
+    }
+  }
+}
+
+bool TupleViewIterator::LockTuple() {
+  if (!enable_logging || txn_->IsSharedLocked(rid_) || txn_->IsExclusiveLocked(rid_)) {
+    return true;
+  }
+  return table_heap_->lock_manager_->LockShared(txn_, rid_);
+}
+
+bool TupleViewIterator::ClaimPage() {
+  if (parallel_scan_ == nullptr) {
+    return false;
+  }
+  if (morsel_position_ == morsel_.size()) {
+    if (!parallel_scan_->NextMorsel(&morsel_)) {
+      return false;
+    }
+    morsel_position_ = 0;
+  }
+  next_page_id_ = morsel_[morsel_position_++];
+  return true;
+}
+
+bool TupleViewIterator::ReadTuple(TablePage *page, TupleView *view) {
+  // A moved tuple is read once the tuples of this page are done, from the page it was moved to.
+  RID forward_rid;
+  if (page->GetForwardRid(rid_, &forward_rid)) {
+    forwarded_rids_.push_back(rid_);
+    return false;
+  }
+  if (!page->HasDictionary()) {
+    return page->GetTupleView(rid_, view, txn_, table_heap_->lock_manager_);
+  }
+  // Dictionary-encoded tuples have to be decoded out of the page.
+  if (!page->GetTuple(rid_, &buffer_, txn_, table_heap_->lock_manager_)) {
+    return false;
+  }
+  *view = TupleView(buffer_);
+  return true;
+}
+
+bool TupleViewIterator::ReadTuple(PaxPage *page, TupleView *view) {
+  if (!page->GetTuple(rid_, &buffer_, txn_, table_heap_->lock_manager_)) {
+    return false;
+  }
+  *view = TupleView(buffer_);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena_pool.cpp
+//
+// Identification: src/type/arena_pool.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "type/arena_pool.h"
+
+namespace bustub {
+
+ArenaPool::ArenaPool(size_t block_size) : block_size_(block_size) {
+  BUSTUB_ASSERT(block_size_ >= ALIGNMENT, "Blocks must be able to hold at least one allocation.");
+}
+
+void *ArenaPool::Allocate(size_t size) {
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  allocated_bytes_ += size;
+
+  if (size > block_size_ / 4) {
+    large_blocks_.emplace_back(std::unique_ptr<char[]>(new char[size]), size);
+    return large_blocks_.back().first.get();
+  }
+
+  if (blocks_.empty() || offset_ + size > block_size_) {
+    // Move on to the next block, reusing blocks left over from before the last reset.
+    if (!blocks_.empty()) {
+      current_block_++;
+    }
+    if (current_block_ == blocks_.size()) {
+      blocks_.emplace_back(new char[block_size_]);
+    }
+    offset_ = 0;
+  }
+  void *ptr = blocks_[current_block_].get() + offset_;
+  offset_ += size;
+  return ptr;
+}
+
+void ArenaPool::Reset() {
+  large_blocks_.clear();
+  current_block_ = 0;
+  offset_ = 0;
+  allocated_bytes_ = 0;
+}
+
+size_t ArenaPool::GetReservedBytes() const {
+  size_t reserved = blocks_.size() * block_size_;
+  for (const auto &block : large_blocks_) {
+    reserved += block.second;
+  }
+  return reserved;
+}
+
+}  // namespace bustub
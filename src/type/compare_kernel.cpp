@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compare_kernel.cpp
+//
+// Identification: src/type/compare_kernel.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "type/compare_kernel.h"
+
+namespace bustub {
+
+namespace {
+
+template <TypeId L, TypeId R>
+CompareKernelFns KernelFns() {
+  return {&CompareKernel<L, R>::CompareValues, &CompareKernel<L, R>::CompareSerialized};
+}
+
+/** Select the kernel for a numeric left-hand side of type L. */
+template <TypeId L>
+CompareKernelFns NumericKernelFns(TypeId right) {
+  switch (right) {
+    case TypeId::TINYINT:
+      return KernelFns<L, TypeId::TINYINT>();
+    case TypeId::SMALLINT:
+      return KernelFns<L, TypeId::SMALLINT>();
+    case TypeId::INTEGER:
+      return KernelFns<L, TypeId::INTEGER>();
+    case TypeId::BIGINT:
+      return KernelFns<L, TypeId::BIGINT>();
+    case TypeId::DECIMAL:
+      return KernelFns<L, TypeId::DECIMAL>();
+    default:
+      return {};
+  }
+}
+
+}  // namespace
+
+CompareKernelFns GetCompareKernel(TypeId left, TypeId right) {
+  switch (left) {
+    case TypeId::TINYINT:
+      return NumericKernelFns<TypeId::TINYINT>(right);
+    case TypeId::SMALLINT:
+      return NumericKernelFns<TypeId::SMALLINT>(right);
+    case TypeId::INTEGER:
+      return NumericKernelFns<TypeId::INTEGER>(right);
+    case TypeId::BIGINT:
+      return NumericKernelFns<TypeId::BIGINT>(right);
+    case TypeId::DECIMAL:
+      return NumericKernelFns<TypeId::DECIMAL>(right);
+    case TypeId::BOOLEAN:
+      return right == TypeId::BOOLEAN ? KernelFns<TypeId::BOOLEAN, TypeId::BOOLEAN>() : CompareKernelFns{};
+    case TypeId::TIMESTAMP:
+      return right == TypeId::TIMESTAMP ? KernelFns<TypeId::TIMESTAMP, TypeId::TIMESTAMP>() : CompareKernelFns{};
+    case TypeId::VARCHAR:
+      return right == TypeId::VARCHAR ? KernelFns<TypeId::VARCHAR, TypeId::VARCHAR>() : CompareKernelFns{};
+    default:
+      return {};
+  }
+}
+
+}  // namespace bustub
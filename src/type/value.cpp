@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <cstddef>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -18,34 +20,6 @@
 #include "type/value.h"
 
 namespace bustub {
-Value::Value(const Value &other) {
-  type_id_ = other.type_id_;
-  size_ = other.size_;
-  manage_data_ = other.manage_data_;
-  value_ = other.value_;
-  switch (type_id_) {
-    case TypeId::VARCHAR:
-      if (size_.len_ == BUSTUB_VALUE_NULL) {
-        value_.varlen_ = nullptr;
-      } else {
-        if (manage_data_) {
-          value_.varlen_ = new char[size_.len_];
-          memcpy(value_.varlen_, other.value_.varlen_, size_.len_);
-        } else {
-          value_ = other.value_;
-        }
-      }
-      break;
-    default:
-      value_ = other.value_;
-  }
-}
-
-Value &Value::operator=(Value other) {
-  Swap(*this, other);
-  return *this;
-}
-
 // BOOLEAN and TINYINT
 Value::Value(TypeId type, int8_t i) : Value(type) {
   switch (type) {
@@ -217,19 +191,13 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
       if (data == nullptr) {
         value_.varlen_ = nullptr;
         size_.len_ = BUSTUB_VALUE_NULL;
+      } else if (manage_data) {
+        assert(len < BUSTUB_VARCHAR_MAX_LEN);
+        StoreVarlen(data, len);
       } else {
-        manage_data_ = manage_data;
-        if (manage_data_) {
-          assert(len < BUSTUB_VARCHAR_MAX_LEN);
-          value_.varlen_ = new char[len];
-          assert(value_.varlen_ != nullptr);
-          size_.len_ = len;
-          memcpy(value_.varlen_, data, len);
-        } else {
-          // FUCK YOU GCC I do what I want.
-          value_.const_varlen_ = data;
-          size_.len_ = len;
-        }
+        // FUCK YOU GCC I do what I want.
+        value_.const_varlen_ = data;
+        size_.len_ = len;
       }
       break;
     default:
@@ -240,13 +208,8 @@ Value::Value(TypeId type, const char *data, uint32_t len, bool manage_data) : Va
 Value::Value(TypeId type, const std::string &data) : Value(type) {
   switch (type) {
     case TypeId::VARCHAR: {
-      manage_data_ = true;
       // TODO(TAs): How to represent a null string here?
-      uint32_t len = static_cast<uint32_t>(data.length()) + 1;
-      value_.varlen_ = new char[len];
-      assert(value_.varlen_ != nullptr);
-      size_.len_ = len;
-      memcpy(value_.varlen_, data.c_str(), len);
+      StoreVarlen(data.c_str(), static_cast<uint32_t>(data.length()) + 1);
       break;
     }
     default:
@@ -254,16 +217,30 @@ Value::Value(TypeId type, const std::string &data) : Value(type) {
   }
 }
 
-// delete allocated char array space
-Value::~Value() {
-  switch (type_id_) {
-    case TypeId::VARCHAR:
-      if (manage_data_) {
-        delete[] value_.varlen_;
-      }
-      break;
-    default:
-      break;
+void Value::StoreVarlen(const char *data, uint32_t len) {
+  // Inlined strings span value_ and size_.
+  static_assert(offsetof(Value, size_) == sizeof(Val), "size_ must directly follow value_");
+  static_assert(sizeof(Val) + sizeof(size_) == INLINE_VARCHAR_LENGTH, "inline strings must fill value_ and size_");
+  static_assert(sizeof(Value) == 16, "Values should stay compact");
+  if (len <= INLINE_VARCHAR_LENGTH) {
+    storage_ = VarlenStorage::INLINED;
+    inline_len_ = static_cast<uint8_t>(len);
+    memcpy(&value_, data, len);
+    return;
+  }
+  auto *buffer = new char[sizeof(SharedHeader) + len];
+  new (buffer) SharedHeader{{1}};
+  value_.varlen_ = buffer + sizeof(SharedHeader);
+  size_.len_ = len;
+  memcpy(value_.varlen_, data, len);
+  storage_ = VarlenStorage::SHARED;
+}
+
+void Value::ReleaseReference() {
+  auto *header = GetSharedHeader();
+  if (header->references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    header->~SharedHeader();
+    delete[] reinterpret_cast<char *>(header);
   }
 }
 
@@ -12,15 +12,17 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include "common/exception.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerTest, DISABLED_BinaryDataTest) {
+TEST(BufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -86,7 +88,7 @@ TEST(BufferPoolManagerTest, DISABLED_BinaryDataTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
+TEST(BufferPoolManagerTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -141,4 +143,65 @@ TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ReadOnlyMappedTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 3 * buffer_pool_size;
+
+  // Write more pages than fit into the buffer pool through a regular buffer pool manager.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  disk_manager->ShutDown();
+  delete bpm;
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name, true);
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  EXPECT_TRUE(disk_manager->IsReadOnly());
+  EXPECT_EQ(num_pages, disk_manager->GetMappedPageCount());
+  disk_manager->AdviseAccessPattern(AccessPattern::SEQUENTIAL);
+
+  // Scenario: every page can be pinned at once, and the pages point straight into the mapping.
+  char buf[PAGE_SIZE];
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(disk_manager->GetMappedPage(i), page->GetData());
+    EXPECT_EQ(i, page->GetPageId());
+    snprintf(buf, PAGE_SIZE, "Page %d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), buf));
+  }
+  // Scenario: fetching the same page twice returns the same page.
+  EXPECT_EQ(bpm->FetchPage(0), bpm->FetchPage(0));
+  EXPECT_EQ(nullptr, bpm->FetchPage(num_pages));
+
+  // Scenario: writes are rejected.
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(false, bpm->UnpinPage(0, true));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(false, bpm->DeletePage(0));
+  EXPECT_EQ(false, bpm->FlushPage(0));
+  EXPECT_THROW(disk_manager->WritePage(0, buf), Exception);
+
+  // Scenario: ReadPage still works, copying out of the mapping.
+  disk_manager->AdviseAccessPattern(AccessPattern::RANDOM);
+  disk_manager->ReadPage(num_pages - 1, buf);
+  EXPECT_EQ(0, memcmp(disk_manager->GetMappedPage(num_pages - 1), buf, PAGE_SIZE));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -10,19 +10,25 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "concurrency/transaction.h"
 #include "gtest/gtest.h"
+#include "storage/table/tuple_view.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(CatalogTest, DISABLED_CreateTableTest) {
+TEST(CatalogTest, CreateTableTest) {
   auto disk_manager = new DiskManager("catalog_test.db");
   auto bpm = new BufferPoolManager(32, disk_manager);
   auto catalog = new Catalog(bpm, nullptr, nullptr);
@@ -38,13 +44,525 @@ TEST(CatalogTest, DISABLED_CreateTableTest) {
 
   Schema schema(columns);
   auto *table_metadata = catalog->CreateTable(nullptr, table_name, schema);
-  (void)table_metadata;
+  ASSERT_NE(nullptr, table_metadata);
+  EXPECT_EQ(table_name, table_metadata->name_);
+  EXPECT_EQ(2, table_metadata->schema_.GetColumnCount());
+  EXPECT_EQ(TableLayout::ROW, table_metadata->table_->GetLayout());
+  EXPECT_EQ(table_metadata, catalog->GetTable(table_name));
+  EXPECT_EQ(table_metadata, catalog->GetTable(table_metadata->oid_));
 
-  // Notice that this test case doesn't check anything! :(
-  // It is up to you to extend it
+  // A second table, stored column-wise.
+  auto *pax_metadata = catalog->CreateTable(nullptr, "tomato", schema, TableLayout::PAX);
+  ASSERT_NE(nullptr, pax_metadata);
+  EXPECT_NE(table_metadata->oid_, pax_metadata->oid_);
+  EXPECT_EQ(TableLayout::PAX, pax_metadata->table_->GetLayout());
+  EXPECT_EQ(pax_metadata, catalog->GetTable("tomato"));
+  EXPECT_THROW(catalog->GetTable(pax_metadata->oid_ + 1), std::out_of_range);
 
   delete catalog;
   delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, HeaderPageTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(32, disk_manager);
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  Schema schema(columns);
+
+  // A new database gets its header page, which indexes keep their root page ids in.
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  auto txn = new Transaction(0);
+  EXPECT_EQ(1, disk_manager->GetNumPages());
+  auto *table_metadata = catalog->CreateTable(txn, "potato", schema);
+  RID rid;
+  ASSERT_TRUE(table_metadata->table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(1)}, &schema), &rid, txn));
+  catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "potato_a", "potato", schema, schema, {0}, 8);
+  delete txn;
+  delete catalog;
+  auto header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  ASSERT_NE(nullptr, header_page);
+  int num_records = header_page->GetRecordCount();
+  EXPECT_LT(0, num_records);
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+
+  // Another catalog over the same database neither takes up a page nor touches the header page.
+  auto num_pages = disk_manager->GetNumPages();
+  catalog = new Catalog(bpm, nullptr, nullptr);
+  EXPECT_EQ(num_pages, disk_manager->GetNumPages());
+  header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  EXPECT_EQ(num_records, header_page->GetRecordCount());
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  delete catalog;
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Nor does a catalog over the database opened read-only.
+  disk_manager = new DiskManager("catalog_test.db", true);
+  bpm = new BufferPoolManager(32, disk_manager);
+  catalog = new Catalog(bpm, nullptr, nullptr);
+  EXPECT_EQ(num_pages, disk_manager->GetNumPages());
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+
+  // A new database whose buffer pool is full can't get its header page.
+  disk_manager = new DiskManager("catalog_test.db");
+  bpm = new BufferPoolManager(1, disk_manager);
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_THROW(Catalog(bpm, nullptr, nullptr), Exception);
+  bpm->UnpinPage(1, false);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CreateIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  auto txn = new Transaction(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(txn, "potato", schema);
+  EXPECT_TRUE(catalog->GetTableIndexes("potato").empty());
+
+  // More keys than the index sorts in memory, in no particular order.
+  const int32_t num_rows = 10000;
+  RID rid;
+  for (int32_t i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i * 7919 % num_rows), ValueFactory::GetIntegerValue(i)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, txn));
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::INTEGER);
+  Schema key_schema(key_columns);
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "potato_a", "potato", schema,
+                                                                                   key_schema, {0}, 8);
+  ASSERT_NE(nullptr, index_info);
+  EXPECT_EQ("potato_a", index_info->name_);
+  EXPECT_EQ(index_info, catalog->GetIndex("potato_a", "potato"));
+  EXPECT_EQ(index_info, catalog->GetIndex(index_info->index_oid_));
+  EXPECT_EQ(std::vector<IndexInfo *>{index_info}, catalog->GetTableIndexes("potato"));
+  EXPECT_THROW(catalog->GetIndex("potato_b", "potato"), std::out_of_range);
+
+  // Every row can be found through the index.
+  std::vector<RID> rids;
+  for (auto iterator = table_metadata->table_->Begin(txn); iterator != table_metadata->table_->End(); ++iterator) {
+    rids.clear();
+    auto key = iterator->KeyFromTuple(schema, key_schema, {0});
+    index_info->index_->ScanKey(key, &rids, txn);
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(iterator->GetRid(), rids[0]);
+  }
+
+  // And all rows at once, plus a key that is not in the table.
+  std::vector<Tuple> keys;
+  std::vector<RID> expected_rids;
+  for (auto iterator = table_metadata->table_->Begin(txn); iterator != table_metadata->table_->End(); ++iterator) {
+    keys.push_back(iterator->KeyFromTuple(schema, key_schema, {0}));
+    expected_rids.push_back(iterator->GetRid());
+  }
+  keys.emplace_back(std::vector<Value>{ValueFactory::GetIntegerValue(num_rows)}, &key_schema);
+  std::vector<std::vector<RID>> key_rids;
+  index_info->index_->ScanKeys(keys, &key_rids, txn);
+  ASSERT_EQ(keys.size(), key_rids.size());
+  for (size_t i = 0; i < expected_rids.size(); i++) {
+    ASSERT_EQ(1, key_rids[i].size());
+    EXPECT_EQ(expected_rids[i], key_rids[i][0]);
+  }
+  EXPECT_TRUE(key_rids.back().empty());
+
+  // The keys are in order.
+  auto index = dynamic_cast<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> *>(index_info->index_.get());
+  ASSERT_NE(nullptr, index);
+  int32_t expected = 0;
+  for (auto iterator = index->GetBeginIterator(); iterator != index->GetEndIterator(); ++iterator) {
+    ASSERT_EQ(expected, (*iterator).first.ToValue(&key_schema, 0).GetAs<int32_t>());
+    expected++;
+  }
+  EXPECT_EQ(num_rows, expected);
+
+  // Range scans, by the column value of every row they return.
+  auto scan = [&](const int32_t *low, bool low_inclusive, const int32_t *high, bool high_inclusive,
+                  ScanDirection direction, size_t limit) {
+    std::optional<Tuple> low_key;
+    std::optional<Tuple> high_key;
+    if (low != nullptr) {
+      low_key.emplace(std::vector<Value>{ValueFactory::GetIntegerValue(*low)}, &key_schema);
+    }
+    if (high != nullptr) {
+      high_key.emplace(std::vector<Value>{ValueFactory::GetIntegerValue(*high)}, &key_schema);
+    }
+    std::vector<RID> result;
+    index_info->index_->ScanRange(low_key ? &*low_key : nullptr, low_inclusive, high_key ? &*high_key : nullptr,
+                                  high_inclusive, direction, limit, &result, txn);
+    std::vector<int32_t> values;
+    for (const auto &result_rid : result) {
+      Tuple tuple;
+      EXPECT_TRUE(table_metadata->table_->GetTuple(result_rid, &tuple, txn));
+      values.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    return values;
+  };
+  const int32_t low = 100;
+  const int32_t high = 105;
+  const int32_t outside = -5;
+  // BETWEEN 100 AND 105
+  EXPECT_EQ((std::vector<int32_t>{100, 101, 102, 103, 104, 105}),
+            scan(&low, true, &high, true, ScanDirection::FORWARD, SIZE_MAX));
+  EXPECT_EQ((std::vector<int32_t>{101, 102, 103, 104}), scan(&low, false, &high, false, ScanDirection::FORWARD, 100));
+  EXPECT_EQ((std::vector<int32_t>{105, 104, 103, 102, 101, 100}),
+            scan(&low, true, &high, true, ScanDirection::BACKWARD, SIZE_MAX));
+  EXPECT_EQ((std::vector<int32_t>{104, 103}), scan(&low, false, &high, false, ScanDirection::BACKWARD, 2));
+  // ORDER BY A DESC LIMIT 3, ORDER BY A LIMIT 3
+  EXPECT_EQ((std::vector<int32_t>{num_rows - 1, num_rows - 2, num_rows - 3}),
+            scan(nullptr, true, nullptr, true, ScanDirection::BACKWARD, 3));
+  EXPECT_EQ((std::vector<int32_t>{0, 1, 2}), scan(nullptr, true, nullptr, true, ScanDirection::FORWARD, 3));
+  // A < 100 ORDER BY A DESC LIMIT 2, A > 105 LIMIT 2
+  EXPECT_EQ((std::vector<int32_t>{99, 98}), scan(nullptr, true, &low, false, ScanDirection::BACKWARD, 2));
+  EXPECT_EQ((std::vector<int32_t>{106, 107}), scan(&high, false, nullptr, true, ScanDirection::FORWARD, 2));
+  // Empty ranges.
+  EXPECT_TRUE(scan(&high, true, &low, true, ScanDirection::FORWARD, SIZE_MAX).empty());
+  EXPECT_TRUE(scan(&high, true, &low, true, ScanDirection::BACKWARD, SIZE_MAX).empty());
+  EXPECT_TRUE(scan(nullptr, true, &outside, true, ScanDirection::BACKWARD, SIZE_MAX).empty());
+  EXPECT_EQ(static_cast<size_t>(num_rows),
+            scan(&outside, true, nullptr, true, ScanDirection::BACKWARD, SIZE_MAX).size());
+
+  // The index root lives in the header page, not in a page of the table: rows can still be added to both.
+  Tuple tuple({ValueFactory::GetIntegerValue(num_rows), ValueFactory::GetIntegerValue(num_rows)}, &schema);
+  ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, txn));
+  auto key = tuple.KeyFromTuple(schema, key_schema, {0});
+  index_info->index_->InsertEntry(key, rid, txn);
+  rids.clear();
+  index_info->index_->ScanKey(key, &rids, txn);
+  EXPECT_EQ(std::vector<RID>{rid}, rids);
+
+  delete txn;
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, NonUniqueIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  auto txn = new Transaction(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(txn, "potato", schema);
+
+  // A hundred rows for each of ten values of A, and a value with so many rows that they go to a posting list.
+  const int32_t num_values = 10;
+  const int32_t hot_value = num_values;
+  RID rid;
+  for (int32_t i = 0; i < 100 * num_values; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i % num_values), ValueFactory::GetIntegerValue(i)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, txn));
+  }
+  for (int32_t i = 0; i < 1000; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(hot_value), ValueFactory::GetIntegerValue(i)}, &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rid, txn));
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::INTEGER);
+  Schema key_schema(key_columns);
+  // The rows share keys, so a unique index cannot be built on A.
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "potato_a", "potato", schema,
+                                                                              key_schema, {0}, 8, true)),
+               Exception);
+  EXPECT_THROW(catalog->GetIndex("potato_a", "potato"), std::out_of_range);
+  auto *index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "potato_a", "potato", schema,
+                                                                                   key_schema, {0}, 8);
+  EXPECT_FALSE(index_info->index_->GetMetadata()->IsUnique());
+  auto rows_of = [&](int32_t value) {
+    std::vector<RID> rids;
+    Tuple key(std::vector<Value>{ValueFactory::GetIntegerValue(value)}, &key_schema);
+    index_info->index_->ScanKey(key, &rids, txn);
+    return rids;
+  };
+  EXPECT_EQ(100, rows_of(0).size());
+  EXPECT_EQ(1000, rows_of(hot_value).size());
+
+  // Deleting the entry of a row leaves the rows that share its key alone.
+  std::vector<RID> rids = rows_of(3);
+  Tuple key(std::vector<Value>{ValueFactory::GetIntegerValue(3)}, &key_schema);
+  index_info->index_->DeleteEntry(key, rids[0], txn);
+  std::vector<RID> remaining = rows_of(3);
+  EXPECT_EQ(std::vector<RID>(rids.begin() + 1, rids.end()), remaining);
+  index_info->index_->InsertEntry(key, rids[0], txn);
+  EXPECT_EQ(rids, rows_of(3));
+
+  delete txn;
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, CoveringIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  auto txn = new Transaction(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::BIGINT);
+  columns.emplace_back("C", TypeId::VARCHAR, 64);
+  columns.emplace_back("D", TypeId::INTEGER);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(txn, "potato", schema);
+
+  auto row = [&](int32_t a, const std::string &c) {
+    return Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetBigIntValue(a * 1000),
+                  ValueFactory::GetVarcharValue(c), ValueFactory::GetIntegerValue(-a)},
+                 &schema);
+  };
+  const int32_t num_rows = 200;
+  std::vector<RID> rids(num_rows);
+  for (int32_t i = 0; i < num_rows; i++) {
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(row(i, "row" + std::to_string(i)), &rids[i], txn));
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("A", TypeId::INTEGER);
+  Schema key_schema(key_columns);
+  // Included columns need a unique index on generic keys.
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<64>, RID, GenericComparator<64>>(txn, "potato_a", "potato", schema,
+                                                                                  key_schema, {0}, 64, false, {1})),
+               NotImplementedException);
+  EXPECT_THROW((catalog->CreateIndex<IntegerKey<int32_t>, RID, IntegerComparator<int32_t>>(
+                   txn, "potato_a", "potato", schema, key_schema, {0}, 4, true, {1})),
+               NotImplementedException);
+  auto *index_info = catalog->CreateIndex<GenericKey<64>, RID, GenericComparator<64>>(
+      txn, "potato_a", "potato", schema, key_schema, {0}, 64, true, {1, 2});
+  IndexMetadata *metadata = index_info->index_->GetMetadata();
+  EXPECT_EQ((std::vector<uint32_t>{0, 1, 2}), metadata->GetEntryAttrs());
+  EXPECT_TRUE(metadata->Covers({0, 1, 2}));
+  EXPECT_TRUE(metadata->Covers({2}));
+  EXPECT_FALSE(metadata->Covers({0, 3}));
+
+  // The entries carry the included columns, no need to go to the table.
+  Schema *entry_schema = metadata->GetEntrySchema();
+  auto check = [&](const Tuple &entry, int32_t a) {
+    EXPECT_EQ(a, entry.GetValue(entry_schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(a * 1000, entry.GetValue(entry_schema, 1).GetAs<int64_t>());
+    EXPECT_EQ("row" + std::to_string(a), entry.GetValue(entry_schema, 2).ToString());
+    EXPECT_EQ(rids[a], entry.GetRid());
+  };
+  Tuple low(std::vector<Value>{ValueFactory::GetIntegerValue(50)}, &key_schema);
+  Tuple high(std::vector<Value>{ValueFactory::GetIntegerValue(60)}, &key_schema);
+  std::vector<Tuple> entries;
+  index_info->index_->ScanEntries(&low, true, &high, false, ScanDirection::FORWARD, SIZE_MAX, &entries, txn);
+  ASSERT_EQ(10, entries.size());
+  for (int32_t i = 0; i < 10; i++) {
+    check(entries[i], 50 + i);
+  }
+  entries.clear();
+  index_info->index_->ScanEntries(nullptr, true, nullptr, true, ScanDirection::BACKWARD, 3, &entries, txn);
+  ASSERT_EQ(3, entries.size());
+  for (int32_t i = 0; i < 3; i++) {
+    check(entries[i], num_rows - 1 - i);
+  }
+
+  // Entries are maintained from the entry tuples of rows, and rejected rather than truncated when they do not fit.
+  rids.emplace_back();
+  Tuple new_row = row(num_rows, "row" + std::to_string(num_rows));
+  ASSERT_TRUE(table_metadata->table_->InsertTuple(new_row, &rids.back(), txn));
+  index_info->index_->InsertEntry(new_row.KeyFromTuple(schema, *entry_schema, metadata->GetEntryAttrs()),
+                                  rids.back(), txn);
+  Tuple key(std::vector<Value>{ValueFactory::GetIntegerValue(num_rows)}, &key_schema);
+  entries.clear();
+  index_info->index_->ScanEntries(&key, true, &key, true, ScanDirection::FORWARD, SIZE_MAX, &entries, txn);
+  ASSERT_EQ(1, entries.size());
+  check(entries[0], num_rows);
+  Tuple long_row = row(num_rows + 1, std::string(48, 'x'));
+  EXPECT_THROW(index_info->index_->InsertEntry(
+                   long_row.KeyFromTuple(schema, *entry_schema, metadata->GetEntryAttrs()), RID(0, 0), txn),
+               Exception);
+
+  delete txn;
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, VarlenIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  auto txn = new Transaction(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 1000);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(txn, "potato", schema);
+
+  // Keys far longer than any generic key, shared by a few rows each.
+  auto name = [](int32_t i) {
+    i %= 100;
+    return std::string(100 + 7 * i, 'a' + i % 26) + std::to_string(i);
+  };
+  auto row = [&](int32_t a) {
+    return Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(name(a))}, &schema);
+  };
+  const int32_t num_rows = 300;
+  std::vector<RID> rids(num_rows);
+  for (int32_t i = 0; i < num_rows; i++) {
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(row(i), &rids[i], txn));
+  }
+
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("B", TypeId::VARCHAR, 1000);
+  Schema key_schema(key_columns);
+  // Rows i, i + 100 and i + 200 share their name, so a unique index cannot be built on B.
+  EXPECT_THROW(catalog->CreateVarlenIndex(txn, "potato_b", "potato", schema, key_schema, {1}, true), Exception);
+  EXPECT_THROW(catalog->GetIndex("potato_b", "potato"), std::out_of_range);
+  auto *index_info = catalog->CreateVarlenIndex(txn, "potato_b", "potato", schema, key_schema, {1});
+  EXPECT_EQ(index_info, catalog->GetIndex("potato_b", "potato"));
+  Index *index = index_info->index_.get();
+
+  auto key = [&](int32_t i) { return Tuple({ValueFactory::GetVarcharValue(name(i))}, &key_schema); };
+  std::vector<RID> result;
+  index->ScanKey(key(42), &result, txn);
+  EXPECT_EQ((std::vector<RID>{rids[42], rids[142], rids[242]}), result);
+
+  // Ranges compare the whole key, however long.
+  std::vector<std::string> names;
+  for (int32_t i = 0; i < num_rows; i++) {
+    names.push_back(name(i));
+  }
+  std::sort(names.begin(), names.end());
+  Tuple low = key(5);
+  Tuple high = key(17);
+  result.clear();
+  index->ScanRange(&low, false, &high, true, ScanDirection::FORWARD, SIZE_MAX, &result, txn);
+  auto count = static_cast<size_t>(std::upper_bound(names.begin(), names.end(), name(17)) -
+                                   std::upper_bound(names.begin(), names.end(), name(5)));
+  ASSERT_EQ(count, result.size());
+  for (const auto &rid : result) {
+    Tuple tuple;
+    ASSERT_TRUE(table_metadata->table_->GetTuple(rid, &tuple, txn));
+    std::string value = tuple.GetValue(&schema, 1).ToString();
+    EXPECT_TRUE(name(5) < value && value <= name(17));
+  }
+  result.clear();
+  index->ScanRange(nullptr, true, nullptr, true, ScanDirection::BACKWARD, 3, &result, txn);
+  ASSERT_EQ(3, result.size());
+  Tuple tuple;
+  ASSERT_TRUE(table_metadata->table_->GetTuple(result[0], &tuple, txn));
+  EXPECT_EQ(names.back(), tuple.GetValue(&schema, 1).ToString());
+
+  // Entries are removed by key and rid.
+  index->DeleteEntry(key(42), rids[142], txn);
+  result.clear();
+  index->ScanKey(key(42), &result, txn);
+  EXPECT_EQ((std::vector<RID>{rids[42], rids[242]}), result);
+
+  delete txn;
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, ToastedKeyIndexTest) {
+  auto disk_manager = new DiskManager("catalog_test.db");
+  auto bpm = new BufferPoolManager(64, disk_manager);
+  auto catalog = new Catalog(bpm, nullptr, nullptr);
+  auto txn = new Transaction(0);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 1000);
+  columns.emplace_back("C", TypeId::VARCHAR, 1000);
+  Schema schema(columns);
+  auto *table_metadata = catalog->CreateTable(txn, "potato", schema);
+
+  // B is the largest value of rows too large for the table to keep whole, so it is stored out of line.
+  auto name = [](int32_t i) { return std::string(900, 'a' + i % 26) + std::to_string(i); };
+  const int32_t num_rows = 100;
+  std::vector<RID> rids(num_rows);
+  for (int32_t i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(name(i)),
+                 ValueFactory::GetVarcharValue(std::string(400, 'c'))},
+                &schema);
+    ASSERT_TRUE(table_metadata->table_->InsertTuple(tuple, &rids[i], txn));
+  }
+  Tuple stored;
+  ASSERT_TRUE(table_metadata->table_->GetTuple(rids[0], &stored, txn));
+  // Reading the external pointer as a value fails rather than reading past the tuple.
+  EXPECT_THROW(stored.GetValue(&schema, 1), Exception);
+  EXPECT_THROW(TupleView(stored).GetValue(&schema, 1), Exception);
+  EXPECT_EQ(std::string(400, 'c'), stored.GetValue(&schema, 2).ToString());
+
+  // Building an index on B reads the values from the overflow pages.
+  std::vector<Column> key_columns;
+  key_columns.emplace_back("B", TypeId::VARCHAR, 1000);
+  Schema key_schema(key_columns);
+  auto *index_info = catalog->CreateVarlenIndex(txn, "potato_b", "potato", schema, key_schema, {1}, true);
+  std::vector<RID> result;
+  for (int32_t i = 0; i < num_rows; i++) {
+    result.clear();
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetVarcharValue(name(i))}, &key_schema), &result, txn);
+    EXPECT_EQ(std::vector<RID>{rids[i]}, result);
+  }
+
+  // So do indexes on other columns of such rows.
+  std::vector<Column> a_columns;
+  a_columns.emplace_back("A", TypeId::INTEGER);
+  Schema a_schema(a_columns);
+  auto *a_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(txn, "potato_a", "potato", schema,
+                                                                               a_schema, {0}, 8, true);
+  result.clear();
+  a_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(42)}, &a_schema), &result, txn);
+  EXPECT_EQ(std::vector<RID>{rids[42]}, result);
+
+  delete txn;
+  delete catalog;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
   delete disk_manager;
 }
 
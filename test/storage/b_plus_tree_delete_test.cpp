@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
@@ -12,7 +13,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   std::string createStmt = "a bigint";
   Schema *key_schema = ParseCreateStatement(createStmt);
@@ -92,7 +93,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -170,4 +171,86 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+TEST(BPlusTreeTests, ReverseIterationTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000;
+
+  for (auto mode : {BPlusTreeMode::LATCH_CRABBING, BPlusTreeMode::B_LINK}) {
+    for (auto [leaf_max_size, internal_max_size] : {std::pair<int, int>{3, 4}, {64, 64}}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                               internal_max_size, mode);
+      GenericKey<8> index_key;
+      RID rid;
+      EXPECT_TRUE(tree.rbegin().isEnd());
+
+      // The even keys, inserted in random order, then every fourth one removed again, which merges leaves.
+      std::vector<int64_t> keys;
+      for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+        keys.push_back(key);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        rid.Set(0, key);
+        tree.Insert(index_key, rid);
+      }
+      for (auto key : keys) {
+        if (key % 8 == 4) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+      }
+      std::vector<int64_t> expected;
+      for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+        if (key % 8 != 4) {
+          expected.push_back(key);
+        }
+      }
+
+      // The whole tree backwards.
+      std::vector<int64_t> scanned;
+      for (auto iterator = tree.rbegin(); !iterator.isEnd(); --iterator) {
+        scanned.push_back((*iterator).second.GetSlotNum());
+      }
+      ASSERT_EQ(std::vector<int64_t>(expected.rbegin(), expected.rend()), scanned);
+
+      // Backwards from keys that are in the tree, between keys of the tree, and past either end of it.
+      for (int64_t start_key : std::vector<int64_t>{-1, 0, 1, 4, 5, 6, 998, 999, 1000, 1996, 1998, 1999, 5000}) {
+        index_key.SetFromInteger(start_key);
+        auto iterator = tree.RBegin(index_key);
+        auto last = std::upper_bound(expected.begin(), expected.end(), start_key);
+        for (auto it = last; it != expected.begin(); --it) {
+          ASSERT_FALSE(iterator.isEnd()) << start_key;
+          ASSERT_EQ(*(it - 1), (*iterator).second.GetSlotNum()) << start_key;
+          --iterator;
+        }
+        ASSERT_TRUE(iterator.isEnd()) << start_key;
+      }
+
+      // Turning around in the middle of the tree. The iterator holds a leaf until it goes out of scope.
+      {
+        index_key.SetFromInteger(1000);
+        auto iterator = tree.Begin(index_key);
+        ++iterator;
+        --iterator;
+        --iterator;
+        EXPECT_EQ(998, (*iterator).second.GetSlotNum());
+      }
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
 }  // namespace bustub
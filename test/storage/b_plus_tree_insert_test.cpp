@@ -3,16 +3,27 @@
  */
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sort.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -71,7 +82,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
@@ -139,4 +150,562 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 3000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (auto mode : {BPlusTreeMode::LATCH_CRABBING, BPlusTreeMode::B_LINK}) {
+    for (auto [leaf_max_size, internal_max_size] : {std::pair<int, int>{3, 4}, {64, 64}}) {
+      for (double fill_factor : {1.0, 0.7, 0.0}) {
+        DiskManager *disk_manager = new DiskManager("test.db");
+        BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+        page_id_t page_id;
+        auto header_page = bpm->NewPage(&page_id);
+        (void)header_page;
+        BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                                 internal_max_size, mode);
+        GenericKey<8> index_key;
+        RID rid;
+
+        // A unique tree refuses to load a key twice, rather than drop one of its values, and stays empty.
+        std::vector<std::pair<GenericKey<8>, RID>> duplicates(100);
+        for (int64_t i = 0; i < 100; i++) {
+          duplicates[i].first.SetFromInteger(i < 50 ? i : i - 1);
+          duplicates[i].second.Set(0, i);
+        }
+        EXPECT_THROW(tree.BulkLoad(duplicates.begin(), duplicates.end(), fill_factor), Exception);
+        EXPECT_TRUE(tree.IsEmpty());
+
+        // Two pages of memory make for many runs and several merge passes.
+        ExternalSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator, 2);
+        for (auto key : keys) {
+          index_key.SetFromInteger(key);
+          rid.Set(0, key);
+          sort.Add(index_key, rid);
+        }
+        ASSERT_TRUE(tree.BulkLoad(sort.begin(), sort.end(), fill_factor));
+        EXPECT_GT(sort.GetSpilledRunCount(), 2);
+        EXPECT_FALSE(tree.BulkLoad(sort.end(), sort.end()));
+
+        int64_t current_key = 0;
+        for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+          ASSERT_EQ(current_key, (*iterator).second.GetSlotNum());
+          current_key++;
+        }
+        ASSERT_EQ(num_keys, current_key);
+
+        // The loaded tree takes inserts and removes like any other.
+        for (int64_t key = num_keys; key < 2 * num_keys; key++) {
+          index_key.SetFromInteger(key);
+          rid.Set(0, key);
+          EXPECT_TRUE(tree.Insert(index_key, rid));
+        }
+        for (int64_t key = 1; key < 2 * num_keys; key += 2) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+        }
+        std::vector<RID> rids;
+        for (int64_t key = 0; key < 2 * num_keys; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids));
+        }
+        current_key = 0;
+        for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+          ASSERT_EQ(current_key, (*iterator).second.GetSlotNum());
+          current_key += 2;
+        }
+        ASSERT_EQ(2 * num_keys, current_key);
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete bpm;
+        delete disk_manager;
+        remove("test.db");
+        remove("test.log");
+      }
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, GetValuesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000;
+  // Probes in random order, repeated, and past either end of the tree; then the same ones sorted.
+  std::vector<int64_t> probes;
+  std::mt19937 random(15445);
+  for (int i = 0; i < 3000; i++) {
+    probes.push_back(static_cast<int64_t>(random() % (2 * num_keys + 20)) - 10);
+  }
+  std::vector<int64_t> sorted_probes(probes);
+  std::sort(sorted_probes.begin(), sorted_probes.end());
+  probes.insert(probes.end(), sorted_probes.begin(), sorted_probes.end());
+  std::vector<GenericKey<8>> probe_keys(probes.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    probe_keys[i].SetFromInteger(probes[i]);
+  }
+
+  for (auto mode : {BPlusTreeMode::LATCH_CRABBING, BPlusTreeMode::B_LINK}) {
+    for (auto [leaf_max_size, internal_max_size] : {std::pair<int, int>{3, 4}, {64, 64}}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                               internal_max_size, mode);
+      std::vector<std::vector<RID>> result;
+      EXPECT_EQ(0, tree.GetValues(probe_keys, &result));
+      EXPECT_EQ(probes.size(), result.size());
+
+      // The even keys.
+      GenericKey<8> index_key;
+      RID rid;
+      for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+        index_key.SetFromInteger(key);
+        rid.Set(0, key);
+        tree.Insert(index_key, rid);
+      }
+      size_t expected_found = 0;
+      for (auto probe : probes) {
+        expected_found += probe >= 0 && probe < 2 * num_keys && probe % 2 == 0 ? 1 : 0;
+      }
+      EXPECT_EQ(expected_found, tree.GetValues(probe_keys, &result));
+      ASSERT_EQ(probes.size(), result.size());
+      for (size_t i = 0; i < probes.size(); i++) {
+        if (probes[i] >= 0 && probes[i] < 2 * num_keys && probes[i] % 2 == 0) {
+          ASSERT_EQ(1, result[i].size()) << probes[i];
+          EXPECT_EQ(probes[i], result[i][0].GetSlotNum());
+        } else {
+          EXPECT_TRUE(result[i].empty()) << probes[i];
+        }
+      }
+
+      // Every pin is released again, or the small buffer pool would run out of frames for the removes.
+      for (int64_t key = 0; key < 2 * num_keys; key += 2) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      EXPECT_EQ(0, tree.GetValues(probe_keys, &result));
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, DuplicateKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 200;
+  const int64_t warm_key = 11;
+  const int64_t hot_key = 7;
+  // Key k has k % 5 values, the warm key more than a leaf of 64 keeps inline, the hot key several posting pages full.
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (int64_t key = 0; key < num_keys; key++) {
+    int64_t count = key == hot_key ? 3000 : key == warm_key ? 20 : key % 5;
+    for (int64_t i = 0; i < count; i++) {
+      pairs.emplace_back(key, RID(static_cast<page_id_t>(i / 4 + key), static_cast<uint32_t>(i % 4)));
+    }
+  }
+  std::shuffle(pairs.begin(), pairs.end(), std::mt19937(15445));
+  std::map<int64_t, std::set<int64_t>> expected;
+  for (const auto &[key, rid] : pairs) {
+    expected[key].insert(rid.Get());
+  }
+
+  using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+  // Compare the tree with the expected pairs through lookups and iteration in both directions.
+  auto check = [&](Tree *tree) {
+    std::vector<std::pair<int64_t, int64_t>> all;
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < num_keys; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      auto found = expected.find(key);
+      bool present = found != expected.end() && !found->second.empty();
+      ASSERT_EQ(present, tree->GetValue(index_key, &rids)) << key;
+      std::vector<int64_t> values;
+      for (const auto &rid : rids) {
+        values.push_back(rid.Get());
+      }
+      ASSERT_EQ(present ? std::vector<int64_t>(found->second.begin(), found->second.end()) : std::vector<int64_t>(),
+                values)
+          << key;
+      for (auto value : values) {
+        all.emplace_back(key, value);
+      }
+    }
+    size_t position = 0;
+    for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+      ASSERT_LT(position, all.size());
+      ASSERT_EQ(all[position].first, (*iterator).first.ToValue(key_schema, 0).GetAs<int64_t>());
+      ASSERT_EQ(all[position].second, (*iterator).second.Get());
+      position++;
+    }
+    ASSERT_EQ(all.size(), position);
+    for (auto iterator = tree->rbegin(); iterator != tree->end(); --iterator) {
+      ASSERT_GT(position, 0);
+      position--;
+      ASSERT_EQ(all[position].first, (*iterator).first.ToValue(key_schema, 0).GetAs<int64_t>());
+      ASSERT_EQ(all[position].second, (*iterator).second.Get());
+    }
+    ASSERT_EQ(0, position);
+  };
+
+  for (auto mode : {BPlusTreeMode::LATCH_CRABBING, BPlusTreeMode::B_LINK}) {
+    for (auto [leaf_max_size, internal_max_size] : {std::pair<int, int>{3, 4}, {64, 64}}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+      GenericKey<8> index_key;
+      {
+        Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, mode, false);
+        for (const auto &[key, rid] : pairs) {
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.Insert(index_key, rid));
+        }
+        // Pairs are unique, keys are not.
+        index_key.SetFromInteger(hot_key);
+        EXPECT_FALSE(tree.Insert(index_key, pairs[0].first == hot_key ? pairs[0].second : RID(hot_key, 0)));
+        index_key.SetFromInteger(3);
+        EXPECT_FALSE(tree.Insert(index_key, RID(3, 0)));
+        check(&tree);
+
+        // The reverse scan of a key starts on its last value.
+        index_key.SetFromInteger(hot_key);
+        auto iterator = tree.RBegin(index_key);
+        EXPECT_EQ(*expected[hot_key].rbegin(), (*iterator).second.Get());
+        iterator = tree.end();
+
+        std::vector<GenericKey<8>> probe_keys(num_keys);
+        for (int64_t key = 0; key < num_keys; key++) {
+          probe_keys[key].SetFromInteger(num_keys - 1 - key);
+        }
+        std::vector<std::vector<RID>> result;
+        EXPECT_EQ(expected.size(), tree.GetValues(probe_keys, &result));
+        EXPECT_EQ(expected[hot_key].size(), result[num_keys - 1 - hot_key].size());
+
+        // Remove every other value of each key, and all but one of the warm key, which leaves it inline again.
+        int64_t turn = 0;
+        for (const auto &[key, rid] : pairs) {
+          if (turn++ % 2 == 0 || (key == warm_key && expected[key].size() > 1)) {
+            index_key.SetFromInteger(key);
+            ASSERT_TRUE(tree.Remove(index_key, rid));
+            EXPECT_FALSE(tree.Remove(index_key, rid));
+            expected[key].erase(rid.Get());
+          }
+        }
+        check(&tree);
+
+        // Remove a few keys with all their values, including the hot one.
+        for (int64_t key : {hot_key, warm_key, int64_t{4}, int64_t{199}}) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key);
+          expected.erase(key);
+        }
+        check(&tree);
+
+        for (const auto &[key, rid] : pairs) {
+          index_key.SetFromInteger(key);
+          tree.Remove(index_key, rid);
+        }
+        expected.clear();
+        check(&tree);
+      }
+
+      // Bulk load the pairs in key order, but with the values of a key in any order and some of them twice.
+      for (const auto &[key, rid] : pairs) {
+        expected[key].insert(rid.Get());
+      }
+      std::vector<std::pair<GenericKey<8>, RID>> sorted;
+      for (const auto &[key, rid] : pairs) {
+        index_key.SetFromInteger(key);
+        sorted.emplace_back(index_key, rid);
+        if (rid.GetSlotNum() == 2) {
+          sorted.emplace_back(index_key, rid);
+        }
+      }
+      std::stable_sort(sorted.begin(), sorted.end(),
+                       [&](const auto &lhs, const auto &rhs) { return comparator(lhs.first, rhs.first) < 0; });
+      {
+        Tree tree("foo_pk_2", bpm, comparator, leaf_max_size, internal_max_size, mode, false);
+        ASSERT_TRUE(tree.BulkLoad(sorted.begin(), sorted.end()));
+        check(&tree);
+        index_key.SetFromInteger(hot_key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, 12345)));
+        expected[hot_key].insert(RID(0, 12345).Get());
+        check(&tree);
+      }
+      expected.clear();
+      for (const auto &[key, rid] : pairs) {
+        expected[key].insert(rid.Get());
+      }
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+// Lookup time of random keys one at a time and in batches, on a tree too large for the CPU caches. A benchmark, run it
+// with --gtest_also_run_disabled_tests.
+TEST(BPlusTreeTests, DISABLED_GetValuesBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000000;
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(20000, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  std::vector<std::pair<GenericKey<8>, RID>> pairs(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    pairs[key].first.SetFromInteger(key);
+    pairs[key].second.Set(0, key);
+  }
+  ASSERT_TRUE(tree.BulkLoad(pairs.begin(), pairs.end()));
+
+  std::mt19937_64 random(15445);
+  std::cout << "batch  single ns/key  batched ns/key" << std::endl;
+  for (size_t batch : {16, 256, 4096, 65536}) {
+    std::vector<GenericKey<8>> keys(batch);
+    for (auto &key : keys) {
+      key.SetFromInteger(static_cast<int64_t>(random() % num_keys));
+    }
+    const size_t rounds = std::max<size_t>(1, 200000 / batch);
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      for (const auto &key : keys) {
+        rids.clear();
+        tree.GetValue(key, &rids);
+      }
+    }
+    std::chrono::duration<double, std::nano> single_time = std::chrono::steady_clock::now() - start;
+    std::vector<std::vector<RID>> result;
+    start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+      EXPECT_EQ(batch, tree.GetValues(keys, &result));
+    }
+    std::chrono::duration<double, std::nano> batched_time = std::chrono::steady_clock::now() - start;
+    std::cout << batch << "  " << single_time.count() / (rounds * batch) << "  "
+              << batched_time.count() / (rounds * batch) << std::endl;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  delete key_schema;
+}
+
+TEST(BPlusTreeTests, NormalizedKeyTest) {
+  std::vector<Column> columns{Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16),
+                              Column("c", TypeId::DECIMAL)};
+  Schema *key_schema = new Schema(columns);
+  NormalizedComparator<32> comparator(key_schema);
+
+  std::vector<std::vector<Value>> rows;
+  for (int32_t a : {-70000, -1, 0, 1, 256, 70000}) {
+    for (const char *b : {"", "a", "a\x01", "ab", "b", "ba"}) {
+      for (double c : {-2.5, -0.5, 0.0, 0.5, 1e10}) {
+        rows.push_back({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b),
+                        ValueFactory::GetDecimalValue(c)});
+      }
+    }
+  }
+  // The rows were generated in order, so their keys must compare like their positions.
+  std::vector<NormalizedKey<32>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    keys[i].SetFromKey(Tuple(rows[i], key_schema), *key_schema);
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      int result = comparator(keys[i], keys[j]);
+      ASSERT_EQ(i < j, result < 0) << i << " " << j;
+      ASSERT_EQ(i == j, result == 0) << i << " " << j;
+    }
+  }
+
+  // NULLs sort first.
+  NormalizedKey<32> null_key;
+  null_key.SetFromKey(Tuple({ValueFactory::GetNullValueByType(TypeId::INTEGER),
+                             ValueFactory::GetVarcharValue("a"), ValueFactory::GetDecimalValue(0.0)},
+                            key_schema),
+                      *key_schema);
+  EXPECT_LT(comparator(null_key, keys[0]), 0);
+  null_key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(-70000), ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+                             ValueFactory::GetDecimalValue(0.0)},
+                            key_schema),
+                      *key_schema);
+  EXPECT_LT(comparator(null_key, keys[0]), 0);
+  delete key_schema;
+
+  // A tree of normalized keys, with small pages so that searches go through many pages with long common prefixes.
+  key_schema = ParseCreateStatement("a bigint");
+  NormalizedComparator<8> tree_comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<NormalizedKey<8>, RID, NormalizedComparator<8>> tree("foo_pk", bpm, tree_comparator, 4, 5);
+  std::vector<int64_t> tree_keys;
+  for (int64_t key = -1000; key < 1000; key++) {
+    tree_keys.push_back(key * 1000003);
+  }
+  std::shuffle(tree_keys.begin(), tree_keys.end(), std::mt19937(15445));
+  NormalizedKey<8> index_key;
+  RID rid;
+  for (auto key : tree_keys) {
+    index_key.SetFromInteger(key);
+    rid.Set(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key));
+    EXPECT_TRUE(tree.Insert(index_key, rid));
+  }
+  std::vector<RID> rids;
+  for (auto key : tree_keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    EXPECT_EQ(static_cast<uint32_t>(key), rids[0].GetSlotNum());
+    index_key.SetFromInteger(key + 1);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+  }
+  int64_t expected = -1000;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    ASSERT_EQ(expected * 1000003, (*iterator).first.ToString());
+    expected++;
+  }
+  EXPECT_EQ(1000, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Fill a leaf and an internal page with the even keys 0, 2, 4, ..., check their searches against the expected
+// positions and return the average time of a search of the leaf and of the internal page, in ns.
+template <typename KeyType, typename KeyComparator>
+std::pair<double, double> MeasurePageSearch(const KeyComparator &comparator, const std::vector<int64_t> &probes) {
+  using LeafPage = BPlusTreeLeafPage<KeyType, RID, KeyComparator>;
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
+  auto leaf_data = std::make_unique<char[]>(PAGE_SIZE);
+  auto leaf = reinterpret_cast<LeafPage *>(leaf_data.get());
+  const int leaf_size =
+      (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE - sizeof(KeyType)) / sizeof(std::pair<KeyType, RID>) - 1;
+  leaf->Init(0, INVALID_PAGE_ID, leaf_size + 1);
+  std::vector<std::pair<KeyType, RID>> leaf_items(leaf_size);
+  for (int i = 0; i < leaf_size; i++) {
+    leaf_items[i].first.SetFromInteger(2 * i);
+  }
+  leaf->PopulateFrom(leaf_items.data(), leaf_size);
+
+  auto internal_data = std::make_unique<char[]>(PAGE_SIZE);
+  auto internal = reinterpret_cast<InternalPage *>(internal_data.get());
+  const int internal_size =
+      (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE - sizeof(KeyType)) / sizeof(std::pair<KeyType, page_id_t>) - 1;
+  internal->Init(1, INVALID_PAGE_ID, internal_size);
+  std::vector<std::pair<KeyType, page_id_t>> internal_items(internal_size);
+  for (int i = 0; i < internal_size; i++) {
+    internal_items[i].first.SetFromInteger(2 * i);
+    internal_items[i].second = i;
+  }
+  internal->PopulateFrom(internal_items.data(), internal_size, nullptr);
+
+  KeyType key;
+  for (int64_t probe = -1; probe <= 2 * std::max(leaf_size, internal_size); probe++) {
+    key.SetFromInteger(probe);
+    EXPECT_EQ(std::clamp<int64_t>((probe + 1) / 2, 0, leaf_size), leaf->KeyIndex(key, comparator)) << probe;
+    EXPECT_EQ(std::clamp<int64_t>(probe / 2, 0, internal_size - 1), internal->Lookup(key, comparator)) << probe;
+  }
+
+  std::vector<KeyType> keys(probes.size());
+  for (size_t i = 0; i < probes.size(); i++) {
+    keys[i].SetFromInteger(probes[i] % (2 * leaf_size));
+  }
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &probe : keys) {
+    sum += leaf->KeyIndex(probe, comparator);
+  }
+  std::chrono::duration<double, std::nano> leaf_time = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  for (const auto &probe : keys) {
+    sum += internal->Lookup(probe, comparator);
+  }
+  std::chrono::duration<double, std::nano> internal_time = std::chrono::steady_clock::now() - start;
+  EXPECT_GT(sum, 0);
+  return {leaf_time.count() / probes.size(), internal_time.count() / probes.size()};
+}
+
+// The searches within a full leaf and internal page find the expected positions, for every kind of key of a BIGINT or
+// INTEGER column.
+TEST(BPlusTreeTests, PageSearchTest) {
+  Schema *bigint_schema = ParseCreateStatement("a bigint");
+  Schema *integer_schema = ParseCreateStatement("a integer");
+  std::vector<int64_t> probes(1000);
+  std::mt19937_64 random(15445);
+  for (auto &probe : probes) {
+    probe = static_cast<int64_t>(random() >> 1);
+  }
+  MeasurePageSearch<GenericKey<8>>(GenericComparator<8>(bigint_schema), probes);
+  MeasurePageSearch<NormalizedKey<8>>(NormalizedComparator<8>(bigint_schema), probes);
+  MeasurePageSearch<IntegerKey<int64_t>>(IntegerComparator<int64_t>(bigint_schema), probes);
+  MeasurePageSearch<IntegerKey<int32_t>>(IntegerComparator<int32_t>(integer_schema), probes);
+  delete bigint_schema;
+  delete integer_schema;
+}
+
+// Search time within a full leaf and internal page, for every kind of key of a BIGINT or INTEGER column. A benchmark,
+// run it with --gtest_also_run_disabled_tests.
+TEST(BPlusTreeTests, DISABLED_PageSearchBenchmark) {
+  Schema *bigint_schema = ParseCreateStatement("a bigint");
+  Schema *integer_schema = ParseCreateStatement("a integer");
+  std::vector<int64_t> probes(1000000);
+  std::mt19937_64 random(15445);
+  for (auto &probe : probes) {
+    probe = static_cast<int64_t>(random() >> 1);
+  }
+
+  std::vector<std::pair<std::string, std::pair<double, double>>> results;
+  results.emplace_back("GenericKey<8>",
+                       MeasurePageSearch<GenericKey<8>>(GenericComparator<8>(bigint_schema), probes));
+  results.emplace_back("NormalizedKey<8>",
+                       MeasurePageSearch<NormalizedKey<8>>(NormalizedComparator<8>(bigint_schema), probes));
+  results.emplace_back("IntegerKey<int64_t>", MeasurePageSearch<IntegerKey<int64_t>>(
+                                                  IntegerComparator<int64_t>(bigint_schema), probes));
+  results.emplace_back("IntegerKey<int32_t>", MeasurePageSearch<IntegerKey<int32_t>>(
+                                                  IntegerComparator<int32_t>(integer_schema), probes));
+  std::cout << "key  leaf ns/op  internal ns/op" << std::endl;
+  for (const auto &[name, times] : results) {
+    std::cout << name << "  " << times.first << "  " << times.second << std::endl;
+  }
+  delete bigint_schema;
+  delete integer_schema;
+}
+
 }  // namespace bustub
@@ -10,7 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <unistd.h>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -72,6 +81,144 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// Size of the log records that RunCommits writes.
+constexpr int RECORD_SIZE = 64;
+
+// Commits from num_threads threads, each of which writes commits_per_thread log records and waits for every one of
+// them to be durable.
+void RunCommits(DiskManager *dm, int num_threads, int commits_per_thread) {
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([dm, num_threads, commits_per_thread, tid] {
+      // alternate between two buffers, WriteLog insists on buffer swapping
+      char records[2][RECORD_SIZE];
+      for (int i = 0; i < commits_per_thread; i++) {
+        char *record = records[i % 2];
+        std::memset(record, 0, RECORD_SIZE);
+        std::snprintf(record, RECORD_SIZE, "run %d txn %d commit %d", num_threads, tid, i);
+        dm->WriteLog(record, RECORD_SIZE);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// Every commit waits for its log record to be durable. Concurrent committers share syncs, so the multi-threaded run
+// should need no more syncs than commits.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, GroupCommitTest) {
+  constexpr int commits_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  for (int num_threads : {1, 8}) {
+    int flushes_before = dm.GetNumFlushes();
+    int syncs_before = dm.GetNumLogSyncs();
+    RunCommits(&dm, num_threads, commits_per_thread);
+    int commits = dm.GetNumFlushes() - flushes_before;
+    int syncs = dm.GetNumLogSyncs() - syncs_before;
+    EXPECT_EQ(num_threads * commits_per_thread, commits);
+    EXPECT_LE(syncs, commits);
+    if (num_threads == 1) {
+      EXPECT_EQ(commits, syncs);
+    }
+  }
+  EXPECT_FALSE(dm.GetFlushState());
+
+  // Every record made it into the log exactly once, without holes.
+  constexpr int total_records = 9 * commits_per_thread;
+  std::set<std::string> records;
+  char buf[RECORD_SIZE];
+  for (int offset = 0; dm.ReadLog(buf, RECORD_SIZE, offset); offset += RECORD_SIZE) {
+    EXPECT_NE('\0', buf[0]);
+    records.emplace(buf);
+  }
+  EXPECT_EQ(total_records, records.size());
+
+  dm.ShutDown();
+}
+
+// Commit throughput of WriteLog from 1 to 64 threads, and the fdatasync calls that group commit needs per commit.
+// A benchmark, run it with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_GroupCommitBenchmark) {
+  constexpr int commits_per_thread = 256;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  std::cout << "threads  commits/s  syncs/commit" << std::endl;
+  for (int num_threads : {1, 2, 4, 8, 16, 32, 64}) {
+    int flushes_before = dm.GetNumFlushes();
+    int syncs_before = dm.GetNumLogSyncs();
+    auto start = std::chrono::steady_clock::now();
+    RunCommits(&dm, num_threads, commits_per_thread);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int commits = dm.GetNumFlushes() - flushes_before;
+    int syncs = dm.GetNumLogSyncs() - syncs_before;
+    std::cout << num_threads << "  " << static_cast<int64_t>(commits / elapsed.count()) << "  "
+              << static_cast<double>(syncs) / commits << std::endl;
+  }
+
+  dm.ShutDown();
+}
+
+// A failed log write is never acknowledged, and neither is any later one.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LogWriteFailureTest) {
+  // Every write to /dev/full fails with ENOSPC.
+  ASSERT_EQ(0, symlink("/dev/full", "test.log"));
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  char data[2][16] = {{0}};
+  std::strncpy(data[0], "A test string.", sizeof(data[0]));
+  std::strncpy(data[1], "A test string.", sizeof(data[1]));
+
+  EXPECT_THROW(dm.WriteLog(data[0], sizeof(data[0])), Exception);
+  EXPECT_THROW(dm.WriteLog(data[1], sizeof(data[1])), Exception);
+  EXPECT_EQ(0, dm.GetNumLogSyncs());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadOnlyMapTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    std::strncpy(data, "A test string.", sizeof(data));
+    dm.WritePage(0, data);
+    dm.WritePage(1, data);
+    dm.ShutDown();
+  }
+  remove("test.log");
+
+  auto dm = DiskManager(db_file, true);
+  EXPECT_TRUE(dm.IsReadOnly());
+  EXPECT_EQ(2, dm.GetMappedPageCount());
+  ASSERT_NE(nullptr, dm.GetMappedPage(1));
+  EXPECT_EQ(std::memcmp(dm.GetMappedPage(1), data, sizeof(data)), 0);
+  EXPECT_EQ(nullptr, dm.GetMappedPage(2));
+
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  EXPECT_THROW(dm.WritePage(0, data), Exception);
+  EXPECT_THROW(dm.WriteLog(data, sizeof(data)), Exception);
+  EXPECT_THROW(dm.AllocatePage(), Exception);
+  // read-only mode never creates a log file
+  std::ifstream log("test.log");
+  EXPECT_FALSE(log.is_open());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadOnlyMissingFileTest) { EXPECT_THROW(DiskManager("test.db", true), Exception); }
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
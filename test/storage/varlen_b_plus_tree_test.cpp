@@ -0,0 +1,197 @@
+/**
+ * varlen_b_plus_tree_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/varlen_b_plus_tree.h"
+
+namespace bustub {
+
+// A random key of 1 to max_length bytes from a small alphabet, so that keys share long prefixes.
+std::string RandomKey(std::mt19937 *random, size_t max_length) {
+  std::uniform_int_distribution<size_t> length(1, max_length);
+  std::uniform_int_distribution<int> byte(0, 3);
+  std::string key(length(*random), '\0');
+  for (auto &c : key) {
+    c = static_cast<char>(byte(*random));
+  }
+  return key;
+}
+
+TEST(VarlenBPlusTreeTest, InsertScanRemoveTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto tree = new VarlenBPlusTree("foo_pk", bpm);
+  EXPECT_TRUE(tree->IsEmpty());
+  EXPECT_TRUE(tree->begin().isEnd());
+
+  // Keys from a few bytes up to about a page apart, a mix BPlusTree would need its largest key size for.
+  std::mt19937 random(15445);
+  std::map<std::string, RID> expected;
+  for (int i = 0; i < 3000; i++) {
+    std::string key = RandomKey(&random, i % 10 == 0 ? VarlenBPlusTree::MAX_KEY_SIZE : 64);
+    RID rid(i, i);
+    EXPECT_EQ(expected.emplace(key, rid).second, tree->Insert(key, rid));
+  }
+  EXPECT_FALSE(tree->IsEmpty());
+  EXPECT_THROW(tree->Insert(std::string(VarlenBPlusTree::MAX_KEY_SIZE + 1, 'x'), RID(0, 0)), Exception);
+
+  std::vector<RID> rids;
+  for (const auto &[key, rid] : expected) {
+    rids.clear();
+    ASSERT_TRUE(tree->GetValue(key, &rids));
+    ASSERT_EQ(1, rids.size());
+    EXPECT_EQ(rid, rids[0]);
+  }
+  EXPECT_FALSE(tree->GetValue(std::string(1, '\x7f'), &rids));
+
+  // Iteration is in memcmp order, from the first key or from the first key not less than a given one.
+  auto check_scan = [&](VarlenIndexIterator iterator, std::map<std::string, RID>::const_iterator from) {
+    for (; from != expected.end(); ++from, ++iterator) {
+      ASSERT_FALSE(iterator.isEnd());
+      EXPECT_EQ(from->first, (*iterator).first);
+      EXPECT_EQ(from->second, (*iterator).second);
+    }
+    EXPECT_TRUE(iterator.isEnd());
+  };
+  check_scan(tree->begin(), expected.cbegin());
+  for (int i = 0; i < 20; i++) {
+    std::string key = RandomKey(&random, 64);
+    check_scan(tree->Begin(key), expected.lower_bound(key));
+  }
+
+  // Remove every other key.
+  bool erase = true;
+  for (auto it = expected.begin(); it != expected.end(); erase = !erase) {
+    if (erase) {
+      EXPECT_TRUE(tree->Remove(it->first));
+      EXPECT_FALSE(tree->Remove(it->first));
+      it = expected.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  check_scan(tree->begin(), expected.cbegin());
+  for (auto &[key, rid] : expected) {
+    EXPECT_TRUE(tree->Remove(key));
+  }
+  expected.clear();
+  EXPECT_TRUE(tree->begin().isEnd());
+
+  delete tree;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Keys that only differ past a long common prefix make long separators, and so internal pages of a few keys that split
+// often.
+TEST(VarlenBPlusTreeTest, LongSeparatorTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto tree = new VarlenBPlusTree("foo_pk", bpm);
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1000; i++) {
+    std::string number = std::to_string(i);
+    keys.push_back(std::string(900, 'p') + std::string(4 - number.size(), '0') + number);
+  }
+  std::vector<std::string> shuffled = keys;
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+  for (const auto &key : shuffled) {
+    EXPECT_TRUE(tree->Insert(key, RID(0, std::stoi(key.substr(900)))));
+  }
+  std::vector<RID> rids;
+  for (int i = 0; i < 1000; i++) {
+    rids.clear();
+    ASSERT_TRUE(tree->GetValue(keys[i], &rids));
+    EXPECT_EQ(RID(0, i), rids[0]);
+  }
+  int i = 0;
+  for (auto iterator = tree->begin(); !iterator.isEnd(); ++iterator, ++i) {
+    ASSERT_LT(i, 1000);
+    EXPECT_EQ(keys[i], (*iterator).first);
+  }
+  EXPECT_EQ(1000, i);
+
+  delete tree;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(VarlenBPlusTreeTest, ConcurrentInsertTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  auto tree = new VarlenBPlusTree("foo_pk", bpm);
+
+  const int num_threads = 4;
+  const int keys_per_thread = 1000;
+  std::vector<std::vector<std::string>> keys(num_threads);
+  std::mt19937 random(15445);
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    // The index makes every key distinct.
+    keys[i % num_threads].push_back(RandomKey(&random, 200) + std::to_string(i));
+  }
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        tree->Insert(keys[t][i], RID(t, i));
+        std::vector<RID> rids;
+        tree->GetValue(keys[t][i], &rids);
+        EXPECT_EQ(1, rids.size());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<std::string> all_keys;
+  for (const auto &thread_keys : keys) {
+    all_keys.insert(all_keys.end(), thread_keys.begin(), thread_keys.end());
+  }
+  std::sort(all_keys.begin(), all_keys.end());
+  size_t count = 0;
+  for (auto iterator = tree->begin(); !iterator.isEnd(); ++iterator) {
+    ASSERT_LT(count, all_keys.size());
+    EXPECT_EQ(all_keys[count], (*iterator).first);
+    count++;
+  }
+  EXPECT_EQ(all_keys.size(), count);
+
+  delete tree;
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
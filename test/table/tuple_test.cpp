@@ -12,19 +12,28 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <future>  // NOLINT
 #include <iostream>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction_manager.h"
 #include "gtest/gtest.h"
 #include "logging/common.h"
+#include "storage/page/free_space_map_page.h"
+#include "storage/page/table_page.h"
+#include "storage/table/parallel_scan.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 // NOLINTNEXTLINE
-TEST(TupleTest, DISABLED_TableHeapTest) {
+TEST(TupleTest, TableHeapTest) {
   // test1: parse create sql statement
   std::string create_stmt = "a varchar(20), b smallint, c bigint, d bool, e varchar(16)";
   Column col1{"a", TypeId::VARCHAR, 20};
@@ -67,8 +76,1185 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
   remove("test.db");  // remove db file
   remove("test.log");
   delete table;
+  delete transaction;
+  delete log_manager;
+  delete lock_manager;
   delete buffer_pool_manager;
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(TupleTest, FreeSpaceReuseTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 100};
+  Schema schema{{col1, col2}};
+  auto make_tuple = [&schema](int32_t i) {
+    return Tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(100, 'x'))}, &schema};
+  };
+  auto count_pages = [](BufferPoolManager *bpm, page_id_t page_id) {
+    int count = 0;
+    while (page_id != INVALID_PAGE_ID) {
+      auto page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+      auto next_page_id = page->GetNextPageId();
+      bpm->UnpinPage(page_id, false);
+      page_id = next_page_id;
+      count++;
+    }
+    return count;
+  };
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  // Fill the table; the free space map should hand out pages in order without leaving holes.
+  std::vector<RID> rid_v;
+  for (int i = 0; i < 2000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i), &rid, transaction));
+    rid_v.push_back(rid);
+  }
+  int num_pages = count_pages(buffer_pool_manager, table->GetFirstPageId());
+  uint32_t page_capacity = TablePage::GetMaxTupleSize() + TablePage::GetRequiredSpace(0);
+  int tuples_per_page = page_capacity / TablePage::GetRequiredSpace(make_tuple(0).GetLength());
+  EXPECT_EQ(num_pages, (2000 + tuples_per_page - 1) / tuples_per_page);
+
+  // Free every other tuple, then insert the same number again: the freed space must be reused.
+  for (size_t i = 0; i < rid_v.size(); i += 2) {
+    table->ApplyDelete(rid_v[i], transaction);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(2000 + i), &rid, transaction));
+  }
+  EXPECT_EQ(num_pages, count_pages(buffer_pool_manager, table->GetFirstPageId()));
+
+  int count = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(2000, count);
+
+  // Reopening the table picks up the same free space map.
+  TableHeap reopened{buffer_pool_manager, lock_manager, log_manager, table->GetFirstPageId()};
+  EXPECT_EQ(table->GetFreeSpaceMap()->GetRootPageId(), reopened.GetFreeSpaceMap()->GetRootPageId());
+  EXPECT_EQ(table->GetFreeSpaceMap()->GetLastPageId(), reopened.GetFreeSpaceMap()->GetLastPageId());
+
+  // A tuple that cannot fit into a page is rejected.
+  Column big_col{"c", TypeId::VARCHAR, PAGE_SIZE};
+  Schema big_schema{{big_col}};
+  Tuple big_tuple{{ValueFactory::GetVarcharValue(std::string(PAGE_SIZE, 'y'))}, &big_schema};
+  RID rid;
+  EXPECT_FALSE(table->InsertTuple(big_tuple, &rid, transaction));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, BulkInsertTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 64};
+  Schema schema{{col1, col2}};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 20000; ++i) {
+    tuples.emplace_back(
+        std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 64, 'x'))},
+        &schema);
+  }
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *single_table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  auto *bulk_table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+
+  for (const auto &tuple : tuples) {
+    RID rid;
+    ASSERT_TRUE(single_table->InsertTuple(tuple, &rid, transaction));
+  }
+
+  // Insert in batches, like TableGenerator does.
+  std::vector<RID> rids;
+  for (size_t i = 0; i < tuples.size(); i += 128) {
+    std::vector<Tuple> batch(tuples.begin() + i, tuples.begin() + std::min(i + 128, tuples.size()));
+    ASSERT_TRUE(bulk_table->InsertTuples(batch, &rids, transaction));
+  }
+
+  // Every tuple can be found at its rid, and the tables are stored equally densely.
+  ASSERT_EQ(tuples.size(), rids.size());
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    Tuple tuple;
+    ASSERT_TRUE(bulk_table->GetTuple(rids[i], &tuple, transaction));
+    EXPECT_EQ(tuples[i].GetLength(), tuple.GetLength());
+    EXPECT_EQ(0, memcmp(tuples[i].GetData(), tuple.GetData(), tuple.GetLength()));
+  }
+  auto count_pages = [buffer_pool_manager](page_id_t page_id) {
+    int count = 0;
+    while (page_id != INVALID_PAGE_ID) {
+      auto page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+      auto next_page_id = page->GetNextPageId();
+      buffer_pool_manager->UnpinPage(page_id, false);
+      page_id = next_page_id;
+      count++;
+    }
+    return count;
+  };
+  EXPECT_EQ(count_pages(single_table->GetFirstPageId()), count_pages(bulk_table->GetFirstPageId()));
+
+  // A batch containing a tuple that is too large is rejected as a whole.
+  Column big_col{"c", TypeId::VARCHAR, PAGE_SIZE};
+  Schema big_schema{{big_col}};
+  std::vector<Tuple> bad_batch{tuples[0],
+                               Tuple{{ValueFactory::GetVarcharValue(std::string(PAGE_SIZE, 'y'))}, &big_schema}};
+  EXPECT_FALSE(bulk_table->InsertTuples(bad_batch, &rids, transaction));
+  EXPECT_EQ(tuples.size(), rids.size());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete single_table;
+  delete bulk_table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, PaxTableHeapTest) {
+  // A wide table, of which the scans below only read two columns.
+  std::vector<Column> cols;
+  for (int i = 0; i < 20; ++i) {
+    if (i % 5 == 4) {
+      cols.emplace_back("v" + std::to_string(i), TypeId::VARCHAR, 32);
+    } else {
+      cols.emplace_back("c" + std::to_string(i), i % 2 == 0 ? TypeId::INTEGER : TypeId::BIGINT);
+    }
+  }
+  Schema schema{cols};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 5000; ++i) {
+    std::vector<Value> values;
+    for (int j = 0; j < 20; ++j) {
+      if (j % 5 == 4) {
+        values.emplace_back(ValueFactory::GetVarcharValue(std::string(i % 17, static_cast<char>('a' + j))));
+      } else if (j % 2 == 0) {
+        values.emplace_back(ValueFactory::GetIntegerValue(i * j));
+      } else {
+        values.emplace_back(ValueFactory::GetBigIntValue(static_cast<int64_t>(i) * j));
+      }
+    }
+    tuples.emplace_back(values, &schema);
+  }
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(1000, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *row_table =
+      new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::ROW);
+  auto *pax_table =
+      new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::PAX);
+  EXPECT_EQ(TableLayout::PAX, pax_table->GetLayout());
+
+  // Tuples are reassembled exactly as they were inserted.
+  std::vector<RID> row_rids;
+  std::vector<RID> pax_rids;
+  ASSERT_TRUE(row_table->InsertTuples(tuples, &row_rids, transaction));
+  for (size_t i = 0; i < tuples.size() / 2; ++i) {
+    RID rid;
+    ASSERT_TRUE(pax_table->InsertTuple(tuples[i], &rid, transaction));
+    pax_rids.push_back(rid);
+  }
+  ASSERT_TRUE(pax_table->InsertTuples({tuples.begin() + tuples.size() / 2, tuples.end()}, &pax_rids, transaction));
+  size_t i = 0;
+  for (auto itr = pax_table->Begin(transaction); itr != pax_table->End(); ++itr, ++i) {
+    ASSERT_EQ(pax_rids[i], itr->GetRid());
+    ASSERT_EQ(tuples[i].GetLength(), itr->GetLength());
+    ASSERT_EQ(0, memcmp(tuples[i].GetData(), itr->GetData(), itr->GetLength()));
+  }
+  EXPECT_EQ(tuples.size(), i);
+
+  // Deleted tuples disappear from scans; PAX tuples are never updated in place.
+  for (i = 0; i < pax_rids.size(); i += 3) {
+    ASSERT_TRUE(pax_table->MarkDelete(pax_rids[i], transaction));
+    pax_table->ApplyDelete(pax_rids[i], transaction);
+    ASSERT_TRUE(row_table->MarkDelete(row_rids[i], transaction));
+    row_table->ApplyDelete(row_rids[i], transaction);
+  }
+  Tuple tuple;
+  EXPECT_FALSE(pax_table->GetTuple(pax_rids[0], &tuple, transaction));
+  ASSERT_TRUE(pax_table->GetTuple(pax_rids[1], &tuple, transaction));
+  EXPECT_EQ(0, memcmp(tuples[1].GetData(), tuple.GetData(), tuple.GetLength()));
+  EXPECT_FALSE(pax_table->UpdateTuple(tuples[2], pax_rids[1], transaction));
+
+  // Column scans of both layouts produce the requested columns of the remaining tuples.
+  std::vector<uint32_t> column_ids{9, 2};
+  auto scan = [&](TableHeap *table, const std::vector<RID> &rids) {
+    std::unordered_map<RID, size_t> tuple_idx;
+    for (size_t j = 0; j < rids.size(); ++j) {
+      tuple_idx[rids[j]] = j;
+    }
+    auto itr = table->ScanColumns(&schema, column_ids, transaction);
+    std::vector<Value> values;
+    RID rid;
+    size_t count = 0;
+    while (itr.Next(&values, &rid)) {
+      ASSERT_EQ(1, tuple_idx.count(rid));
+      auto idx = tuple_idx[rid];
+      EXPECT_NE(0, idx % 3);
+      EXPECT_EQ(CmpBool::CmpTrue, values[0].CompareEquals(tuples[idx].GetValue(&schema, 9)));
+      EXPECT_EQ(CmpBool::CmpTrue, values[1].CompareEquals(tuples[idx].GetValue(&schema, 2)));
+      count++;
+    }
+    EXPECT_EQ(tuples.size() - (tuples.size() + 2) / 3, count);
+
+    // Batched scans produce the same tuples.
+    std::vector<std::vector<Value>> batch;
+    std::vector<RID> batch_rids;
+    size_t batched = 0;
+    auto batch_itr = table->ScanColumns(&schema, column_ids, transaction);
+    while (batch_itr.NextBatch(&batch, &batch_rids)) {
+      batched += batch_rids.size();
+    }
+    EXPECT_EQ(count, batched);
+  };
+  scan(row_table, row_rids);
+  scan(pax_table, pax_rids);
+
+  // Reopened tables read their layout from their first page.
+  {
+    TableHeap row_reopened(buffer_pool_manager, lock_manager, log_manager, row_table->GetFirstPageId(), schema);
+    TableHeap pax_reopened(buffer_pool_manager, lock_manager, log_manager, pax_table->GetFirstPageId(), schema);
+    EXPECT_EQ(TableLayout::ROW, row_reopened.GetLayout());
+    EXPECT_EQ(TableLayout::PAX, pax_reopened.GetLayout());
+    scan(&row_reopened, row_rids);
+    scan(&pax_reopened, pax_rids);
+    RID rid;
+    ASSERT_TRUE(pax_reopened.InsertTuple(tuples[0], &rid, transaction));
+    ASSERT_TRUE(pax_reopened.GetTuple(rid, &tuple, transaction));
+    EXPECT_EQ(0, memcmp(tuples[0].GetData(), tuple.GetData(), tuple.GetLength()));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete row_table;
+  delete pax_table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TupleViewTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 64};
+  Schema schema{{col1, col2}};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 10000; ++i) {
+    tuples.emplace_back(
+        std::vector<Value>{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 64, 'x'))},
+        &schema);
+  }
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  // Fewer frames than pages, so the scans fail if they leak pins.
+  auto *buffer_pool_manager = new BufferPoolManager(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *row_table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction);
+  auto *pax_table =
+      new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::PAX);
+  std::vector<RID> row_rids;
+  std::vector<RID> pax_rids;
+  ASSERT_TRUE(row_table->InsertTuples(tuples, &row_rids, transaction));
+  ASSERT_TRUE(pax_table->InsertTuples(tuples, &pax_rids, transaction));
+  for (size_t i = 0; i < tuples.size(); i += 4) {
+    ASSERT_TRUE(row_table->MarkDelete(row_rids[i], transaction));
+    row_table->ApplyDelete(row_rids[i], transaction);
+    ASSERT_TRUE(pax_table->MarkDelete(pax_rids[i], transaction));
+    pax_table->ApplyDelete(pax_rids[i], transaction);
+  }
+
+  auto scan = [&](TableHeap *table, const std::vector<RID> &rids) {
+    std::unordered_map<RID, size_t> tuple_idx;
+    for (size_t j = 0; j < rids.size(); ++j) {
+      tuple_idx[rids[j]] = j;
+    }
+    Tuple kept;
+    size_t count = 0;
+    {
+      auto itr = table->ScanViews(transaction);
+      TupleView view;
+      while (itr.Next(&view)) {
+        ASSERT_EQ(1, tuple_idx.count(view.GetRid()));
+        auto idx = tuple_idx[view.GetRid()];
+        EXPECT_NE(0, idx % 4);
+        ASSERT_EQ(tuples[idx].GetLength(), view.GetLength());
+        EXPECT_EQ(0, memcmp(tuples[idx].GetData(), view.GetData(), view.GetLength()));
+        EXPECT_EQ(CmpBool::CmpTrue, view.GetValue(&schema, 1).CompareEquals(tuples[idx].GetValue(&schema, 1)));
+        if (idx == 1) {
+          kept = view.Materialize();
+        }
+        count++;
+      }
+    }
+    EXPECT_EQ(tuples.size() - (tuples.size() + 3) / 4, count);
+    // The materialized tuple outlives the scan.
+    EXPECT_EQ(rids[1], kept.GetRid());
+    EXPECT_EQ(tuples[1].ToString(&schema), kept.ToString(&schema));
+  };
+  scan(row_table, row_rids);
+  scan(pax_table, pax_rids);
+
+  // The scan holds no latch between calls, so the scanning thread may update and delete the tuples it looks at. PAX
+  // pages do not support updates, every other tuple is kept as it is there.
+  for (auto *table : {row_table, pax_table}) {
+    size_t count = 0;
+    auto itr = table->ScanViews(transaction);
+    TupleView view;
+    while (itr.Next(&view)) {
+      Tuple tuple = view.Materialize();
+      if (count % 2 == 0) {
+        ASSERT_TRUE(table->MarkDelete(view.GetRid(), transaction));
+        table->ApplyDelete(view.GetRid(), transaction);
+      } else if (table->GetLayout() == TableLayout::ROW) {
+        ASSERT_TRUE(table->UpdateTuple(tuple, view.GetRid(), transaction));
+      }
+      count++;
+    }
+    EXPECT_EQ(tuples.size() - (tuples.size() + 3) / 4, count);
+    size_t left = 0;
+    for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+      left++;
+    }
+    EXPECT_EQ(count / 2, left);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete row_table;
+  delete pax_table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, TupleViewWriterTest) {
+  Column col1{"a", TypeId::INTEGER};
+  Column col2{"b", TypeId::VARCHAR, 64};
+  Schema schema{{col1, col2}};
+  auto make_tuple = [&schema](int32_t i, char fill) {
+    return Tuple{{ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(8, fill))}, &schema};
+  };
+
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(10, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  TransactionManager txn_mgr(lock_manager, log_manager);
+  auto *txn = txn_mgr.Begin();
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, txn, schema, TableLayout::ROW);
+  // A single page of tuples.
+  const int32_t num_tuples = 50;
+  std::vector<RID> rids(num_tuples);
+  for (int32_t i = 0; i < num_tuples; ++i) {
+    ASSERT_TRUE(table->InsertTuple(make_tuple(i, 'a'), &rids[i], txn));
+    ASSERT_EQ(rids[0].GetPageId(), rids[i].GetPageId());
+  }
+  txn_mgr.Commit(txn);
+  delete txn;
+
+  // A writer deletes and updates tuples of the page, holding their exclusive locks while the scan is on the page, and
+  // finishes before the scan reaches them. The scan reads them as the writer leaves them.
+  for (bool commit : {false, true}) {
+    std::promise<void> written;
+    std::promise<void> scan_started;
+    std::promise<void> finished;
+    std::thread writer([&] {
+      auto *writer_txn = txn_mgr.Begin();
+      for (int32_t i = 1; i <= 10; ++i) {
+        ASSERT_TRUE(lock_manager->LockExclusive(writer_txn, rids[i]));
+        ASSERT_TRUE(table->MarkDelete(rids[i], writer_txn));
+      }
+      ASSERT_TRUE(lock_manager->LockExclusive(writer_txn, rids[11]));
+      ASSERT_TRUE(table->UpdateTuple(make_tuple(11, 'b'), rids[11], writer_txn));
+      written.set_value();
+      scan_started.get_future().wait();
+      if (commit) {
+        txn_mgr.Commit(writer_txn);
+      } else {
+        txn_mgr.Abort(writer_txn);
+      }
+      delete writer_txn;
+      finished.set_value();
+    });
+
+    written.get_future().wait();
+    auto *scan_txn = txn_mgr.Begin();
+    std::vector<int32_t> seen;
+    {
+      auto itr = table->ScanViews(scan_txn);
+      TupleView view;
+      ASSERT_TRUE(itr.Next(&view));
+      EXPECT_EQ(rids[0], view.GetRid());
+      seen.push_back(view.GetValue(&schema, 0).GetAs<int32_t>());
+      scan_started.set_value();
+      finished.get_future().wait();
+      while (itr.Next(&view)) {
+        auto i = view.GetValue(&schema, 0).GetAs<int32_t>();
+        EXPECT_EQ(rids[i], view.GetRid());
+        char fill = commit && i == 11 ? 'b' : 'a';
+        EXPECT_EQ(CmpBool::CmpTrue, view.GetValue(&schema, 1).CompareEquals(make_tuple(i, fill).GetValue(&schema, 1)));
+        seen.push_back(i);
+      }
+    }
+    writer.join();
+    txn_mgr.Commit(scan_txn);
+    delete scan_txn;
+
+    std::vector<int32_t> expected;
+    for (int32_t i = 0; i < num_tuples; ++i) {
+      if (!commit || i < 1 || i > 10) {
+        expected.push_back(i);
+      }
+    }
+    EXPECT_EQ(expected, seen);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, FixedColumnTest) {
+  Column col1{"a", TypeId::BOOLEAN};
+  Column col2{"b", TypeId::VARCHAR, 20};
+  Column col3{"c", TypeId::SMALLINT};
+  Column col4{"d", TypeId::INTEGER};
+  Column col5{"e", TypeId::BIGINT};
+  Column col6{"f", TypeId::DECIMAL};
+  Schema schema{{col1, col2, col3, col4, col5, col6}};
+  EXPECT_EQ(schema.GetColumn(3).GetOffset(), schema.GetColumnLayout(3).offset_);
+  EXPECT_EQ(TypeId::VARCHAR, schema.GetColumnLayout(1).type_);
+  EXPECT_FALSE(schema.GetColumnLayout(1).inlined_);
+
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 10000; ++i) {
+    tuples.emplace_back(std::vector<Value>{ValueFactory::GetBooleanValue(i % 2 == 0),
+                                           ValueFactory::GetVarcharValue(std::to_string(i)),
+                                           ValueFactory::GetSmallIntValue(static_cast<int16_t>(i % 1000)),
+                                           ValueFactory::GetIntegerValue(i), ValueFactory::GetBigIntValue(-i),
+                                           ValueFactory::GetDecimalValue(i / 4.0)},
+                        &schema);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const auto &tuple = tuples[i];
+    EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int8_t>(), tuple.GetFixed<int8_t>(&schema, 0));
+    EXPECT_EQ(i % 1000, tuple.GetFixed<int16_t>(&schema, 2));
+    EXPECT_EQ(i, tuple.GetFixed<int32_t>(&schema, 3));
+    EXPECT_EQ(-i, tuple.GetFixed<int64_t>(&schema, 4));
+    EXPECT_EQ(i / 4.0, tuple.GetFixed<double>(&schema, 5));
+    EXPECT_EQ(i, TupleView(tuple).GetFixed<int32_t>(&schema, 3));
+  }
+  // NULLs read as the NULL value of the type.
+  Tuple null_tuple{{ValueFactory::GetBooleanValue(true), ValueFactory::GetVarcharValue("x"),
+                    ValueFactory::GetSmallIntValue(1), ValueFactory::GetNullValueByType(TypeId::INTEGER),
+                    ValueFactory::GetBigIntValue(1), ValueFactory::GetDecimalValue(1)},
+                   &schema};
+  EXPECT_EQ(BUSTUB_INT32_NULL, null_tuple.GetFixed<int32_t>(&schema, 3));
+
+  // Extracting a column of a batch gives the same values as reading them one by one.
+  std::vector<int32_t> extracted(tuples.size());
+  Tuple::ExtractColumn(tuples, &schema, 3, extracted.data());
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    EXPECT_EQ(tuples[i].GetValue(&schema, 3).GetAs<int32_t>(), extracted[i]);
+  }
+
+  std::vector<double> decimals(10);
+  Tuple::ExtractColumn(tuples.data() + 100, decimals.size(), &schema, 5, decimals.data());
+  for (size_t i = 0; i < decimals.size(); ++i) {
+    EXPECT_EQ((100 + i) / 4.0, decimals[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, NullBitmapTest) {
+  // Ten columns, so the bitmap takes two bytes.
+  std::vector<Column> cols;
+  for (int i = 0; i < 10; ++i) {
+    if (i % 3 == 2) {
+      cols.emplace_back("v" + std::to_string(i), TypeId::VARCHAR, 16);
+    } else {
+      cols.emplace_back("c" + std::to_string(i), TypeId::INTEGER);
+    }
+  }
+  Schema schema{cols};
+  EXPECT_EQ(schema.GetColumn(9).GetOffset() + schema.GetColumn(9).GetFixedLength(), schema.GetNullBitmapOffset());
+  EXPECT_EQ(2, schema.GetNullBitmapSize());
+  EXPECT_EQ(schema.GetNullBitmapOffset() + 2, schema.GetLength());
+
+  // Column j of tuple i is NULL if i + j is a multiple of 4.
+  auto is_null = [](int i, int j) { return (i + j) % 4 == 0; };
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 100; ++i) {
+    std::vector<Value> values;
+    for (int j = 0; j < 10; ++j) {
+      auto type = schema.GetColumn(j).GetType();
+      if (is_null(i, j)) {
+        values.emplace_back(ValueFactory::GetNullValueByType(type));
+      } else if (type == TypeId::VARCHAR) {
+        values.emplace_back(ValueFactory::GetVarcharValue(std::to_string(i * j)));
+      } else {
+        values.emplace_back(ValueFactory::GetIntegerValue(i * j));
+      }
+    }
+    tuples.emplace_back(values, &schema);
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const auto &tuple = tuples[i];
+    for (int j = 0; j < 10; ++j) {
+      ASSERT_EQ(is_null(i, j), tuple.IsNull(&schema, j));
+      ASSERT_EQ(is_null(i, j), TupleView(tuple).IsNull(&schema, j));
+      ASSERT_EQ(is_null(i, j), tuple.GetValue(&schema, j).IsNull());
+      ASSERT_EQ(is_null(i, j), TupleView(tuple).GetValue(&schema, j).IsNull());
+      if (!is_null(i, j) && j % 3 != 2) {
+        ASSERT_EQ(i * j, tuple.GetFixed<int32_t>(&schema, j));
+      }
+    }
+  }
+
+  // The null masks of a column line up with the tuples of the batch.
+  std::vector<uint8_t> mask((tuples.size() + 7) / 8);
+  for (int j = 0; j < 10; ++j) {
+    Tuple::ExtractNullMask(tuples.data(), tuples.size(), &schema, j, mask.data());
+    for (size_t i = 0; i < tuples.size(); ++i) {
+      ASSERT_EQ(is_null(i, j), ((mask[i / 8] >> (i % 8)) & 1U) != 0);
+    }
+  }
+
+  // The bitmap survives a round trip through both page layouts.
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  for (auto layout : {TableLayout::ROW, TableLayout::PAX}) {
+    TableHeap table(buffer_pool_manager, lock_manager, log_manager, transaction, schema, layout);
+    std::vector<RID> rids;
+    ASSERT_TRUE(table.InsertTuples(tuples, &rids, transaction));
+    for (size_t i = 0; i < tuples.size(); ++i) {
+      Tuple tuple;
+      ASSERT_TRUE(table.GetTuple(rids[i], &tuple, transaction));
+      ASSERT_EQ(tuples[i].GetLength(), tuple.GetLength());
+      ASSERT_EQ(0, memcmp(tuples[i].GetData(), tuple.GetData(), tuple.GetLength()));
+      for (int j = 0; j < 10; ++j) {
+        ASSERT_EQ(is_null(i, j), tuple.IsNull(&schema, j));
+      }
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, OverflowTest) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"doc", TypeId::VARCHAR, 256};
+  Column col3{"note", TypeId::VARCHAR, 32};
+  Schema schema{{col1, col2, col3}};
+  auto make_tuple = [&](int id, size_t doc_size) {
+    std::string doc(doc_size, static_cast<char>('a' + id % 26));
+    return Tuple{{ValueFactory::GetIntegerValue(id), ValueFactory::GetVarcharValue(doc),
+                  ValueFactory::GetVarcharValue("note " + std::to_string(id))},
+                 &schema};
+  };
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::ROW);
+
+  // Tuples from a few bytes up to far more than a page, one at a time and in a batch.
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 40; ++i) {
+    tuples.push_back(make_tuple(i, i % 4 == 0 ? 10 : 10000 * i));
+  }
+  std::vector<RID> rids;
+  for (int i = 0; i < 20; ++i) {
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(tuples[i], &rid, transaction));
+    rids.push_back(rid);
+  }
+  ASSERT_TRUE(table->InsertTuples({tuples.begin() + 20, tuples.end()}, &rids, transaction));
+  ASSERT_EQ(tuples.size(), rids.size());
+
+  // Stored tuples only hold pointers to their large values, the other columns read as usual.
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rids[i], &tuple, transaction));
+    EXPECT_LE(tuple.GetLength(), std::max(TableHeap::TOAST_THRESHOLD, tuples[i].GetLength()));
+    EXPECT_EQ(static_cast<int32_t>(i), tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ("note " + std::to_string(i), tuple.GetValue(&schema, 2).ToString());
+
+    Value doc;
+    ASSERT_TRUE(table->GetValue(tuple, 1, &doc, transaction));
+    EXPECT_EQ(CmpBool::CmpTrue, doc.CompareEquals(tuples[i].GetValue(&schema, 1)));
+    ASSERT_TRUE(table->Detoast(&tuple, transaction));
+    ASSERT_EQ(tuples[i].GetLength(), tuple.GetLength());
+    EXPECT_EQ(0, memcmp(tuples[i].GetData(), tuple.GetData(), tuple.GetLength()));
+    EXPECT_EQ(rids[i], tuple.GetRid());
+  }
+
+  // Scans return the small stored tuples without reading the overflow pages.
+  size_t scanned = 0;
+  for (auto itr = table->Begin(transaction); itr != table->End(); ++itr, ++scanned) {
+    EXPECT_LE(itr->GetLength(), TableHeap::TOAST_THRESHOLD);
+  }
+  EXPECT_EQ(tuples.size(), scanned);
+
+  // Large values can be updated, and deleted tuples free their overflow pages.
+  Tuple updated = make_tuple(1, 50000);
+  ASSERT_TRUE(table->UpdateTuple(updated, rids[1], transaction));
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[1], &tuple, transaction));
+  ASSERT_TRUE(table->Detoast(&tuple, transaction));
+  EXPECT_EQ(0, memcmp(updated.GetData(), tuple.GetData(), tuple.GetLength()));
+  for (size_t i = 0; i < rids.size(); i += 2) {
+    ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+    table->ApplyDelete(rids[i], transaction);
+  }
+  EXPECT_FALSE(table->GetTuple(rids[2], &tuple, transaction));
+  ASSERT_TRUE(table->GetTuple(rids[3], &tuple, transaction));
+  ASSERT_TRUE(table->Detoast(&tuple, transaction));
+  EXPECT_EQ(0, memcmp(tuples[3].GetData(), tuple.GetData(), tuple.GetLength()));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, OverflowUpdateTest) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"doc", TypeId::VARCHAR, 256};
+  Schema schema{{col1, col2}};
+  auto make_tuple = [&](char fill) {
+    return Tuple{{ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue(std::string(50000, fill))}, &schema};
+  };
+
+  auto *disk_manager = new DiskManager("test.db");
+  // Large enough to never evict, so the pages in the pool are the pages in use.
+  auto *buffer_pool_manager = new BufferPoolManager(200, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  TransactionManager txn_mgr(lock_manager, log_manager);
+  auto pages_in_use = [buffer_pool_manager]() {
+    size_t count = 0;
+    for (size_t i = 0; i < buffer_pool_manager->GetPoolSize(); ++i) {
+      count += static_cast<size_t>(buffer_pool_manager->GetPages()[i].GetPageId() != INVALID_PAGE_ID);
+    }
+    return count;
+  };
+  auto read_doc = [&](TableHeap *table, const RID &rid, Transaction *txn) {
+    Tuple tuple;
+    EXPECT_TRUE(table->GetTuple(rid, &tuple, txn));
+    Value doc;
+    EXPECT_TRUE(table->GetValue(tuple, 1, &doc, txn));
+    return doc.ToString();
+  };
+
+  auto *txn = txn_mgr.Begin();
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, txn, schema, TableLayout::ROW);
+  RID rid;
+  ASSERT_TRUE(table->InsertTuple(make_tuple('a'), &rid, txn));
+  txn_mgr.Commit(txn);
+  delete txn;
+  const size_t committed_pages = pages_in_use();
+
+  // The old version keeps its overflow pages until the update commits, then they are freed.
+  txn = txn_mgr.Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple('b'), rid, txn));
+  EXPECT_GT(pages_in_use(), committed_pages);
+  txn_mgr.Commit(txn);
+  delete txn;
+  EXPECT_EQ(committed_pages, pages_in_use());
+  EXPECT_EQ(std::string(50000, 'b'), read_doc(table, rid, nullptr));
+
+  // A rollback puts the old version back and frees the overflow pages of the new one, however many updates there were.
+  txn = txn_mgr.Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple('c'), rid, txn));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple('d'), rid, txn));
+  txn_mgr.Abort(txn);
+  delete txn;
+  EXPECT_EQ(committed_pages, pages_in_use());
+  EXPECT_EQ(std::string(50000, 'b'), read_doc(table, rid, nullptr));
+
+  // Updating a tuple to a version read from the table gives the new version overflow pages of its own.
+  txn = txn_mgr.Begin();
+  Tuple stored;
+  ASSERT_TRUE(table->GetTuple(rid, &stored, txn));
+  ASSERT_TRUE(table->UpdateTuple(stored, rid, txn));
+  txn_mgr.Commit(txn);
+  delete txn;
+  EXPECT_EQ(committed_pages, pages_in_use());
+  EXPECT_EQ(std::string(50000, 'b'), read_doc(table, rid, nullptr));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, DictionaryTest) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"city", TypeId::VARCHAR, 64};
+  Column col3{"doc", TypeId::VARCHAR, 256};
+  Schema schema{{col1, col2, col3}};
+  const std::vector<std::string> cities{"Pittsburgh, Pennsylvania", "San Francisco, California",
+                                        "Seattle, Washington", "Boston, Massachusetts"};
+  auto make_tuple = [&](int id, const std::string &city) {
+    // Every tenth city is NULL and every hundredth doc too large for the page.
+    auto city_value =
+        id % 10 == 9 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR) : ValueFactory::GetVarcharValue(city);
+    std::string doc = id % 100 == 0 ? std::string(10000, 'd') : "doc of " + cities[id % cities.size()];
+    return Tuple{{ValueFactory::GetIntegerValue(id), city_value, ValueFactory::GetVarcharValue(doc)}, &schema};
+  };
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 2000; ++i) {
+    tuples.push_back(make_tuple(i, cities[i % cities.size()]));
+  }
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+  auto *plain_table =
+      new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::ROW);
+  auto *dict_table =
+      new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::ROW, true);
+  std::vector<RID> plain_rids;
+  std::vector<RID> rids;
+  ASSERT_TRUE(plain_table->InsertTuples(tuples, &plain_rids, transaction));
+  for (size_t i = 0; i < tuples.size() / 2; ++i) {
+    RID rid;
+    ASSERT_TRUE(dict_table->InsertTuple(tuples[i], &rid, transaction));
+    rids.push_back(rid);
+  }
+  ASSERT_TRUE(dict_table->InsertTuples({tuples.begin() + tuples.size() / 2, tuples.end()}, &rids, transaction));
+  ASSERT_EQ(tuples.size(), rids.size());
+
+  // Repeated strings are stored once per page, so the encoded table needs fewer pages.
+  auto count_pages = [](const std::vector<RID> &table_rids) {
+    std::vector<page_id_t> page_ids;
+    for (const auto &rid : table_rids) {
+      page_ids.push_back(rid.GetPageId());
+    }
+    std::sort(page_ids.begin(), page_ids.end());
+    return std::unique(page_ids.begin(), page_ids.end()) - page_ids.begin();
+  };
+  EXPECT_LT(count_pages(rids), count_pages(plain_rids));
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(rids[0].GetPageId()));
+  ASSERT_TRUE(page->HasDictionary());
+  EXPECT_GT(page->GetDictionaryEntryCount(), 0);
+  buffer_pool_manager->UnpinPage(page->GetTablePageId(), false);
+
+  // Tuples read back decoded, by rid and by scans.
+  for (size_t i = 0; i < tuples.size(); ++i) {
+    Tuple tuple;
+    ASSERT_TRUE(dict_table->GetTuple(rids[i], &tuple, transaction));
+    ASSERT_TRUE(dict_table->Detoast(&tuple, transaction));
+    ASSERT_EQ(tuples[i].GetLength(), tuple.GetLength());
+    EXPECT_EQ(0, memcmp(tuples[i].GetData(), tuple.GetData(), tuple.GetLength()));
+  }
+  size_t scanned = 0;
+  for (auto itr = dict_table->Begin(transaction); itr != dict_table->End(); ++itr, ++scanned) {
+    auto id = itr->GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_EQ(id % 10 == 9, itr->IsNull(&schema, 1));
+    if (!itr->IsNull(&schema, 1)) {
+      EXPECT_EQ(cities[id % cities.size()], itr->GetValue(&schema, 1).ToString());
+    }
+  }
+  EXPECT_EQ(tuples.size(), scanned);
+  {
+    auto itr = dict_table->ScanViews(transaction);
+    TupleView view;
+    scanned = 0;
+    while (itr.Next(&view)) {
+      auto id = view.GetFixed<int32_t>(&schema, 0);
+      EXPECT_EQ(id % 10 == 9, view.IsNull(&schema, 1));
+      if (!view.IsNull(&schema, 1)) {
+        EXPECT_EQ(cities[id % cities.size()], view.GetValue(&schema, 1).ToString());
+      }
+      ++scanned;
+    }
+  }
+  EXPECT_EQ(tuples.size(), scanned);
+
+  // Equality scans find the same tuples on both tables, including the values stored out of line.
+  auto scan_equals = [&](TableHeap *table, uint32_t column_idx, const Value &value) {
+    std::vector<RID> matches;
+    EXPECT_TRUE(table->ScanEquals(column_idx, value, &matches, transaction));
+    std::vector<int32_t> ids;
+    for (const auto &rid : matches) {
+      Tuple tuple;
+      EXPECT_TRUE(table->GetTuple(rid, &tuple, transaction));
+      ids.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  };
+  auto brute_force = [&](uint32_t column_idx, const Value &value) {
+    std::vector<int32_t> ids;
+    for (const auto &tuple : tuples) {
+      if (tuple.GetValue(&schema, column_idx).CompareEquals(value) == CmpBool::CmpTrue) {
+        ids.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      }
+    }
+    return ids;
+  };
+  std::vector<Value> probes;
+  for (const auto &city : cities) {
+    probes.push_back(ValueFactory::GetVarcharValue(city));
+  }
+  probes.push_back(ValueFactory::GetVarcharValue("Nowhere"));
+  for (const auto &probe : probes) {
+    auto expected = brute_force(1, probe);
+    EXPECT_EQ(expected, scan_equals(dict_table, 1, probe));
+    EXPECT_EQ(expected, scan_equals(plain_table, 1, probe));
+  }
+  auto large_doc = ValueFactory::GetVarcharValue(std::string(10000, 'd'));
+  EXPECT_EQ(brute_force(2, large_doc), scan_equals(dict_table, 2, large_doc));
+  EXPECT_TRUE(scan_equals(dict_table, 1, ValueFactory::GetNullValueByType(TypeId::VARCHAR)).empty());
+
+  // Updates and deletes keep the tuples intact and release the entries nothing refers to anymore.
+  Tuple updated = make_tuple(1, cities[0]);
+  ASSERT_TRUE(dict_table->UpdateTuple(updated, rids[1], transaction));
+  Tuple tuple;
+  ASSERT_TRUE(dict_table->GetTuple(rids[1], &tuple, transaction));
+  EXPECT_EQ(0, memcmp(updated.GetData(), tuple.GetData(), tuple.GetLength()));
+  EXPECT_EQ(brute_force(1, probes[0]).size() + 1, scan_equals(dict_table, 1, probes[0]).size());
+  auto first_page_id = rids[0].GetPageId();
+  for (size_t i = 0; i < rids.size() && rids[i].GetPageId() == first_page_id; ++i) {
+    ASSERT_TRUE(dict_table->MarkDelete(rids[i], transaction));
+    dict_table->ApplyDelete(rids[i], transaction);
+  }
+  page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(first_page_id));
+  EXPECT_EQ(0, page->GetDictionaryEntryCount());
+  buffer_pool_manager->UnpinPage(first_page_id, false);
+  EXPECT_FALSE(dict_table->GetTuple(rids[0], &tuple, transaction));
+
+  // Freed space takes new tuples with new entries.
+  updated = make_tuple(1, "Ann Arbor, Michigan");
+  EXPECT_TRUE(scan_equals(dict_table, 1, ValueFactory::GetVarcharValue("Ann Arbor, Michigan")).empty());
+  RID rid;
+  ASSERT_TRUE(dict_table->InsertTuple(updated, &rid, transaction));
+  ASSERT_TRUE(dict_table->GetTuple(rid, &tuple, transaction));
+  EXPECT_EQ(0, memcmp(updated.GetData(), tuple.GetData(), tuple.GetLength()));
+  EXPECT_EQ(std::vector<int32_t>{1}, scan_equals(dict_table, 1, ValueFactory::GetVarcharValue("Ann Arbor, Michigan")));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete dict_table;
+  delete plain_table;
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, ForwardingTest) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"payload", TypeId::VARCHAR, 1024};
+  Schema schema{{col1, col2}};
+  auto make_tuple = [&](int id, size_t payload_size) {
+    return Tuple{{ValueFactory::GetIntegerValue(id),
+                  ValueFactory::GetVarcharValue(std::string(payload_size, static_cast<char>('a' + id % 26)))},
+                 &schema};
+  };
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+
+  for (bool dictionary_encoding : {false, true}) {
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, TableLayout::ROW,
+                                dictionary_encoding);
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 400; ++i) {
+      tuples.push_back(make_tuple(i, 20));
+    }
+    std::vector<RID> rids;
+    ASSERT_TRUE(table->InsertTuples(tuples, &rids, transaction));
+    std::vector<bool> deleted(tuples.size(), false);
+
+    auto is_forwarded = [&](const RID &rid) {
+      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(rid.GetPageId()));
+      RID forward_rid;
+      bool forwarded = page->GetForwardRid(rid, &forward_rid);
+      buffer_pool_manager->UnpinPage(rid.GetPageId(), false);
+      return forwarded;
+    };
+    // Every tuple reads back at its rid, and every scan produces it exactly once, with its rid.
+    auto check = [&]() {
+      std::unordered_map<RID, size_t> tuple_idx;
+      size_t live = 0;
+      for (size_t i = 0; i < tuples.size(); ++i) {
+        Tuple tuple;
+        ASSERT_EQ(!deleted[i], table->GetTuple(rids[i], &tuple, transaction));
+        if (!deleted[i]) {
+          ASSERT_EQ(tuples[i].GetLength(), tuple.GetLength());
+          EXPECT_EQ(0, memcmp(tuples[i].GetData(), tuple.GetData(), tuple.GetLength()));
+          EXPECT_EQ(rids[i], tuple.GetRid());
+          tuple_idx[rids[i]] = i;
+          live++;
+        }
+      }
+      auto expect_tuple = [&](const RID &rid, const Value &payload, std::unordered_set<RID> *seen) {
+        ASSERT_EQ(1, tuple_idx.count(rid));
+        EXPECT_TRUE(seen->insert(rid).second);
+        EXPECT_EQ(CmpBool::CmpTrue, payload.CompareEquals(tuples[tuple_idx[rid]].GetValue(&schema, 1)));
+      };
+      std::unordered_set<RID> iterated;
+      for (auto itr = table->Begin(transaction); itr != table->End(); ++itr) {
+        expect_tuple(itr->GetRid(), itr->GetValue(&schema, 1), &iterated);
+      }
+      EXPECT_EQ(live, iterated.size());
+      std::unordered_set<RID> viewed;
+      {
+        auto itr = table->ScanViews(transaction);
+        TupleView view;
+        while (itr.Next(&view)) {
+          expect_tuple(view.GetRid(), view.GetValue(&schema, 1), &viewed);
+        }
+      }
+      EXPECT_EQ(live, viewed.size());
+      std::unordered_set<RID> column_scanned;
+      auto column_itr = table->ScanColumns(&schema, {1}, transaction);
+      std::vector<Value> values;
+      RID rid;
+      while (column_itr.Next(&values, &rid)) {
+        expect_tuple(rid, values[0], &column_scanned);
+      }
+      EXPECT_EQ(live, column_scanned.size());
+    };
+
+    // Growing every fourth tuple overflows the pages, so the tuples move to other pages but keep their rids.
+    for (size_t i = 0; i < tuples.size(); i += 4) {
+      tuples[i] = make_tuple(i, 600);
+      ASSERT_TRUE(table->UpdateTuple(tuples[i], rids[i], transaction));
+    }
+    size_t forwarded = 0;
+    for (size_t i = 0; i < tuples.size(); i += 4) {
+      forwarded += is_forwarded(rids[i]) ? 1 : 0;
+    }
+    EXPECT_GT(forwarded, 0);
+    check();
+    std::vector<RID> matches;
+    ASSERT_TRUE(table->ScanEquals(1, tuples[0].GetValue(&schema, 1), &matches, transaction));
+    EXPECT_NE(matches.end(), std::find(matches.begin(), matches.end(), rids[0]));
+
+    // Moved tuples move again when they grow, and come back once their own page has room for them.
+    for (size_t i = 0; i < tuples.size(); i += 8) {
+      tuples[i] = make_tuple(i, 900);
+      ASSERT_TRUE(table->UpdateTuple(tuples[i], rids[i], transaction));
+    }
+    check();
+    for (size_t i = 1; i < tuples.size(); i += 4) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+      deleted[i] = true;
+    }
+    for (size_t i = 4; i < tuples.size(); i += 8) {
+      tuples[i] = make_tuple(i, 10);
+      ASSERT_TRUE(table->UpdateTuple(tuples[i], rids[i], transaction));
+      EXPECT_FALSE(is_forwarded(rids[i]));
+    }
+    check();
+
+    // Deleting a moved tuple removes its stub and the tuple itself; rolling back a delete keeps both.
+    ASSERT_TRUE(table->MarkDelete(rids[8], transaction));
+    table->RollbackDelete(rids[8], transaction);
+    for (size_t i = 0; i < tuples.size(); i += 16) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+      deleted[i] = true;
+    }
+    check();
+    delete table;
+  }
+
+  // Without a schema nothing is moved out of line, so a tuple that grows beyond a page can't be updated.
+  {
+    auto *update_txn = new Transaction(1);
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, update_txn);
+    RID rid;
+    ASSERT_TRUE(table->InsertTuple(make_tuple(0, 20), &rid, update_txn));
+    EXPECT_FALSE(table->UpdateTuple(make_tuple(0, 5000), rid, update_txn));
+    EXPECT_EQ(TransactionState::ABORTED, update_txn->GetState());
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rid, &tuple, transaction));
+    EXPECT_EQ(make_tuple(0, 20).GetLength(), tuple.GetLength());
+    delete table;
+    delete update_txn;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleTest, ParallelScanTest) {
+  Column col1{"id", TypeId::INTEGER};
+  Column col2{"payload", TypeId::VARCHAR, 1024};
+  Schema schema{{col1, col2}};
+  auto make_tuple = [&](int id, size_t payload_size) {
+    return Tuple{{ValueFactory::GetIntegerValue(id),
+                  ValueFactory::GetVarcharValue(std::string(payload_size, static_cast<char>('a' + id % 26)))},
+                 &schema};
+  };
+
+  auto *transaction = new Transaction(0);
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(100, disk_manager);
+  auto *lock_manager = new LockManager();
+  auto *log_manager = new LogManager(disk_manager);
+
+  for (auto layout : {TableLayout::ROW, TableLayout::PAX}) {
+    auto *table = new TableHeap(buffer_pool_manager, lock_manager, log_manager, transaction, schema, layout);
+    // Enough pages for the free space map to need more than one map page.
+    std::vector<Tuple> tuples;
+    for (int i = 0; i < 20000; ++i) {
+      tuples.push_back(make_tuple(i, 200));
+    }
+    std::vector<RID> rids;
+    ASSERT_TRUE(table->InsertTuples(tuples, &rids, transaction));
+    std::vector<bool> deleted(tuples.size(), false);
+    for (size_t i = 0; i < tuples.size(); i += 7) {
+      ASSERT_TRUE(table->MarkDelete(rids[i], transaction));
+      table->ApplyDelete(rids[i], transaction);
+      deleted[i] = true;
+    }
+    if (layout == TableLayout::ROW) {
+      // Grown tuples move to other pages, and must still be produced once, by the worker of their original page.
+      for (size_t i = 1; i < tuples.size(); i += 49) {
+        tuples[i] = make_tuple(i, 800);
+        ASSERT_TRUE(table->UpdateTuple(tuples[i], rids[i], transaction));
+      }
+    }
+    std::unordered_map<RID, size_t> tuple_idx;
+    for (size_t i = 0; i < tuples.size(); ++i) {
+      if (!deleted[i]) {
+        tuple_idx[rids[i]] = i;
+      }
+    }
+
+    for (uint32_t worker_count : {1, 4, 8}) {
+      auto scan = table->CreateParallelScan(worker_count);
+      EXPECT_GT(scan->GetPageCount(), FreeSpaceMapPage::CAPACITY);
+      std::vector<std::vector<std::pair<RID, int32_t>>> produced(worker_count);
+      std::vector<std::thread> workers;
+      for (uint32_t w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&, w]() {
+          Transaction txn(w + 1);
+          auto itr = scan->CreateWorker(&txn);
+          TupleView view;
+          while (itr.Next(&view)) {
+            produced[w].emplace_back(view.GetRid(), view.GetValue(&schema, 0).GetAs<int32_t>());
+          }
+        });
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+
+      // Every live tuple is produced by exactly one worker.
+      std::unordered_set<RID> seen;
+      for (const auto &worker_tuples : produced) {
+        for (const auto &[rid, id] : worker_tuples) {
+          ASSERT_EQ(1, tuple_idx.count(rid));
+          EXPECT_TRUE(seen.insert(rid).second);
+          EXPECT_EQ(static_cast<int32_t>(tuple_idx[rid]), id);
+        }
+      }
+      EXPECT_EQ(tuple_idx.size(), seen.size());
+      std::vector<page_id_t> morsel;
+      EXPECT_FALSE(scan->NextMorsel(&morsel));
+    }
+    delete table;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+  delete log_manager;
+  delete lock_manager;
+  delete buffer_pool_manager;
+  delete disk_manager;
+  delete transaction;
+}
+
 }  // namespace bustub